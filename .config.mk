@@ -0,0 +1,3 @@
+DEFINITIONS =
+LIBOBJ += gamma-dummy
+DEFINITIONS += -DHAVE_LIBGAMMA_METHOD_DUMMY
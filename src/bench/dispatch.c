@@ -0,0 +1,251 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <libgamma.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+#ifndef __GCC__
+# define __attribute__(x)
+#endif
+
+
+/**
+ * The number of calls that are timed in each benchmark.
+ */
+#define ITERATIONS  10000000UL
+
+/**
+ * The number of calls that are timed in each benchmark
+ * where the call reads or writes entire gamma ramps.
+ */
+#define RAMP_ITERATIONS  20000UL
+
+/**
+ * The number of adjustment methods that the
+ * `switch` in the synthetic benchmark covers.
+ */
+#define METHODS  6
+
+
+/**
+ * A function that stands in for an adjustment
+ * method's implementation of a library function.
+ * 
+ * @param   x  Arbitrary value.
+ * @return     `x`, possibly with a small modification.
+ */
+typedef int stub_fun(int x);
+
+/**
+ * Stand in for an adjustment method's implementation.
+ * They do different things, so that the compiler cannot
+ * merge them, and are not inlined, so the cost of calling
+ * them is not optimised away.
+ * 
+ * @param   x  Arbitrary value.
+ * @return     `x`, possibly with a small modification.
+ */
+static int __attribute__((noinline)) stub0(int x) { return x + 0; }
+static int __attribute__((noinline)) stub1(int x) { return x ^ 1; }
+static int __attribute__((noinline)) stub2(int x) { return x + 2; }
+static int __attribute__((noinline)) stub3(int x) { return x ^ 3; }
+static int __attribute__((noinline)) stub4(int x) { return x + 4; }
+static int __attribute__((noinline)) stub5(int x) { return x ^ 5; }
+
+/**
+ * The stand ins for the adjustment methods' implementations,
+ * indexed by adjustment method, as in an ops table.
+ */
+static stub_fun* const stubs[METHODS] = { stub0, stub1, stub2, stub3, stub4, stub5 };
+
+/**
+ * The selected adjustment method, `volatile` so
+ * that the compiler cannot resolve the `switch`.
+ */
+static volatile int selected_method = 0;
+
+/**
+ * The selected adjustment method's implementation, as it
+ * is cached in the site state, `volatile` so that the
+ * compiler cannot resolve the call.
+ */
+static stub_fun* volatile selected_stub = stub0;
+
+
+/**
+ * Dispatch a call by `switch` over the adjustment method,
+ * the way the library did before the ops table.
+ * 
+ * @param   method  The adjustment method.
+ * @param   x       The argument for the adjustment method's function.
+ * @return          The return value of the adjustment method's function.
+ */
+static int __attribute__((noinline)) dispatch_switch(int method, int x)
+{
+  switch (method)
+    {
+    case 0:  return stub0(x);
+    case 1:  return stub1(x);
+    case 2:  return stub2(x);
+    case 3:  return stub3(x);
+    case 4:  return stub4(x);
+    case 5:  return stub5(x);
+    default:
+      return -1;
+    }
+}
+
+
+/**
+ * Dispatch a call by a cached pointer to the adjustment
+ * method's function, the way the library does with the ops table.
+ * 
+ * @param   fun  The adjustment method's function.
+ * @param   x    The argument for the adjustment method's function.
+ * @return       The return value of the adjustment method's function.
+ */
+static int __attribute__((noinline)) dispatch_ops(stub_fun* fun, int x)
+{
+  return fun(x);
+}
+
+
+/**
+ * Get the current time in nanoseconds.
+ * 
+ * @return  The value of the monotonic clock, in nanoseconds.
+ */
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)(ts.tv_sec) * (double)1000000000L + (double)(ts.tv_nsec);
+}
+
+
+/**
+ * Print the result of a benchmark.
+ * 
+ * @param  name   The name of the benchmark.
+ * @param  calls  The number of calls that were timed.
+ * @param  start  The time the benchmark started, in nanoseconds.
+ * @param  end    The time the benchmark ended, in nanoseconds.
+ */
+static void report(const char* restrict name, unsigned long int calls, double start, double end)
+{
+  printf("%-36s %10.2lf ns/call\n", name, (end - start) / (double)calls);
+}
+
+
+/**
+ * Benchmark the cost of dispatching calls to an adjustment
+ * method, with a `switch` over the adjustment method in comparison
+ * to an ops table, and of the library's hot functions.
+ * 
+ * @return  Zero on success, 1 on error.
+ */
+int main(void)
+{
+  libgamma_site_state_t site;
+  libgamma_partition_state_t partition;
+  libgamma_crtc_state_t crtc;
+  libgamma_crtc_information_t info;
+  libgamma_gamma_ramps16_t ramps;
+  unsigned long int i;
+  double start;
+  int r, x = 0;
+  
+  /* Synthetic benchmarks, before and after the ops table. */
+  start = now();
+  for (i = 0; i < ITERATIONS; i++)
+    x = dispatch_switch(selected_method, x);
+  report("switch over adjustment method", ITERATIONS, start, now());
+  
+  selected_stub = stubs[selected_method];
+  start = now();
+  for (i = 0; i < ITERATIONS; i++)
+    x = dispatch_ops(selected_stub, x);
+  report("cached ops table", ITERATIONS, start, now());
+  
+  /* Benchmark the library itself using the dummy adjustment method. Run
+     this program against builds of the library from before and after
+     a change to the dispatch to compare them. */
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      fprintf(stderr, "The dummy adjustment method is not available.\n");
+      return 1;
+    }
+  if ((r = libgamma_site_initialise(&site, LIBGAMMA_METHOD_DUMMY, NULL)))
+    goto fail_site;
+  if ((r = libgamma_partition_initialise(&partition, &site, 0)))
+    goto fail_partition;
+  if ((r = libgamma_crtc_initialise(&crtc, &partition, 0)))
+    goto fail_crtc;
+  if ((r = libgamma_get_crtc_information(&info, &crtc, LIBGAMMA_CRTC_INFO_GAMMA_SIZE)))
+    {
+      r = info.gamma_size_error;
+      goto fail_ramps;
+    }
+  ramps.  red_size = info.  red_gamma_size;
+  ramps.green_size = info.green_gamma_size;
+  ramps. blue_size = info. blue_gamma_size;
+  if ((r = libgamma_gamma_ramps16_initialise(&ramps)))
+    goto fail_ramps;
+  
+  start = now();
+  for (i = 0; i < ITERATIONS; i++)
+    x ^= libgamma_get_crtc_information(&info, &crtc, 0);
+  report("libgamma_get_crtc_information", ITERATIONS, start, now());
+  
+  start = now();
+  for (i = 0; i < RAMP_ITERATIONS; i++)
+    x ^= libgamma_crtc_get_gamma_ramps16(&crtc, &ramps);
+  report("libgamma_crtc_get_gamma_ramps16", RAMP_ITERATIONS, start, now());
+  
+  start = now();
+  for (i = 0; i < RAMP_ITERATIONS; i++)
+    x ^= libgamma_crtc_set_gamma_ramps16(&crtc, ramps);
+  report("libgamma_crtc_set_gamma_ramps16", RAMP_ITERATIONS, start, now());
+  
+  libgamma_gamma_ramps16_destroy(&ramps);
+  libgamma_crtc_destroy(&crtc);
+  libgamma_partition_destroy(&partition);
+  libgamma_site_destroy(&site);
+  
+  /* Use `x` so that the calls are not optimised away. */
+  return x == -1;
+  
+ fail_ramps:
+  libgamma_crtc_destroy(&crtc);
+ fail_crtc:
+  libgamma_partition_destroy(&partition);
+ fail_partition:
+  libgamma_site_destroy(&site);
+ fail_site:
+  if (r < 0)
+    libgamma_perror("libgamma", r);
+  else
+    fprintf(stderr, "libgamma: %s\n", strerror(r));
+  return 1;
+}
@@ -77,11 +77,12 @@ CGError CGSetDisplayTransferByTable(CGDirectDisplayID display, uint32_t gamma_si
   (void) green;
   (void) blue;
   
-  /* We pretend that our gamma ramps are of size 256. */
+  /* We pretend that our gamma ramps are of size 256,
+     so fail on any other size rather than crashing the program. */
   if (gamma_size != 256)
     {
       fprintf(stderr, "Gamma size should be 256.\n");
-      abort();
+      return ~kCGErrorSuccess;
     }
   return kCGErrorSuccess;
 }
@@ -105,11 +106,12 @@ CGError CGGetDisplayTransferByTable(CGDirectDisplayID display, uint32_t gamma_si
   long i;
   (void) display;
   
-  /* We pretend that our gamma ramps are of size 256. */
+  /* We pretend that our gamma ramps are of size 256,
+     so fail on any other size rather than crashing the program. */
   if (gamma_size != 256)
     {
       fprintf(stderr, "Gamma size should be 256.\n");
-      abort();
+      return ~kCGErrorSuccess;
     }
   
   /* We pretend that our gamma ramps are of size 256. */
@@ -318,11 +320,12 @@ CGError CGSetDisplayTransferByTable(CGDirectDisplayID display, uint32_t gamma_si
   long i;
   int32_t v;
   
-  /* This is a sloppy compatibility layer that assumes the gamma ramp size is 256. */
+  /* This is a sloppy compatibility layer that assumes the gamma ramp size
+     is 256, so fail on any other size rather than crashing the program. */
   if (gamma_size != 256)
     {
       fprintf(stderr, "Gamma size should be 256.\n");
-      abort();
+      return ~kCGErrorSuccess;
     }
   
   /* Translate the gamma ramps from float (CoreGraphics) to 16-bit unsigned integer (X RandR). */
@@ -372,11 +375,12 @@ CGError CGGetDisplayTransferByTable(CGDirectDisplayID display, uint32_t gamma_si
   uint16_t* restrict b_int;
   long i;
   
-  /* This is a sloppy compatibility layer that assumes the gamma ramp size is 256. */
+  /* This is a sloppy compatibility layer that assumes the gamma ramp size
+     is 256, so fail on any other size rather than crashing the program. */
   if (gamma_size != 256)
     {
       fprintf(stderr, "Gamma size should be 256.\n");
-      abort();
+      return ~kCGErrorSuccess;
     }
   
   /* The gamma ramp size should be returned to the caller. */
@@ -94,6 +94,16 @@ void libgamma_dummy_partition_destroy(libgamma_partition_state_t* restrict this)
  */
 int libgamma_dummy_partition_restore(libgamma_partition_state_t* restrict this);
 
+/**
+ * Refresh a partition state, so that it reflects the
+ * current CRTC:s of the partition.
+ * 
+ * @param   this  The partition state.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library.
+ */
+int libgamma_dummy_partition_refresh(libgamma_partition_state_t* restrict this) __attribute__((const));
+
 
 /**
  * Initialise an allocated CRTC state.
@@ -123,6 +133,18 @@ void libgamma_dummy_crtc_destroy(libgamma_crtc_state_t* restrict this);
  */
 int libgamma_dummy_crtc_restore(libgamma_crtc_state_t* restrict this);
 
+/**
+ * Move a CRTC state to another CRTC in its partition
+ * after the partition has been refreshed.
+ * 
+ * @param   this  The CRTC state.
+ * @param   crtc  The new index of the CRTC within the partition.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library. On
+ *                failure, the CRTC state is unchanged.
+ */
+int libgamma_dummy_crtc_refresh(libgamma_crtc_state_t* restrict this, size_t crtc);
+
 
 /**
  * Read information about a CRTC.
@@ -180,6 +202,37 @@ int libgamma_dummy_crtc_get_gamma_ramps16(libgamma_crtc_state_t* restrict this,
 int libgamma_dummy_crtc_set_gamma_ramps16(libgamma_crtc_state_t* restrict this,
 					  libgamma_gamma_ramps16_t ramps);
 
+/**
+ * Check whether gamma ramps can be applied to multiple CRTC:s in one update.
+ * 
+ * @param   crtcs  The CRTC states, all of them must belong to the same site.
+ * @param   count  The number of elements in `crtcs`, at least 1.
+ * @return         Non-zero, `libgamma_dummy_crtc_commit_gamma_ramps16`
+ *                 always applies the gamma ramps in one update.
+ */
+int libgamma_dummy_crtc_can_commit_atomically16(libgamma_crtc_state_t* restrict const* restrict crtcs,
+						size_t count) __attribute__((const));
+
+/**
+ * Apply gamma ramps to multiple CRTC:s as one transaction, 16-bit gamma-depth version.
+ * 
+ * The gamma ramps are first written to new buffers for all CRTC:s,
+ * and only once that has succeeded for every CRTC are the new buffers
+ * swapped in, so either all of the CRTC:s are updated or none of them.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to apply, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   flags   The transaction's flags, a combination of `LIBGAMMA_TRANSACTION_*`.
+ * @param   errors  Output parameter for the return value of each CRTC, may be
+ *                  `NULL`. The same value is stored for all CRTC:s.
+ * @return          Zero on success, otherwise (negative) the value of an
+ *                  error identifier provided by this library.
+ */
+int libgamma_dummy_crtc_commit_gamma_ramps16(libgamma_crtc_state_t* restrict const* restrict crtcs,
+					     const libgamma_gamma_ramps16_t* restrict ramps,
+					     size_t count, int flags, int* restrict errors);
+
 
 /**
  * Get the current gamma ramps for a CRTC, 32-bit gamma-depth version.
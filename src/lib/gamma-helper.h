@@ -57,6 +57,11 @@ typedef union libgamma_gamma_ramps_any
    */
   libgamma_gamma_rampsd_t float_double;
   
+  /**
+   * Half precision float gamma ramps.
+   */
+  libgamma_gamma_rampsh_t float_half;
+  
 } libgamma_gamma_ramps_any_t;
 
 
@@ -83,16 +88,269 @@ typedef int libgamma_set_ramps_any_fun(libgamma_crtc_state_t* restrict this,
 				       libgamma_gamma_ramps_any_t ramps);
 
 
+/**
+ * The number of gamma ramp depths.
+ */
+#define LIBGAMMA_DEPTH_COUNT  7
+
+/**
+ * Get the index of a gamma ramp depth in the `get` and `set`
+ * tables of `libgamma_method_ops_t`. The depth must be valid.
+ * 
+ * @param   depth  The depth of the gamma ramps, `-1` for `float`,
+ *                 `-2` for `double`, `-3` for half.
+ * @return         The index of the depth, 8, 16, 32, 64, `float`,
+ *                 `double` and half are mapped to 0 through 6.
+ */
+#define LIBGAMMA_DEPTH_INDEX(depth)                         \
+  ((depth) ==  8 ? (size_t)0 : (depth) == 16 ? (size_t)1 :  \
+   (depth) == 32 ? (size_t)2 : (depth) == 64 ? (size_t)3 :  \
+   (size_t)(3 - (depth)))
+
+
+/**
+ * An adjustment method's implementations of the library's functions.
+ * 
+ * It is resolved once, when the site is initialised, and stored in
+ * the site state, so that calling an adjustment method's function
+ * is a single indirect call rather than a `switch` over the method.
+ */
+typedef struct libgamma_method_ops
+{
+  /**
+   * The adjustment method.
+   */
+  int method;
+  
+  /**
+   * The depth of the gamma ramps that the adjustment method
+   * uses when given gamma ramps of a depth it does not support
+   * natively, `-1` for `float`, `-2` for `double`, `-3` for half.
+   */
+  signed depth;
+  
+  /**
+   * Whether the adjustment method supports multiple gamma ramp
+   * depths natively, and the depth of a CRTC can only be determined
+   * with `libgamma_get_crtc_information`.
+   */
+  int depth_per_crtc;
+  
+  /**
+   * The adjustment method's `libgamma_site_initialise`.
+   */
+  int (*site_initialise)(libgamma_site_state_t* restrict this, char* restrict site);
+  
+  /**
+   * The adjustment method's `libgamma_site_destroy`.
+   */
+  void (*site_destroy)(libgamma_site_state_t* restrict this);
+  
+  /**
+   * The adjustment method's `libgamma_site_restore`.
+   */
+  int (*site_restore)(libgamma_site_state_t* restrict this);
+  
+  /**
+   * The adjustment method's `libgamma_partition_initialise`.
+   * `libgamma_site_enumerate` moves the partition state
+   * before any CRTC on it is initialised, so the adjustment
+   * method must not keep a pointer to the partition state.
+   */
+  int (*partition_initialise)(libgamma_partition_state_t* restrict this,
+			      libgamma_site_state_t* restrict site, size_t partition);
+  
+  /**
+   * The adjustment method's `libgamma_partition_destroy`.
+   */
+  void (*partition_destroy)(libgamma_partition_state_t* restrict this);
+  
+  /**
+   * The adjustment method's `libgamma_partition_restore`.
+   */
+  int (*partition_restore)(libgamma_partition_state_t* restrict this);
+  
+  /**
+   * The adjustment method's `libgamma_crtc_initialise`.
+   */
+  int (*crtc_initialise)(libgamma_crtc_state_t* restrict this,
+			 libgamma_partition_state_t* restrict partition, size_t crtc);
+  
+  /**
+   * The adjustment method's `libgamma_crtc_destroy`.
+   */
+  void (*crtc_destroy)(libgamma_crtc_state_t* restrict this);
+  
+  /**
+   * The adjustment method's `libgamma_crtc_restore`.
+   */
+  int (*crtc_restore)(libgamma_crtc_state_t* restrict this);
+  
+  /**
+   * The adjustment method's `libgamma_get_crtc_information`.
+   */
+  int (*get_crtc_information)(libgamma_crtc_information_t* restrict this,
+			      libgamma_crtc_state_t* restrict crtc, int32_t fields);
+  
+  /**
+   * The adjustment method's `libgamma_method_capabilities`.
+   */
+  void (*method_capabilities)(libgamma_method_capabilities_t* restrict this);
+  
+  /**
+   * The adjustment method's functions for reading gamma ramps,
+   * indexed by `LIBGAMMA_DEPTH_INDEX`, `NULL` for the depths
+   * that the adjustment method does not support natively.
+   */
+  libgamma_get_ramps_any_fun* get[LIBGAMMA_DEPTH_COUNT];
+  
+  /**
+   * The adjustment method's functions for writing gamma ramps,
+   * indexed by `LIBGAMMA_DEPTH_INDEX`, `NULL` for the depths
+   * that the adjustment method does not support natively.
+   */
+  libgamma_set_ramps_any_fun* set[LIBGAMMA_DEPTH_COUNT];
+  
+  /**
+   * The adjustment method's function for reading 16-bit gamma
+   * ramps from multiple CRTC:s on the same site in one batch,
+   * `NULL` if the adjustment method cannot do better than
+   * reading them one CRTC at a time.
+   */
+  int (*get_many16)(libgamma_crtc_state_t* restrict const* restrict crtcs,
+		    libgamma_gamma_ramps16_t* restrict ramps, size_t count, int* restrict errors);
+  
+  /**
+   * The adjustment method's function for writing 16-bit gamma
+   * ramps to multiple CRTC:s on the same site in one batch,
+   * `NULL` if the adjustment method cannot do better than
+   * writing them one CRTC at a time.
+   */
+  int (*set_many16)(libgamma_crtc_state_t* restrict const* restrict crtcs,
+		    const libgamma_gamma_ramps16_t* restrict ramps, size_t count, int* restrict errors);
+  
+  /**
+   * The adjustment method's `libgamma_gamma_transaction_commit`, it applies
+   * 16-bit gamma ramps to multiple CRTC:s on the same site with the flags
+   * of the transaction. `NULL` if the adjustment method cannot apply gamma
+   * ramps any better than with `set_many16`.
+   */
+  int (*commit16)(libgamma_crtc_state_t* restrict const* restrict crtcs,
+		  const libgamma_gamma_ramps16_t* restrict ramps, size_t count, int flags, int* restrict errors);
+  
+  /**
+   * The adjustment method's function for checking whether `commit16`
+   * applies the gamma ramps of all CRTC:s in `crtcs` in one update,
+   * for `LIBGAMMA_TRANSACTION_ATOMIC`; it returns non-zero if it does.
+   * `NULL` if the adjustment method never does.
+   */
+  int (*can_commit16_atomically)(libgamma_crtc_state_t* restrict const* restrict crtcs, size_t count);
+  
+  /**
+   * The adjustment method's function for initialising the states of
+   * all partitions on a site in one batch, for `libgamma_site_enumerate`.
+   * `partitions` has `site->partitions_available` elements, and on
+   * failure, none of them are left initialised. `NULL` if the adjustment
+   * method cannot do better than initialising them one at a time.
+   */
+  int (*partition_initialise_all)(libgamma_partition_state_t* restrict partitions,
+				  libgamma_site_state_t* restrict site);
+  
+  /**
+   * The adjustment method's function for getting the handle for
+   * a CRTC, by its index, in a partition. `NULL` if the adjustment
+   * method does not have identifiers for CRTC:s, in which case the
+   * CRTC's index is used as its identifier and its connector is unknown.
+   */
+  int (*crtc_handle)(libgamma_partition_state_t* restrict partition, size_t crtc,
+		     libgamma_crtc_handle_t* restrict handle);
+  
+  /**
+   * The adjustment method's `libgamma_partition_refresh`. `NULL` if
+   * the partition state can be refreshed by initialising a new
+   * partition state and replacing the old one with it.
+   */
+  int (*partition_refresh)(libgamma_partition_state_t* restrict this);
+  
+  /**
+   * The adjustment method's function for moving a CRTC state to
+   * the CRTC with a new index after its partition has been refreshed,
+   * for `libgamma_crtc_refresh`, on failure the CRTC state must be
+   * left unchanged. `NULL` if the CRTC state can be moved by
+   * initialising a new CRTC state and replacing the old one with it.
+   */
+  int (*crtc_refresh)(libgamma_crtc_state_t* restrict this, size_t crtc);
+  
+  /**
+   * The adjustment method's `libgamma_site_event_fd`, `NULL`
+   * if the adjustment method cannot report changes to the
+   * display configuration.
+   */
+  int (*site_event_fd)(libgamma_site_state_t* restrict this);
+  
+  /**
+   * The adjustment method's `libgamma_site_set_event_fd`, `NULL`
+   * if the adjustment method cannot receive its events from
+   * any other source than the display server.
+   */
+  int (*site_set_event_fd)(libgamma_site_state_t* restrict this, int fd);
+  
+  /**
+   * The adjustment method's `libgamma_site_process_events`, `NULL`
+   * if, and only if, `site_event_fd` is `NULL`. `results` has been
+   * zeroed.
+   */
+  int (*site_process_events)(libgamma_site_state_t* restrict this,
+			     libgamma_partition_state_t* restrict partitions, size_t count,
+			     int* restrict results);
+  
+} libgamma_method_ops_t;
+
+
+/**
+ * Gamma ramps that have been translated to the format
+ * that an adjustment method uses natively.
+ */
+struct libgamma_gamma_ramps_prepared
+{
+  /**
+   * The adjustment method the gamma ramps were prepared for.
+   */
+  int method;
+  
+  /**
+   * The depth of the gamma ramps, `-1` for `float`,
+   * `-2` for `double`, `-3` for half.
+   */
+  signed depth;
+  
+  /**
+   * The adjustment method's function for applying the gamma ramps.
+   */
+  libgamma_set_ramps_any_fun* set;
+  
+  /**
+   * The gamma ramps, the stops are stored
+   * in the same allocation as the structure.
+   */
+  libgamma_gamma_ramps_any_t ramps;
+  
+};
+
+
 
 /**
  * Get the current gamma ramps for a CRTC, re-encoding versio.n
  * 
+ * The gamma ramps are also resampled if `this->resample` is not
+ * `LIBGAMMA_RESAMPLE_NONE` and their sizes do not match the CRTC's.
+ * 
  * @param   this          The CRTC state.
  * @param   ramps         The gamma ramps to fill with the current values.
  * @param   depth_user    The depth of the gamma ramps that are provided by the user,
- *                        `-1` for `float`, `-2` for `double`.
+ *                        `-1` for `float`, `-2` for `double`, `-3` for half.
  * @param   depth_system  The depth of the gamma ramps as required by the adjustment method,
- *                        `-1` for `float`, `-2` for `double`.
+ *                        `-1` for `float`, `-2` for `double`, `-3` for half.
  * @param   fun           Function that is to be used read the ramps, its parameters have
  *                        the same function as those of this function with the same names,
  *                        and the return value too is identical.
@@ -107,12 +365,15 @@ typedef int libgamma_set_ramps_any_fun(libgamma_crtc_state_t* restrict this,
 /**
  * Set the gamma ramps for a CRTC, re-encoding version
  * 
+ * The gamma ramps are also resampled if `this->resample` is not
+ * `LIBGAMMA_RESAMPLE_NONE` and their sizes do not match the CRTC's.
+ * 
  * @param   this          The CRTC state.
  * @param   ramps         The gamma ramps to apply.
  * @param   depth_user    The depth of the gamma ramps that are provided by the user,
- *                        `-1` for `float`, `-2` for `double`.
+ *                        `-1` for `float`, `-2` for `double`, `-3` for half.
  * @param   depth_system  The depth of the gamma ramps as required by the adjustment method,
- *                        `-1` for `float`, `-2` for `double`.
+ *                        `-1` for `float`, `-2` for `double`, `-3` for half.
  * @param   fun           Function that is to be used write the ramps, its parameters have
  *                        the same function as those of this function with the same names,
  *                        and the return value too is identical.
@@ -124,15 +385,52 @@ typedef int libgamma_set_ramps_any_fun(libgamma_crtc_state_t* restrict this,
 				(libgamma_set_ramps_any_fun*)(fun))
 
 
+/**
+ * Set the gamma ramps for a CRTC from a view of gamma ramps.
+ * 
+ * @param   this          The CRTC state.
+ * @param   view          The gamma ramps to apply.
+ * @param   depth_system  The depth of the gamma ramps as required by the adjustment method,
+ *                        `-1` for `float`, `-2` for `double`, `-3` for half.
+ * @param   fun           Function that is to be used write the ramps, its parameters have
+ *                        the same function as those of this function with the same names,
+ *                        and the return value too is identical.
+ * @return                Zero on success, otherwise (negative) the value of an
+ *                        error identifier provided by this library.
+ */
+#define libgamma_view_ramp_set(this, view, depth_system, fun)  \
+  libgamma_view_ramp_set_(this, view, depth_system, (libgamma_set_ramps_any_fun*)(fun))
+
+
+/**
+ * Translate a view of gamma ramps, once and for all,
+ * into gamma ramps in an adjustment method's format.
+ * 
+ * @param   this          The CRTC state.
+ * @param   view          The gamma ramps to translate.
+ * @param   depth_system  The depth of the gamma ramps as required by the adjustment method,
+ *                        `-1` for `float`, `-2` for `double`, `-3` for half.
+ * @param   fun           Function that is to be used write the ramps when they are applied.
+ * @param   prepared      Output parameter for the prepared gamma ramps.
+ * @return                Zero on success, otherwise (negative) the value of an
+ *                        error identifier provided by this library.
+ */
+#define libgamma_view_ramp_prepare(this, view, depth_system, fun, prepared)  \
+  libgamma_view_ramp_prepare_(this, view, depth_system, (libgamma_set_ramps_any_fun*)(fun), prepared)
+
+
 /**
  * Get the current gamma ramps for a CRTC, re-encoding version.
  * 
+ * The gamma ramps are also resampled if `this->resample` is not
+ * `LIBGAMMA_RESAMPLE_NONE` and their sizes do not match the CRTC's.
+ * 
  * @param   this          The CRTC state.
  * @param   ramps         The gamma ramps to fill with the current values.
  * @param   depth_user    The depth of the gamma ramps that are provided by the user,
- *                        `-1` for `float`, `-2` for `double`.
+ *                        `-1` for `float`, `-2` for `double`, `-3` for half.
  * @param   depth_system  The depth of the gamma ramps as required by the adjustment method,
- *                        `-1` for `float`, `-2` for `double`.
+ *                        `-1` for `float`, `-2` for `double`, `-3` for half.
  * @param   fun           Function that is to be used read the ramps, its parameters have
  *                        the same function as those of this function with the same names,
  *                        and the return value too is identical.
@@ -148,12 +446,15 @@ int libgamma_translated_ramp_get_(libgamma_crtc_state_t* restrict this,
 /**
  * Set the gamma ramps for a CRTC, re-encoding version.
  * 
+ * The gamma ramps are also resampled if `this->resample` is not
+ * `LIBGAMMA_RESAMPLE_NONE` and their sizes do not match the CRTC's.
+ * 
  * @param   this          The CRTC state.
  * @param   ramps         The gamma ramps to apply.
  * @param   depth_user    The depth of the gamma ramps that are provided by the user,
- *                        `-1` for `float`, `-2` for `double`.
+ *                        `-1` for `float`, `-2` for `double`, `-3` for half.
  * @param   depth_system  The depth of the gamma ramps as required by the adjustment method,
- *                        `-1` for `float`, `-2` for `double`.
+ *                        `-1` for `float`, `-2` for `double`, `-3` for half.
  * @param   fun           Function that is to be used write the ramps, its parameters have
  *                        the same function as those of this function with the same names,
  *                        and the return value too is identical.
@@ -166,5 +467,48 @@ int libgamma_translated_ramp_set_(libgamma_crtc_state_t* restrict this,
 				  libgamma_set_ramps_any_fun* fun);
 
 
+/**
+ * Set the gamma ramps for a CRTC from a view of gamma ramps.
+ * 
+ * @param   this          The CRTC state.
+ * @param   view          The gamma ramps to apply.
+ * @param   depth_system  The depth of the gamma ramps as required by the adjustment method,
+ *                        `-1` for `float`, `-2` for `double`, `-3` for half.
+ * @param   fun           Function that is to be used write the ramps, its parameters have
+ *                        the same function as those of this function with the same names,
+ *                        and the return value too is identical.
+ * @return                Zero on success, otherwise (negative) the value of an
+ *                        error identifier provided by this library.
+ */
+int libgamma_view_ramp_set_(libgamma_crtc_state_t* restrict this,
+			    const libgamma_gamma_ramps_view_t* restrict view,
+			    signed depth_system, libgamma_set_ramps_any_fun* fun);
+
+
+/**
+ * Translate a view of gamma ramps, once and for all,
+ * into gamma ramps in an adjustment method's format.
+ * 
+ * The gamma ramps are also resampled if `this->resample` is not
+ * `LIBGAMMA_RESAMPLE_NONE` and their sizes do not match the CRTC's.
+ * 
+ * @param   this          The CRTC state.
+ * @param   view          The gamma ramps to translate.
+ * @param   depth_system  The depth of the gamma ramps as required by the adjustment method,
+ *                        `-1` for `float`, `-2` for `double`, `-3` for half.
+ * @param   fun           Function that is to be used write the ramps, its parameters have
+ *                        the same function as those of `libgamma_view_ramp_set_` with the
+ *                        same names, and the return value too is identical.
+ * @param   prepared      Output parameter for the prepared gamma ramps, they
+ *                        shall be released with `libgamma_gamma_ramps_prepared_free`.
+ * @return                Zero on success, otherwise (negative) the value of an
+ *                        error identifier provided by this library.
+ */
+int libgamma_view_ramp_prepare_(libgamma_crtc_state_t* restrict this,
+				const libgamma_gamma_ramps_view_t* restrict view,
+				signed depth_system, libgamma_set_ramps_any_fun* fun,
+				libgamma_gamma_ramps_prepared_t** restrict prepared);
+
+
 #endif
 
@@ -25,6 +25,8 @@
 
 #include "libgamma-error.h"
 #include "edid.h"
+#include "uevent.h"
+#include "gamma-pool.h"
 
 #include <limits.h>
 #include <stdlib.h>
@@ -36,6 +38,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <inttypes.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
 
 #include <xf86drm.h>
 #include <xf86drmMode.h>
@@ -50,6 +54,27 @@
 # define PATH_MAX  4096
 #endif
 
+/**
+ * The size of the buffer uevents are read into, the kernel limits
+ * uevents to 2048 bytes, and one byte is added for a NUL-terminator.
+ */
+#define UEVENT_BUFFER_SIZE  (2048 + 1)
+
+
+
+/**
+ * Site data for the Direct Rendering Manager adjustment method.
+ */
+typedef struct libgamma_drm_site_data
+{
+  /**
+   * The socket that kernel uevents for graphics cards are received
+   * on, -1 until `libgamma_site_event_fd` has been called.
+   */
+  int uevent_fd;
+  
+} libgamma_drm_site_data_t;
+
 
 
 /**
@@ -77,6 +102,26 @@ typedef struct libgamma_drm_card_data
    */
   drmModeEncoder** encoders;
   
+  /**
+   * Whether atomic mode setting is supported, 1 if it is, -1
+   * if it is not, and 0 if that has not been determined yet.
+   */
+  int atomic;
+  
+  /**
+   * The ID of the `GAMMA_LUT` property of each CRTC, in the same
+   * order as in `res->crtcs`, zero for CRTC:s without the property.
+   * `NULL` until `atomic` has been determined to be 1.
+   */
+  uint32_t* gamma_lut_properties;
+  
+  /**
+   * The value of the `GAMMA_LUT_SIZE` property of each CRTC, in
+   * the same order as in `res->crtcs`, zero if it is not known.
+   * `NULL` until `atomic` has been determined to be 1.
+   */
+  size_t* gamma_lut_sizes;
+  
 } libgamma_drm_card_data_t;
 
 
@@ -116,33 +161,60 @@ void libgamma_linux_drm_method_capabilities(libgamma_method_capabilities_t* rest
   this->fake = 0;
   /* Gamma ramp adjustments are persistent. */
   this->auto_restore = 0;
+  /* Transactions are atomic if the driver supports atomic mode setting. */
+  this->atomic_transactions = 1;
 }
 
 
 /**
- * Initialise an allocated site state.
+ * Translate the value of `errno` after a failure to apply gamma ramps.
  * 
- * @param   this    The site state to initialise.
- * @param   site    The site identifier, unless it is `NULL` it must a
- *                  `free`:able. Once the state is destroyed the library
- *                  will attempt to free it. There you should not free
- *                  it yourself, and it must not be a string constant
- *                  or allocate on the stack. Note however that it will
- *                  not be free:d if this function fails.
- * @return          Zero on success, otherwise (negative) the value of an
- *                  error identifier provided by this library.
+ * @return  Zero if the failure shall be ignored, otherwise (negative) the
+ *          value of an error identifier provided by this library.
  */
-int libgamma_linux_drm_site_initialise(libgamma_site_state_t* restrict this,
-				       char* restrict site)
+static int translate_set_error(void)
+{
+  switch (errno)
+    {
+    case EACCES:
+    case EAGAIN:
+    case EIO:
+      /* Permission denied errors must be ignored, because we do not
+       * have permission to do this while a display server is active.
+       * We are also checking for some other error codes just in case. */
+    case EBUSY:
+    case EINPROGRESS:
+      /* It is hard to find documentation for DRM (in fact all of this is
+       * just based on the functions names and some testing,) perhaps we
+       * could get this if we are updating to fast. */
+      break;
+    case EBADF:
+    case ENODEV:
+    case ENXIO:
+      /* XXX: I have not actually tested removing my graphics card or,
+       *      monitor but I imagine either of these is what would happen. */
+      return LIBGAMMA_GRAPHICS_CARD_REMOVED;
+
+    default:
+      return LIBGAMMA_ERRNO_SET;
+    }
+  return 0;
+}
+
+
+/**
+ * Count the number of available graphics cards by
+ * `stat`:ing their existence in an API filesystem.
+ * 
+ * @param   this  The site state, its `partitions_available` is set.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library.
+ */
+static int count_cards(libgamma_site_state_t* restrict this)
 {
   char pathname[PATH_MAX];
   struct stat _attr;
   
-  if (site != NULL)
-    return LIBGAMMA_NO_SUCH_SITE;
-  
-  /* Count the number of available graphics cards by
-     `stat`:ing their existence in an API filesystem. */
   this->partitions_available = 0;
   for (;;)
     {
@@ -160,6 +232,39 @@ int libgamma_linux_drm_site_initialise(libgamma_site_state_t* restrict this,
 }
 
 
+/**
+ * Initialise an allocated site state.
+ * 
+ * @param   this    The site state to initialise.
+ * @param   site    The site identifier, unless it is `NULL` it must a
+ *                  `free`:able. Once the state is destroyed the library
+ *                  will attempt to free it. There you should not free
+ *                  it yourself, and it must not be a string constant
+ *                  or allocate on the stack. Note however that it will
+ *                  not be free:d if this function fails.
+ * @return          Zero on success, otherwise (negative) the value of an
+ *                  error identifier provided by this library.
+ */
+int libgamma_linux_drm_site_initialise(libgamma_site_state_t* restrict this,
+				       char* restrict site)
+{
+  libgamma_drm_site_data_t* restrict data;
+  int r;
+  
+  if (site != NULL)
+    return LIBGAMMA_NO_SUCH_SITE;
+  
+  if ((r = count_cards(this)))
+    return r;
+  
+  if ((data = libgamma_allocate(sizeof(libgamma_drm_site_data_t))) == NULL)
+    return LIBGAMMA_ERRNO_SET;
+  data->uevent_fd = -1;
+  this->data = data;
+  return 0;
+}
+
+
 /**
  * Release all resources held by a site state.
  * 
@@ -167,7 +272,10 @@ int libgamma_linux_drm_site_initialise(libgamma_site_state_t* restrict this,
  */
 void libgamma_linux_drm_site_destroy(libgamma_site_state_t* restrict this)
 {
-  (void) this;
+  libgamma_drm_site_data_t* restrict data = this->data;
+  if (data->uevent_fd >= 0)
+    close(data->uevent_fd);
+  libgamma_deallocate(data);
 }
 
 
@@ -185,6 +293,174 @@ int libgamma_linux_drm_site_restore(libgamma_site_state_t* restrict this)
 }
 
 
+/**
+ * Start listening for kernel uevents for graphics cards, if not
+ * already listening, and get the socket they are received on.
+ * 
+ * @param   this  The site state.
+ * @return        The file descriptor of the socket, otherwise (negative)
+ *                the value of an error identifier provided by this library.
+ */
+int libgamma_linux_drm_site_event_fd(libgamma_site_state_t* restrict this)
+{
+  libgamma_drm_site_data_t* restrict data = this->data;
+  struct sockaddr_nl address;
+  int fd, saved_errno;
+  
+  if (data->uevent_fd >= 0)
+    return data->uevent_fd;
+  
+  /* Join the kernel's uevent multicast group. */
+  fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+  if (fd < 0)
+    return LIBGAMMA_ERRNO_SET;
+  memset(&address, 0, sizeof(address));
+  address.nl_family = AF_NETLINK;
+  address.nl_groups = 1;
+  if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+    {
+      saved_errno = errno;
+      close(fd);
+      return errno = saved_errno, LIBGAMMA_ERRNO_SET;
+    }
+  
+  return data->uevent_fd = fd;
+}
+
+
+/**
+ * Replace the socket that kernel uevents are received on.
+ * 
+ * @param   this  The site state.
+ * @param   fd    The new socket, it will be closed by the library.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library.
+ */
+int libgamma_linux_drm_site_set_event_fd(libgamma_site_state_t* restrict this, int fd)
+{
+  libgamma_drm_site_data_t* restrict data = this->data;
+  if (data->uevent_fd >= 0)
+    close(data->uevent_fd);
+  data->uevent_fd = fd;
+  return 0;
+}
+
+
+/**
+ * Open a graphics card anew, for example after it has been
+ * removed and added again, and replace its partition state.
+ * 
+ * @param   this  The partition state.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library.
+ */
+static int reopen_card(libgamma_partition_state_t* restrict this)
+{
+  libgamma_partition_state_t fresh;
+  int r;
+  
+  fresh.site = this->site;
+  fresh.partition = this->partition;
+  if ((r = libgamma_linux_drm_partition_initialise(&fresh, this->site, this->partition)))
+    return r;
+  libgamma_linux_drm_partition_destroy(this);
+  *this = fresh;
+  return 0;
+}
+
+
+/**
+ * Read all pending kernel uevents, and refresh the
+ * partition states for the graphics cards they are for.
+ * 
+ * @param   this        The site state.
+ * @param   partitions  The partition states that may be refreshed.
+ * @param   count       The number of elements in `partitions` and `results`.
+ * @param   results     For each partition state, set to 1 if it was refreshed,
+ *                      or (negative) the value of an error identifier provided by
+ *                      this library if it could not be refreshed, left as zero
+ *                      if the partition has not changed.
+ * @return              The number of partition states that have changed, otherwise
+ *                      (negative) the value of an error identifier provided by this
+ *                      library, if the uevents could not be read.
+ */
+int libgamma_linux_drm_site_process_events(libgamma_site_state_t* restrict this,
+					   libgamma_partition_state_t* restrict partitions, size_t count,
+					   int* restrict results)
+{
+  libgamma_drm_site_data_t* restrict data = this->data;
+  char message[UEVENT_BUFFER_SIZE];
+  struct sockaddr_storage address;
+  socklen_t address_length;
+  ssize_t got;
+  size_t card, i;
+  int event, r, changed = 0;
+  
+  if (data->uevent_fd < 0)
+    return 0;
+  
+  for (;;)
+    {
+      address.ss_family = AF_UNSPEC;
+      address_length = (socklen_t)sizeof(address);
+      got = recvfrom(data->uevent_fd, message, sizeof(message) - 1, MSG_DONTWAIT,
+		     (struct sockaddr*)&address, &address_length);
+      if (got < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  if (errno == EAGAIN)
+	    break;
+	  if (errno != ENOBUFS)
+	    return LIBGAMMA_ERRNO_SET;
+	  /* Uevents have been lost, so any card may have changed. */
+	  for (i = 0; i < count; i++)
+	    if (results[i] == 0)
+	      results[i] = LIBGAMMA_UEVENT_CHANGE;
+	  continue;
+	}
+      if (got == 0)
+	break;
+      message[got] = '\0';
+      
+      /* Only the kernel may send to the uevent multicast group,
+	 ignore messages from user space, but allow any sender
+	 on other kinds of sockets, used to inject uevents. */
+      if ((address.ss_family == AF_NETLINK) && (((struct sockaddr_nl*)&address)->nl_pid != 0))
+	continue;
+      
+      if ((event = libgamma_parse_uevent(message, (size_t)got, &card)) == 0)
+	continue;
+      if (event != LIBGAMMA_UEVENT_CHANGE)
+	count_cards(this);
+      /* The last uevent for a card decides, a card that is removed
+	 and added again is opened again, not removed. A change after
+	 the card was added is covered by opening it again. */
+      for (i = 0; i < count; i++)
+	if (partitions[i].partition == card)
+	  if ((event != LIBGAMMA_UEVENT_CHANGE) || (results[i] != LIBGAMMA_UEVENT_ADD))
+	    results[i] = event;
+    }
+  
+  /* Refresh each changed partition once, however many uevents it got. */
+  for (i = 0; i < count; i++)
+    {
+      if (results[i] == 0)
+	continue;
+      changed++;
+      if (results[i] == LIBGAMMA_UEVENT_REMOVE)
+	results[i] = LIBGAMMA_GRAPHICS_CARD_REMOVED;
+      else if (results[i] == LIBGAMMA_UEVENT_ADD)
+	/* The file descriptor refers to the card as it was before it was removed. */
+	results[i] = (r = reopen_card(partitions + i)) ? r : 1;
+      else
+	results[i] = (r = libgamma_linux_drm_partition_refresh(partitions + i)) ? r : 1;
+    }
+  
+  return changed;
+}
+
+
 /**
  * Figure out why `open` failed for a graphics card
  * 
@@ -309,13 +585,16 @@ int libgamma_linux_drm_partition_initialise(libgamma_partition_state_t* restrict
   
   /* Allocate and initialise graphics card data.  */
   this->data = NULL;
-  data = malloc(sizeof(libgamma_drm_card_data_t));
+  data = libgamma_allocate(sizeof(libgamma_drm_card_data_t));
   if (data == NULL)
     return LIBGAMMA_ERRNO_SET;
   data->fd = -1;
   data->res = NULL;
   data->encoders = NULL;
   data->connectors = NULL;
+  data->atomic = 0;
+  data->gamma_lut_properties = NULL;
+  data->gamma_lut_sizes = NULL;
   
   /* Get the pathname for the graphics card. */
   snprintf(pathname, sizeof(pathname) / sizeof(char),
@@ -349,7 +628,7 @@ int libgamma_linux_drm_partition_initialise(libgamma_partition_state_t* restrict
   
  fail_res:   drmModeFreeResources(data->res);
  fail_fd:    close(data->fd);
- fail_data:  free(data);
+ fail_data:  libgamma_deallocate(data);
   return rc;
 }
 
@@ -368,7 +647,7 @@ static void release_connectors_and_encoders(libgamma_drm_card_data_t* restrict t
       if (this->encoders[i] != NULL)
 	drmModeFreeEncoder(this->encoders[i]);
   /* Release encoder array. */
-  free(this->encoders);
+  libgamma_deallocate(this->encoders);
   this->encoders = NULL;
   
   /* Release individual connectors. */
@@ -377,7 +656,7 @@ static void release_connectors_and_encoders(libgamma_drm_card_data_t* restrict t
       if (this->connectors[i] != NULL)
 	drmModeFreeConnector(this->connectors[i]);
   /* Release connector array. */
-  free(this->connectors);
+  libgamma_deallocate(this->connectors);
   this->connectors = NULL;
 }
 
@@ -391,9 +670,11 @@ void libgamma_linux_drm_partition_destroy(libgamma_partition_state_t* restrict t
 {
   libgamma_drm_card_data_t* restrict data = this->data;
   release_connectors_and_encoders(data);
+  libgamma_deallocate(data->gamma_lut_properties);
+  libgamma_deallocate(data->gamma_lut_sizes);
   if (data->res != NULL)  drmModeFreeResources(data->res);
   if (data->fd >= 0)      close(data->fd);
-  free(data);
+  libgamma_deallocate(data);
 }
 
 
@@ -411,6 +692,50 @@ int libgamma_linux_drm_partition_restore(libgamma_partition_state_t* restrict th
 }
 
 
+/**
+ * Refresh a partition state, so that it reflects the current CRTC:s of the
+ * graphics card. The graphics card is not reopened, only its mode resources
+ * are read again, and its connectors and encoders are released to be read
+ * again when they are needed.
+ * 
+ * @param   this  The partition state.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library.
+ */
+int libgamma_linux_drm_partition_refresh(libgamma_partition_state_t* restrict this)
+{
+  libgamma_drm_card_data_t* restrict data = this->data;
+  drmModeRes* restrict res;
+  
+  if ((res = drmModeGetResources(data->fd)) == NULL)
+    return LIBGAMMA_ACQUIRING_MODE_RESOURCES_FAILED;
+  if (res->count_crtcs < 0)
+    {
+      drmModeFreeResources(res);
+      return LIBGAMMA_NEGATIVE_CRTC_COUNT;
+    }
+  
+  release_connectors_and_encoders(data);
+  
+  /* The `GAMMA_LUT` properties are indexed by CRTC index,
+     so they are only valid if the CRTC:s are unchanged. */
+  if ((res->count_crtcs != data->res->count_crtcs) ||
+      memcmp(res->crtcs, data->res->crtcs, (size_t)(res->count_crtcs) * sizeof(uint32_t)))
+    {
+      libgamma_deallocate(data->gamma_lut_properties);
+      libgamma_deallocate(data->gamma_lut_sizes);
+      data->gamma_lut_properties = NULL;
+      data->gamma_lut_sizes = NULL;
+      data->atomic = 0;
+    }
+  
+  drmModeFreeResources(data->res);
+  data->res = res;
+  this->crtcs_available = (size_t)(res->count_crtcs);
+  return 0;
+}
+
+
 
 /**
  * Initialise an allocated CRTC state.
@@ -461,23 +786,23 @@ int libgamma_linux_drm_crtc_restore(libgamma_crtc_state_t* restrict this)
 /**
  * Find the connector that a CRTC belongs to.
  * 
- * @param   this   The CRTC state.
- * @param   error  Output of the error value to store of error report
- *                 fields for data that requires the connector.
-'* @return         The CRTC's conncetor, `NULL` on error.
+ * @param   card     The graphics card the CRTC belongs to.
+ * @param   crtc_id  The CRTC's ID.
+ * @param   error    Output of the error value to store of error report
+ *                   fields for data that requires the connector.
+'* @return           The CRTC's conncetor, `NULL` on error.
  */
-static drmModeConnector* find_connector(libgamma_crtc_state_t* restrict this, int* restrict error)
+static drmModeConnector* find_connector(libgamma_drm_card_data_t* restrict card, uint32_t crtc_id,
+					int* restrict error)
 {
-  uint32_t crtc_id = (uint32_t)(size_t)(this->data);
-  libgamma_drm_card_data_t* restrict card = this->partition->data;
   size_t i, n = (size_t)(card->res->count_connectors);
   /* Open connectors and encoders if not already opened. */
   if (card->connectors == NULL)
     {
       /* Allocate connector and encoder arrays.
-	 We use `calloc` so all non-loaded elements are `NULL` after an error. */
-      if ((card->connectors = calloc(n, sizeof(drmModeConnector*))) == NULL)  goto fail;
-      if ((card->encoders   = calloc(n, sizeof(drmModeEncoder*)))   == NULL)  goto fail;
+	 We use `libgamma_callocate` so all non-loaded elements are `NULL` after an error. */
+      if ((card->connectors = libgamma_callocate(n, sizeof(drmModeConnector*))) == NULL)  goto fail;
+      if ((card->encoders   = libgamma_callocate(n, sizeof(drmModeEncoder*)))   == NULL)  goto fail;
       /* Fill connector and encoder arrays. */
       for (i = 0; i < n; i++)
 	{
@@ -513,6 +838,33 @@ static drmModeConnector* find_connector(libgamma_crtc_state_t* restrict this, in
 }
 
 
+/**
+ * Get the handle for a CRTC. If the connector that the CRTC
+ * drives cannot be found, the handle's connector is zero.
+ * 
+ * @param   partition  The partition state for the partition that the CRTC belongs to.
+ * @param   crtc       The index of the CRTC within the partition.
+ * @param   handle     Output parameter for the CRTC's handle.
+ * @return             Zero on success, otherwise (negative) the value of an
+ *                     error identifier provided by this library.
+ */
+int libgamma_linux_drm_crtc_handle(libgamma_partition_state_t* restrict partition, size_t crtc,
+				   libgamma_crtc_handle_t* restrict handle)
+{
+  libgamma_drm_card_data_t* restrict card = partition->data;
+  drmModeConnector* restrict connector;
+  int error;
+  if (crtc >= partition->crtcs_available)
+    return LIBGAMMA_NO_SUCH_CRTC;
+  handle->crtc = (uint64_t)(card->res->crtcs[crtc]);
+  /* The connector only helps finding the CRTC again, so a CRTC
+     whose connector cannot be found, or read, is not an error. */
+  connector = find_connector(card, card->res->crtcs[crtc], &error);
+  handle->connector = connector == NULL ? 0 : (uint64_t)(connector->connector_id);
+  return 0;
+}
+
+
 /**
  * Get the size of the gamma ramps for a CRTC.
  * 
@@ -680,7 +1032,7 @@ static int read_connector_data(libgamma_crtc_state_t* restrict crtc, libgamma_cr
       size_t i, n = (size_t)(card->res->count_connectors), c = 0;
       
       /* Allocate memory for the name of the connector. */
-      out->connector_name = malloc((strlen(connector_name_base) + 12) * sizeof(char));
+      out->connector_name = libgamma_allocate_exported((strlen(connector_name_base) + 12) * sizeof(char));
       if (out->connector_name == NULL)
 	return out->connector_name_error = errno;
       
@@ -732,7 +1084,7 @@ static int get_edid(libgamma_crtc_state_t* restrict crtc,
 	      /* Get and store the length of the EDID. */
 	      out->edid_length = blob->length;
 	      /* Allocate memory for a copy of the EDID that is under our memory control. */
-	      if ((out->edid = malloc(out->edid_length * sizeof(unsigned char))) == NULL)
+	      if ((out->edid = libgamma_allocate_exported(out->edid_length * sizeof(unsigned char))) == NULL)
 		out->edid_error = errno;
 	      else
 		/* Copy the EDID so we can free resources that got us here. */
@@ -786,7 +1138,7 @@ int libgamma_linux_drm_get_crtc_information(libgamma_crtc_information_t* restric
   if (require_connector == 0)
     goto cont;
   /* Find connector. */
-  if ((connector = find_connector(crtc, &error)) == NULL)
+  if ((connector = find_connector(crtc->partition->data, (uint32_t)(size_t)(crtc->data), &error)) == NULL)
     {
       /* Store reported error in affected fields. */
       e |= this->width_mm_error       = this->height_mm_error
@@ -833,7 +1185,7 @@ int libgamma_linux_drm_get_crtc_information(libgamma_crtc_information_t* restric
   /* Free the EDID after us. */
   if (free_edid)
     {
-      free(this->edid);
+      libgamma_deallocate_exported(this->edid);
       this->edid = NULL;
     }
   
@@ -868,6 +1220,254 @@ int libgamma_linux_drm_crtc_get_gamma_ramps16(libgamma_crtc_state_t* restrict th
 }
 
 
+/**
+ * Get the current gamma ramps for multiple CRTC:s on the same site, 16-bit gamma-depth version.
+ * 
+ * The gamma ramps are read one CRTC after the other,
+ * without going through the library's facade for each CRTC.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to fill with the current values, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   errors  Output parameter for the return value of each CRTC, may be `NULL`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; this is the error of
+ *                  the first CRTC that failed.
+ */
+int libgamma_linux_drm_crtc_get_gamma_ramps16_many(libgamma_crtc_state_t* restrict const* restrict crtcs,
+						   libgamma_gamma_ramps16_t* restrict ramps,
+						   size_t count, int* restrict errors)
+{
+  libgamma_drm_card_data_t* restrict card;
+  size_t i;
+  int r, rc = 0;
+  
+  for (i = 0; i < count; i++)
+    {
+      card = crtcs[i]->partition->data;
+#ifdef DEBUG
+      /* Gamma ramp sizes are identical but not fixed. */
+      if ((ramps[i].red_size != ramps[i].green_size) ||
+	  (ramps[i].red_size != ramps[i].blue_size))
+	r = LIBGAMMA_MIXED_GAMMA_RAMP_SIZE;
+      else
+#endif
+      if (drmModeCrtcGetGamma(card->fd, (uint32_t)(size_t)(crtcs[i]->data), (uint32_t)(ramps[i].red_size),
+			      ramps[i].red, ramps[i].green, ramps[i].blue))
+	r = LIBGAMMA_GAMMA_RAMP_READ_FAILED;
+      else
+	r = 0;
+      if (errors != NULL)
+	errors[i] = r;
+      if (r && !rc)
+	rc = r;
+    }
+  
+  return rc;
+}
+
+
+
+/**
+ * Enable atomic mode setting for a graphics card, if it supports it,
+ * and look up the `GAMMA_LUT` and `GAMMA_LUT_SIZE` properties of each
+ * of its CRTC:s.
+ * 
+ * @param   card  The graphics card data.
+ * @return        Whether atomic mode setting is supported.
+ */
+static int enable_atomic(libgamma_drm_card_data_t* restrict card)
+{
+  drmModeObjectProperties* props;
+  drmModePropertyRes* prop;
+  size_t i, n = (size_t)(card->res->count_crtcs);
+  uint32_t j;
+  
+  if (card->atomic)
+    return card->atomic > 0;
+  
+  card->atomic = -1;
+  if (drmSetClientCap(card->fd, DRM_CLIENT_CAP_ATOMIC, 1))
+    return 0;
+  if ((card->gamma_lut_properties = libgamma_callocate(n ? n : 1, sizeof(uint32_t))) == NULL)
+    return 0;
+  if ((card->gamma_lut_sizes = libgamma_callocate(n ? n : 1, sizeof(size_t))) == NULL)
+    return 0;
+  
+  for (i = 0; i < n; i++)
+    {
+      props = drmModeObjectGetProperties(card->fd, card->res->crtcs[i], DRM_MODE_OBJECT_CRTC);
+      if (props == NULL)
+	continue;
+      for (j = 0; j < props->count_props; j++)
+	if ((prop = drmModeGetProperty(card->fd, props->props[j])) != NULL)
+	  {
+	    if (!strcmp(prop->name, "GAMMA_LUT"))
+	      card->gamma_lut_properties[i] = prop->prop_id;
+	    else if (!strcmp(prop->name, "GAMMA_LUT_SIZE"))
+	      card->gamma_lut_sizes[i] = (size_t)(props->prop_values[j]);
+	    drmModeFreeProperty(prop);
+	  }
+      drmModeFreeObjectProperties(props);
+    }
+  
+  card->atomic = 1;
+  return 1;
+}
+
+
+/**
+ * Check whether gamma ramps can be applied to multiple CRTC:s in one
+ * atomic commit, that is, whether all CRTC:s are on the same graphics
+ * card and it supports atomic mode setting and `GAMMA_LUT`.
+ * 
+ * @param   crtcs  The CRTC states, all of them must belong to the same site.
+ * @param   count  The number of elements in `crtcs`, at least 1.
+ * @return         Non-zero if `libgamma_linux_drm_crtc_commit_gamma_ramps16`
+ *                 applies the gamma ramps in one atomic commit.
+ */
+int libgamma_linux_drm_crtc_can_commit_atomically16(libgamma_crtc_state_t* restrict const* restrict crtcs, size_t count)
+{
+  libgamma_drm_card_data_t* restrict card = crtcs[0]->partition->data;
+  size_t i;
+  
+  for (i = 1; i < count; i++)
+    if (crtcs[i]->partition != crtcs[0]->partition)
+      return 0;
+  if (!enable_atomic(card))
+    return 0;
+  for (i = 0; i < count; i++)
+    if (card->gamma_lut_properties[crtcs[i]->crtc] == 0)
+      return 0;
+  return 1;
+}
+
+
+/**
+ * Apply gamma ramps to multiple CRTC:s as one transaction, 16-bit gamma-depth version.
+ * 
+ * If all CRTC:s are on the same graphics card and it supports atomic mode
+ * setting and `GAMMA_LUT`, the gamma ramps are applied in one atomic commit,
+ * so either all of them or none of them are applied. Otherwise, they are
+ * applied one CRTC at a time.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to apply, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   flags   The transaction's flags, a combination of `LIBGAMMA_TRANSACTION_*`.
+ * @param   errors  Output parameter for the return value of each CRTC, may be `NULL`.
+ *                  If the gamma ramps are applied in one atomic commit, the same
+ *                  value is stored for all CRTC:s.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; this is the error of
+ *                  the first CRTC that failed. `LIBGAMMA_WRONG_GAMMA_RAMP_SIZE`
+ *                  if the gamma ramps are applied in one atomic commit, but
+ *                  their size is not the CRTC's `GAMMA_LUT_SIZE`.
+ */
+int libgamma_linux_drm_crtc_commit_gamma_ramps16(libgamma_crtc_state_t* restrict const* restrict crtcs,
+						 const libgamma_gamma_ramps16_t* restrict ramps,
+						 size_t count, int flags, int* restrict errors)
+{
+  libgamma_drm_card_data_t* restrict card = crtcs[0]->partition->data;
+  drmModeAtomicReq* restrict req = NULL;
+  struct drm_color_lut* restrict lut;
+  uint32_t* restrict blobs = NULL;
+  size_t i, j, n;
+  int r = 0, rc = 0, saved_errno;
+  
+  (void) flags;
+  
+  if (!libgamma_linux_drm_crtc_can_commit_atomically16(crtcs, count))
+    goto one_at_a_time;
+  
+  if ((req = drmModeAtomicAlloc()) == NULL)
+    goto fail;
+  if ((blobs = libgamma_callocate(count, sizeof(uint32_t))) == NULL)
+    goto fail;
+  
+  for (i = 0; i < count; i++)
+    {
+      /* GAMMA_LUT stores all channels in the same entries. */
+      n = ramps[i].red_size;
+      if ((ramps[i].green_size != n) || (ramps[i].blue_size != n))
+	{
+	  r = LIBGAMMA_MIXED_GAMMA_RAMP_SIZE;
+	  goto done;
+	}
+      /* The kernel rejects blobs of any other size than `GAMMA_LUT_SIZE`. */
+      if (card->gamma_lut_sizes[crtcs[i]->crtc] && (n != card->gamma_lut_sizes[crtcs[i]->crtc]))
+	{
+	  r = LIBGAMMA_WRONG_GAMMA_RAMP_SIZE;
+	  goto done;
+	}
+      if ((lut = libgamma_allocate(n * sizeof(struct drm_color_lut))) == NULL)
+	goto fail;
+      for (j = 0; j < n; j++)
+	{
+	  lut[j].red      = ramps[i].red[j];
+	  lut[j].green    = ramps[i].green[j];
+	  lut[j].blue     = ramps[i].blue[j];
+	  lut[j].reserved = 0;
+	}
+      r = drmModeCreatePropertyBlob(card->fd, lut, n * sizeof(struct drm_color_lut), blobs + i);
+      saved_errno = errno;
+      libgamma_deallocate(lut);
+      errno = saved_errno;
+      if (r)
+	goto fail_drm;
+      /* These functions return the negative error number on failure. */
+      r = drmModeAtomicAddProperty(req, (uint32_t)(size_t)(crtcs[i]->data),
+				   card->gamma_lut_properties[crtcs[i]->crtc], blobs[i]);
+      if (r < 0)
+	{
+	  errno = -r;
+	  goto fail_drm;
+	}
+    }
+  
+  /* Apply all gamma ramps in one update. */
+  r = drmModeAtomicCommit(card->fd, req, 0, NULL);
+  if (r)
+    {
+      errno = -r;
+      goto fail_drm;
+    }
+  goto done;
+  
+ fail:
+  r = LIBGAMMA_ERRNO_SET;
+  goto done;
+ fail_drm:
+  /* Translated as when the gamma ramps are applied one CRTC at a time. */
+  r = translate_set_error();
+ done:
+  saved_errno = errno;
+  if (blobs != NULL)
+    for (i = 0; i < count; i++)
+      if (blobs[i] != 0)
+	drmModeDestroyPropertyBlob(card->fd, blobs[i]);
+  libgamma_deallocate(blobs);
+  if (req != NULL)
+    drmModeAtomicFree(req);
+  errno = saved_errno;
+  if (errors != NULL)
+    for (i = 0; i < count; i++)
+      errors[i] = r;
+  return r;
+  
+ one_at_a_time:
+  for (i = 0; i < count; i++)
+    {
+      r = libgamma_linux_drm_crtc_set_gamma_ramps16(crtcs[i], ramps[i]);
+      if (errors != NULL)
+	errors[i] = r;
+      if (r && !rc)
+	rc = r;
+    }
+  return rc;
+}
+
+
 /**
  * Set the gamma ramps for a CRTC, 16-bit gamma-depth version.
  * 
@@ -892,31 +1492,6 @@ int libgamma_linux_drm_crtc_set_gamma_ramps16(libgamma_crtc_state_t* restrict th
   r = drmModeCrtcSetGamma(card->fd, (uint32_t)(size_t)(this->data),
 			  (uint32_t)(ramps.red_size), ramps.red, ramps.green, ramps.blue);
   /* Check for errors. */
-  if (r)
-    switch (errno)
-      {
-      case EACCES:
-      case EAGAIN:
-      case EIO:
-	/* Permission denied errors must be ignored, because we do not
-	 * have permission to do this while a display server is active.
-	 * We are also checking for some other error codes just in case. */
-      case EBUSY:
-      case EINPROGRESS:
-	/* It is hard to find documentation for DRM (in fact all of this is
-	 * just based on the functions names and some testing,) perhaps we
-	 * could get this if we are updating to fast. */
-	break;
-      case EBADF:
-      case ENODEV:
-      case ENXIO:
-	/* XXX: I have not actually tested removing my graphics card or,
-	 *      monitor but I imagine either of these is what would happen. */
-	return LIBGAMMA_GRAPHICS_CARD_REMOVED;
-
-      default:
-	return LIBGAMMA_ERRNO_SET;
-      }
-  return 0;
+  return r ? translate_set_error() : 0;
 }
 
@@ -54,7 +54,7 @@ int libgamma_linux_drm_site_initialise(libgamma_site_state_t* restrict this,
  * 
  * @param  this  The site state.
  */
-void libgamma_linux_drm_site_destroy(libgamma_site_state_t* restrict this) __attribute__((const));
+void libgamma_linux_drm_site_destroy(libgamma_site_state_t* restrict this);
 
 /**
  * Restore the gamma ramps all CRTC:s with a site to the system settings.
@@ -65,6 +65,45 @@ void libgamma_linux_drm_site_destroy(libgamma_site_state_t* restrict this) __att
  */
 int libgamma_linux_drm_site_restore(libgamma_site_state_t* restrict this);
 
+/**
+ * Start listening for kernel uevents for graphics cards, if not
+ * already listening, and get the socket they are received on.
+ * 
+ * @param   this  The site state.
+ * @return        The file descriptor of the socket, otherwise (negative)
+ *                the value of an error identifier provided by this library.
+ */
+int libgamma_linux_drm_site_event_fd(libgamma_site_state_t* restrict this);
+
+/**
+ * Replace the socket that kernel uevents are received on.
+ * 
+ * @param   this  The site state.
+ * @param   fd    The new socket, it will be closed by the library.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library.
+ */
+int libgamma_linux_drm_site_set_event_fd(libgamma_site_state_t* restrict this, int fd);
+
+/**
+ * Read all pending kernel uevents, and refresh the
+ * partition states for the graphics cards they are for.
+ * 
+ * @param   this        The site state.
+ * @param   partitions  The partition states that may be refreshed.
+ * @param   count       The number of elements in `partitions` and `results`.
+ * @param   results     For each partition state, set to 1 if it was refreshed,
+ *                      or (negative) the value of an error identifier provided by
+ *                      this library if it could not be refreshed, left as zero
+ *                      if the partition has not changed.
+ * @return              The number of partition states that have changed, otherwise
+ *                      (negative) the value of an error identifier provided by this
+ *                      library, if the uevents could not be read.
+ */
+int libgamma_linux_drm_site_process_events(libgamma_site_state_t* restrict this,
+					   libgamma_partition_state_t* restrict partitions, size_t count,
+					   int* restrict results);
+
 
 /**
  * Initialise an allocated partition state.
@@ -94,6 +133,18 @@ void libgamma_linux_drm_partition_destroy(libgamma_partition_state_t* restrict t
  */
 int libgamma_linux_drm_partition_restore(libgamma_partition_state_t* restrict this);
 
+/**
+ * Refresh a partition state, so that it reflects the current CRTC:s of the
+ * graphics card. The graphics card is not reopened, only its mode resources
+ * are read again, and its connectors and encoders are released to be read
+ * again when they are needed.
+ * 
+ * @param   this  The partition state.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library.
+ */
+int libgamma_linux_drm_partition_refresh(libgamma_partition_state_t* restrict this);
+
 
 /**
  * Initialise an allocated CRTC state.
@@ -123,6 +174,19 @@ void libgamma_linux_drm_crtc_destroy(libgamma_crtc_state_t* restrict this) __att
  */
 int libgamma_linux_drm_crtc_restore(libgamma_crtc_state_t* restrict this);
 
+/**
+ * Get the handle for a CRTC. If the connector that the CRTC
+ * drives cannot be found, the handle's connector is zero.
+ * 
+ * @param   partition  The partition state for the partition that the CRTC belongs to.
+ * @param   crtc       The index of the CRTC within the partition.
+ * @param   handle     Output parameter for the CRTC's handle.
+ * @return             Zero on success, otherwise (negative) the value of an
+ *                     error identifier provided by this library.
+ */
+int libgamma_linux_drm_crtc_handle(libgamma_partition_state_t* restrict partition, size_t crtc,
+				   libgamma_crtc_handle_t* restrict handle);
+
 
 /**
  * Read information about a CRTC.
@@ -157,6 +221,59 @@ int libgamma_linux_drm_crtc_get_gamma_ramps16(libgamma_crtc_state_t* restrict th
 int libgamma_linux_drm_crtc_set_gamma_ramps16(libgamma_crtc_state_t* restrict this,
 					      libgamma_gamma_ramps16_t ramps);
 
+/**
+ * Get the current gamma ramps for multiple CRTC:s on the same site, 16-bit gamma-depth version.
+ * 
+ * The gamma ramps are read one CRTC after the other,
+ * without going through the library's facade for each CRTC.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to fill with the current values, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   errors  Output parameter for the return value of each CRTC, may be `NULL`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; this is the error of
+ *                  the first CRTC that failed.
+ */
+int libgamma_linux_drm_crtc_get_gamma_ramps16_many(libgamma_crtc_state_t* restrict const* restrict crtcs,
+						   libgamma_gamma_ramps16_t* restrict ramps,
+						   size_t count, int* restrict errors);
+
+/**
+ * Check whether gamma ramps can be applied to multiple CRTC:s in one
+ * atomic commit, that is, whether all CRTC:s are on the same graphics
+ * card and it supports atomic mode setting and `GAMMA_LUT`.
+ * 
+ * @param   crtcs  The CRTC states, all of them must belong to the same site.
+ * @param   count  The number of elements in `crtcs`, at least 1.
+ * @return         Non-zero if `libgamma_linux_drm_crtc_commit_gamma_ramps16`
+ *                 applies the gamma ramps in one atomic commit.
+ */
+int libgamma_linux_drm_crtc_can_commit_atomically16(libgamma_crtc_state_t* restrict const* restrict crtcs, size_t count);
+
+/**
+ * Apply gamma ramps to multiple CRTC:s as one transaction, 16-bit gamma-depth version.
+ * 
+ * If all CRTC:s are on the same graphics card and it supports atomic mode
+ * setting and `GAMMA_LUT`, the gamma ramps are applied in one atomic commit,
+ * so either all of them or none of them are applied. Otherwise, they are
+ * applied one CRTC at a time.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to apply, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   flags   The transaction's flags, a combination of `LIBGAMMA_TRANSACTION_*`.
+ * @param   errors  Output parameter for the return value of each CRTC, may be `NULL`.
+ *                  If the gamma ramps are applied in one atomic commit, the same
+ *                  value is stored for all CRTC:s.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; this is the error of
+ *                  the first CRTC that failed.
+ */
+int libgamma_linux_drm_crtc_commit_gamma_ramps16(libgamma_crtc_state_t* restrict const* restrict crtcs,
+						 const libgamma_gamma_ramps16_t* restrict ramps,
+						 size_t count, int flags, int* restrict errors);
+
 
 #endif
 
@@ -0,0 +1,94 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBGAMMA_GAMMA_OPS_H
+#define LIBGAMMA_GAMMA_OPS_H
+
+
+#include "gamma-helper.h"
+
+
+
+/**
+ * The dummy adjustment method's implementations.
+ */
+extern const libgamma_method_ops_t libgamma_dummy_ops;
+
+/**
+ * The size of `libgamma_method_ops_t` that the dummy adjustment method
+ * was compiled with, checked when it is loaded as a plugin.
+ */
+extern const size_t libgamma_dummy_ops_size;
+
+/**
+ * The X RandR adjustment method's implementations.
+ */
+extern const libgamma_method_ops_t libgamma_x_randr_ops;
+
+/**
+ * The size of `libgamma_method_ops_t` that the X RandR adjustment method
+ * was compiled with, checked when it is loaded as a plugin.
+ */
+extern const size_t libgamma_x_randr_ops_size;
+
+/**
+ * The X VidMode adjustment method's implementations.
+ */
+extern const libgamma_method_ops_t libgamma_x_vidmode_ops;
+
+/**
+ * The size of `libgamma_method_ops_t` that the X VidMode adjustment method
+ * was compiled with, checked when it is loaded as a plugin.
+ */
+extern const size_t libgamma_x_vidmode_ops_size;
+
+/**
+ * The Linux DRM adjustment method's implementations.
+ */
+extern const libgamma_method_ops_t libgamma_linux_drm_ops;
+
+/**
+ * The size of `libgamma_method_ops_t` that the Linux DRM adjustment method
+ * was compiled with, checked when it is loaded as a plugin.
+ */
+extern const size_t libgamma_linux_drm_ops_size;
+
+/**
+ * The Windows GDI adjustment method's implementations.
+ */
+extern const libgamma_method_ops_t libgamma_w32_gdi_ops;
+
+/**
+ * The size of `libgamma_method_ops_t` that the Windows GDI adjustment method
+ * was compiled with, checked when it is loaded as a plugin.
+ */
+extern const size_t libgamma_w32_gdi_ops_size;
+
+/**
+ * The Quartz/CoreGraphics adjustment method's implementations.
+ */
+extern const libgamma_method_ops_t libgamma_quartz_cg_ops;
+
+/**
+ * The size of `libgamma_method_ops_t` that the Quartz/CoreGraphics adjustment method
+ * was compiled with, checked when it is loaded as a plugin.
+ */
+extern const size_t libgamma_quartz_cg_ops_size;
+
+
+#endif
+
@@ -0,0 +1,163 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gamma-plugin.h"
+
+#include "gamma-pool.h"
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+#ifndef LIBGAMMA_PLUGIN_DIR
+/**
+ * The directory the plugins are installed to.
+ */
+# define LIBGAMMA_PLUGIN_DIR  "/usr/lib/libgamma"
+#endif
+
+#ifndef LIBGAMMA_PLUGIN_SUFFIX
+/**
+ * The suffix of the plugins' file names.
+ */
+# define LIBGAMMA_PLUGIN_SUFFIX  ".so"
+#endif
+
+
+
+/**
+ * The implementations of the adjustment methods whose
+ * plugins have been loaded, indexed by adjustment method.
+ */
+static const libgamma_method_ops_t* loaded[LIBGAMMA_METHOD_COUNT];
+
+/**
+ * Whether the plugin for an adjustment method could not
+ * be loaded, or was rejected, indexed by adjustment method,
+ * so that the filesystem is not searched again each time
+ * the adjustment method is looked up.
+ */
+static char failed[LIBGAMMA_METHOD_COUNT];
+
+
+
+/**
+ * Get the implementations of an adjustment method that is
+ * built as a plugin, loading the plugin the first time.
+ * 
+ * The plugin is looked up in the directory named by the
+ * environment variable `LIBGAMMA_PLUGIN_DIR`, unless the
+ * process is privileged, and otherwise in the directory it
+ * was installed to. Loaded plugins are never unloaded.
+ * 
+ * The plugin is rejected unless it exports `symbol` with the
+ * suffix `_size`, set to the size of `libgamma_method_ops_t`
+ * that it was built with, and the size matches the library's,
+ * otherwise the library could read past the end of the plugin's
+ * `libgamma_method_ops_t` if the plugin is older than the library.
+ * 
+ * If the plugin cannot be loaded, or is rejected, the library
+ * does not try to load it again until `libgamma_plugin_forget_failures`
+ * is called.
+ * 
+ * @param   method  The adjustment method.
+ * @param   name    The name of the plugin's file, without directory and suffix.
+ * @param   symbol  The name of the plugin's `libgamma_method_ops_t`.
+ * @return          The adjustment method's implementations, `NULL`
+ *                  if the plugin could not be loaded.
+ */
+const libgamma_method_ops_t* libgamma_plugin_ops(int method, const char* restrict name,
+						 const char* restrict symbol)
+{
+  const libgamma_method_ops_t* ops;
+  const libgamma_method_ops_t* expected = NULL;
+  const char* restrict dir = LIBGAMMA_PLUGIN_DIR;
+  const char* restrict env;
+  const size_t* restrict size;
+  char* restrict path;
+  void* handle;
+  size_t n;
+  
+  /* Use the plugin if it has already been loaded, and
+     do not search for it again if it could not be loaded. */
+  if ((ops = __atomic_load_n(loaded + method, __ATOMIC_ACQUIRE)) != NULL)
+    return ops;
+  if (__atomic_load_n(failed + method, __ATOMIC_RELAXED))
+    return NULL;
+  
+  /* Let the user select the directory, unless the process is privileged. */
+  env = getenv("LIBGAMMA_PLUGIN_DIR");
+  if ((env != NULL) && (*env != '\0') && (getuid() == geteuid()) && (getgid() == getegid()))
+    dir = env;
+  
+  /* Get the pathname of the plugin, the buffer is
+     reused for the name of the plugin's size word. */
+  n = strlen(dir) + strlen(name) + strlen(LIBGAMMA_PLUGIN_SUFFIX) + 2;
+  if (n < strlen(symbol) + sizeof("_size"))
+    n = strlen(symbol) + sizeof("_size");
+  if ((path = libgamma_allocate(n * sizeof(char))) == NULL)
+    return NULL;
+  sprintf(path, "%s/%s%s", dir, name, LIBGAMMA_PLUGIN_SUFFIX);
+  
+  /* Load the plugin and look up its implementations,
+     and reject it if it was built for another version
+     of `libgamma_method_ops_t`. */
+  if ((handle = dlopen(path, RTLD_NOW | RTLD_LOCAL)) == NULL)
+    goto fail;
+  sprintf(path, "%s_size", symbol);
+  size = dlsym(handle, path);
+  if ((size == NULL) || (*size != sizeof(libgamma_method_ops_t)))
+    goto fail_close;
+  if ((ops = dlsym(handle, symbol)) == NULL)
+    goto fail_close;
+  libgamma_deallocate(path);
+  
+  /* Publish the implementations. If another thread loaded the plugin
+     at the same time, both got the same handle, so we only drop our
+     reference to it and use what the other thread published. */
+  if (!__atomic_compare_exchange_n(loaded + method, &expected, ops, 0,
+				   __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+      dlclose(handle);
+      return expected;
+    }
+  return ops;
+  
+ fail_close:
+  dlclose(handle);
+ fail:
+  libgamma_deallocate(path);
+  __atomic_store_n(failed + method, 1, __ATOMIC_RELAXED);
+  return NULL;
+}
+
+
+/**
+ * Let the library try again to load the plugins that it
+ * could not load, the next time their adjustment methods
+ * are looked up.
+ */
+void libgamma_plugin_forget_failures(void)
+{
+  size_t i;
+  for (i = 0; i < LIBGAMMA_METHOD_COUNT; i++)
+    __atomic_store_n(failed + i, 0, __ATOMIC_RELAXED);
+}
+
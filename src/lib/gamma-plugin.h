@@ -0,0 +1,63 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBGAMMA_GAMMA_PLUGIN_H
+#define LIBGAMMA_GAMMA_PLUGIN_H
+
+
+#include "gamma-helper.h"
+
+
+
+/**
+ * Get the implementations of an adjustment method that is
+ * built as a plugin, loading the plugin the first time.
+ * 
+ * The plugin is looked up in the directory named by the
+ * environment variable `LIBGAMMA_PLUGIN_DIR`, unless the
+ * process is privileged, and otherwise in the directory it
+ * was installed to. Loaded plugins are never unloaded.
+ * 
+ * The plugin is rejected unless it exports `symbol` with the
+ * suffix `_size`, set to the size of `libgamma_method_ops_t`
+ * that it was built with, and the size matches the library's,
+ * otherwise the library could read past the end of the plugin's
+ * `libgamma_method_ops_t` if the plugin is older than the library.
+ * 
+ * If the plugin cannot be loaded, or is rejected, the library
+ * does not try to load it again until `libgamma_plugin_forget_failures`
+ * is called.
+ * 
+ * @param   method  The adjustment method.
+ * @param   name    The name of the plugin's file, without directory and suffix.
+ * @param   symbol  The name of the plugin's `libgamma_method_ops_t`.
+ * @return          The adjustment method's implementations, `NULL`
+ *                  if the plugin could not be loaded.
+ */
+const libgamma_method_ops_t* libgamma_plugin_ops(int method, const char* restrict name,
+						 const char* restrict symbol);
+
+/**
+ * Let the library try again to load the plugins that it
+ * could not load, the next time their adjustment methods
+ * are looked up.
+ */
+void libgamma_plugin_forget_failures(void);
+
+
+#endif
+
@@ -0,0 +1,521 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gamma-pool.h"
+
+#include "libgamma-facade.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * The header stored immediately before each allocation made
+ * with `libgamma_allocate`, its size is a multiple of the
+ * alignment `malloc` guarantees.
+ */
+typedef union allocation
+{
+  /**
+   * The size of the allocation, excluding the header.
+   */
+  size_t size;
+  
+  /**
+   * Members that give the header the alignment of `malloc`.
+   */
+  long double align_ld;
+  void* align_ptr;
+  
+} allocation_t;
+
+
+/**
+ * The default allocation function.
+ * 
+ * @param   size       The number of bytes to allocate.
+ * @param   user_data  Not used.
+ * @return             The allocation, `NULL` on error.
+ */
+static void* default_allocate(size_t size, void* user_data)
+{
+  (void) user_data;
+  return malloc(size);
+}
+
+
+/**
+ * The default reallocation function.
+ * 
+ * @param   ptr        The allocation to resize.
+ * @param   size       The new size of the allocation.
+ * @param   user_data  Not used.
+ * @return             The allocation, `NULL` on error.
+ */
+static void* default_reallocate(void* ptr, size_t size, void* user_data)
+{
+  (void) user_data;
+  return realloc(ptr, size);
+}
+
+
+/**
+ * The default deallocation function.
+ * 
+ * @param  ptr        The allocation to release.
+ * @param  user_data  Not used.
+ */
+static void default_deallocate(void* ptr, void* user_data)
+{
+  (void) user_data;
+  free(ptr);
+}
+
+
+/**
+ * The allocator used by the library. It is only changed by
+ * `libgamma_set_allocator`, which is not thread-safe, so
+ * it is read without synchronisation.
+ */
+static libgamma_allocator_t allocator =
+  {
+    .allocate   = default_allocate,
+    .reallocate = default_reallocate,
+    .deallocate = default_deallocate,
+    .user_data  = NULL
+  };
+
+/**
+ * The number of bytes the library currently has allocated.
+ */
+static size_t allocated_bytes = 0;
+
+
+
+/**
+ * Update the number of allocated bytes.
+ * 
+ * @param  increase  The number of bytes that have been allocated.
+ * @param  decrease  The number of bytes that have been released.
+ */
+static void account(size_t increase, size_t decrease)
+{
+  if (increase)  __atomic_add_fetch(&allocated_bytes, increase, __ATOMIC_RELAXED);
+  if (decrease)  __atomic_sub_fetch(&allocated_bytes, decrease, __ATOMIC_RELAXED);
+}
+
+
+/**
+ * Allocate memory with the library's allocator,
+ * the allocation is counted as allocated by the library.
+ * 
+ * @param   size  The number of bytes to allocate.
+ * @return        The allocation, `NULL` on error, `errno` will be set accordingly.
+ */
+void* libgamma_allocate(size_t size)
+{
+  allocation_t* header;
+  if (size > SIZE_MAX - sizeof(allocation_t))
+    return errno = ENOMEM, NULL;
+  if ((header = allocator.allocate(size + sizeof(allocation_t), allocator.user_data)) == NULL)
+    return errno = ENOMEM, NULL;
+  header->size = size;
+  account(size, 0);
+  return header + 1;
+}
+
+
+/**
+ * Allocate zero-initialised memory with the library's allocator,
+ * the allocation is counted as allocated by the library.
+ * 
+ * @param   count  The number of elements to allocate.
+ * @param   size   The size of each element.
+ * @return         The allocation, `NULL` on error, `errno` will be set accordingly.
+ */
+void* libgamma_callocate(size_t count, size_t size)
+{
+  void* ptr;
+  if (size && (count > SIZE_MAX / size))
+    return errno = ENOMEM, NULL;
+  if ((ptr = libgamma_allocate(count * size)) != NULL)
+    memset(ptr, 0, count * size);
+  return ptr;
+}
+
+
+/**
+ * Resize memory allocated with `libgamma_allocate`.
+ * 
+ * @param   ptr   The allocation, may be `NULL`.
+ * @param   size  The new size of the allocation.
+ * @return        The allocation, `NULL` on error, `errno` will be set
+ *                accordingly, `ptr` is not released on error.
+ */
+void* libgamma_reallocate(void* ptr, size_t size)
+{
+  allocation_t* header;
+  size_t old_size;
+  if (ptr == NULL)
+    return libgamma_allocate(size);
+  if (size > SIZE_MAX - sizeof(allocation_t))
+    return errno = ENOMEM, NULL;
+  header = (allocation_t*)ptr - 1;
+  old_size = header->size;
+  header = allocator.reallocate(header, size + sizeof(allocation_t), allocator.user_data);
+  if (header == NULL)
+    return errno = ENOMEM, NULL;
+  header->size = size;
+  account(size, old_size);
+  return header + 1;
+}
+
+
+/**
+ * Release memory allocated with `libgamma_allocate`.
+ * 
+ * @param  ptr  The allocation, may be `NULL`.
+ */
+void libgamma_deallocate(void* ptr)
+{
+  allocation_t* header;
+  if (ptr == NULL)
+    return;
+  header = (allocation_t*)ptr - 1;
+  account(0, header->size);
+  allocator.deallocate(header, allocator.user_data);
+}
+
+
+/**
+ * Allocate memory, that is handed over to the user, with the
+ * library's allocator, the allocation is not counted as
+ * allocated by the library and has no header, so that the
+ * user can release it with the allocator's deallocation
+ * function, `free` for the default allocator.
+ * 
+ * @param   size  The number of bytes to allocate.
+ * @return        The allocation, `NULL` on error, `errno` will be set accordingly.
+ */
+void* libgamma_allocate_exported(size_t size)
+{
+  void* ptr = allocator.allocate(size, allocator.user_data);
+  if (ptr == NULL)
+    errno = ENOMEM;
+  return ptr;
+}
+
+
+/**
+ * Release memory allocated with `libgamma_allocate_exported`.
+ * 
+ * @param  ptr  The allocation, may be `NULL`.
+ */
+void libgamma_deallocate_exported(void* ptr)
+{
+  if (ptr != NULL)
+    allocator.deallocate(ptr, allocator.user_data);
+}
+
+
+/**
+ * Get the deallocation function, and its `user_data`, that memory
+ * allocated with `libgamma_allocate_exported` must be released with,
+ * so that it can be stored with the memory.
+ * 
+ * @param  deallocate  Output parameter for the deallocation function.
+ * @param  user_data   Output parameter for the `user_data` argument of `*deallocate`.
+ */
+void libgamma_get_exported_deallocator(void (**deallocate)(void* ptr, void* user_data), void** user_data)
+{
+  *deallocate = allocator.deallocate;
+  *user_data = allocator.user_data;
+}
+
+
+
+/**
+ * The capacity, in bytes, of the smallest size class,
+ * three channels with 256 8-bit stops each. Each size
+ * class is twice as large as the previous one.
+ */
+#define POOL_SMALLEST  (3 * 256)
+
+/**
+ * The number of size classes, the largest size class
+ * fits three channels with 4096 64-bit stops each.
+ */
+#define POOL_CLASSES  8
+
+/**
+ * The maximum number of released buffers that are kept
+ * in a size class, additional buffers are deallocated.
+ */
+#define POOL_DEPTH  8
+
+
+/**
+ * A pool of released buffers in one size class.
+ */
+typedef struct pool
+{
+  /**
+   * The most recently released buffer, each buffer
+   * starts with a pointer to the next buffer.
+   */
+  void* head;
+  
+  /**
+   * The number of buffers in the pool.
+   */
+  size_t count;
+  
+  /**
+   * Spin lock for the pool.
+   */
+  char lock;
+  
+} pool_t;
+
+
+/**
+ * The pools of released buffers, one per size class.
+ */
+static pool_t pools[POOL_CLASSES];
+
+
+
+/**
+ * Get the size class for a buffer.
+ * 
+ * @param   size  The size of the buffer, in bytes.
+ * @return        The size class, `POOL_CLASSES` if the buffer is not pooled.
+ */
+static inline size_t __attribute__((const)) size_class(size_t size)
+{
+  size_t class = 0, capacity = POOL_SMALLEST;
+  while ((class < POOL_CLASSES) && (capacity < size))
+    class++, capacity <<= 1;
+  return class;
+}
+
+
+/**
+ * The header stored immediately before each buffer.
+ */
+typedef struct header
+{
+  /**
+   * The pointer returned by `libgamma_allocate`.
+   */
+  void* raw;
+  
+  /**
+   * The size class of the buffer, `POOL_CLASSES`
+   * if the buffer is not pooled.
+   */
+  size_t class;
+  
+} header_t;
+
+
+/**
+ * Allocate an aligned buffer.
+ * 
+ * @param   size   The size of the buffer, in bytes.
+ * @param   class  The size class of the buffer.
+ * @return         The buffer, `NULL` on error, `errno` will be set accordingly.
+ */
+static void* allocate_aligned(size_t size, size_t class)
+{
+  char* raw = libgamma_allocate(size + sizeof(header_t) + LIBGAMMA_POOL_ALIGNMENT - 1);
+  uintptr_t address;
+  header_t* header;
+  if (raw == NULL)
+    return NULL;
+  address = (uintptr_t)(raw + sizeof(header_t));
+  address = (address + LIBGAMMA_POOL_ALIGNMENT - 1) & ~(uintptr_t)(LIBGAMMA_POOL_ALIGNMENT - 1);
+  header = (header_t*)address - 1;
+  header->raw = raw;
+  header->class = class;
+  return (void*)address;
+}
+
+
+
+/**
+ * Allocate a buffer for gamma ramp stops.
+ * 
+ * The buffer is aligned to `LIBGAMMA_POOL_ALIGNMENT` bytes. Buffers
+ * for the common gamma ramp sizes, up to three channels of 4096
+ * 64-bit stops, are taken from a pool of recently released buffers
+ * of the same size class if one is available.
+ * 
+ * @param   size  The size of the buffer, in bytes.
+ * @return        The buffer, `NULL` on error, `errno` will be set accordingly.
+ */
+void* libgamma_pool_allocate(size_t size)
+{
+  size_t class = size_class(size);
+  pool_t* pool;
+  void* buffer;
+  
+  if (class == POOL_CLASSES)
+    return allocate_aligned(size, class);
+  
+  /* Take the most recently released buffer, if any. */
+  pool = pools + class;
+  while (__atomic_test_and_set(&(pool->lock), __ATOMIC_ACQUIRE));
+  if ((buffer = pool->head) != NULL)
+    pool->head = *(void**)buffer, pool->count--;
+  __atomic_clear(&(pool->lock), __ATOMIC_RELEASE);
+  if (buffer != NULL)
+    return buffer;
+  
+  /* Allocate the full capacity of the size class so that
+     the buffer can be reused for any size in the class. */
+  return allocate_aligned((size_t)POOL_SMALLEST << class, class);
+}
+
+
+/**
+ * Release a buffer allocated by `libgamma_pool_allocate`.
+ * 
+ * @param  buffer  The buffer, may be `NULL`.
+ */
+void libgamma_pool_release(void* buffer)
+{
+  header_t* header;
+  pool_t* pool;
+  
+  if (buffer == NULL)
+    return;
+  header = (header_t*)buffer - 1;
+  
+  /* Keep the buffer unless the pool is full. */
+  if (header->class < POOL_CLASSES)
+    {
+      pool = pools + header->class;
+      while (__atomic_test_and_set(&(pool->lock), __ATOMIC_ACQUIRE));
+      if (pool->count < POOL_DEPTH)
+	{
+	  *(void**)buffer = pool->head;
+	  pool->head = buffer, pool->count++;
+	  buffer = NULL;
+	}
+      __atomic_clear(&(pool->lock), __ATOMIC_RELEASE);
+      if (buffer == NULL)
+	return;
+    }
+  
+  libgamma_deallocate(header->raw);
+}
+
+
+/**
+ * Release all buffers that are kept in the pools.
+ */
+static void pool_trim(void)
+{
+  size_t class;
+  pool_t* pool;
+  void* buffer;
+  void* next;
+  
+  for (class = 0; class < POOL_CLASSES; class++)
+    {
+      pool = pools + class;
+      while (__atomic_test_and_set(&(pool->lock), __ATOMIC_ACQUIRE));
+      buffer = pool->head;
+      pool->head = NULL, pool->count = 0;
+      __atomic_clear(&(pool->lock), __ATOMIC_RELEASE);
+      for (; buffer != NULL; buffer = next)
+	{
+	  next = *(void**)buffer;
+	  libgamma_deallocate(((header_t*)buffer - 1)->raw);
+	}
+    }
+}
+
+
+
+/**
+ * Select the allocator the library uses for all memory it allocates,
+ * except memory allocated by the display server's client libraries.
+ * 
+ * The allocator can only be changed when the library has no
+ * allocated memory, that is, before any state has been initialised
+ * or after all states have been destroyed. Buffers that are kept
+ * for reuse are released first.
+ * 
+ * Memory that is handed over to the user, for example EDID:s and
+ * connector names, is allocated with the allocator's allocation
+ * function, and must be released with its deallocation function.
+ * It is not counted, so the allocator can be changed while the user
+ * holds such memory. `libgamma_crtc_information_destroy` uses the
+ * deallocation function that is recorded in the CRTC information.
+ * 
+ * This function is not thread-safe, no other thread may use the
+ * library while it is called.
+ * 
+ * @param   new_allocator  The allocator, `NULL` to restore the
+ *                         default allocator, which uses `malloc`,
+ *                         `realloc` and `free`.
+ * @return                 Zero on success, -1 on error, `errno`
+ *                         will be set accordingly: `EINVAL` if a
+ *                         function is missing in `new_allocator`,
+ *                         `EBUSY` if the library has allocated memory.
+ */
+int libgamma_set_allocator(const libgamma_allocator_t* restrict new_allocator)
+{
+  if ((new_allocator != NULL) &&
+      ((new_allocator->allocate == NULL) || (new_allocator->reallocate == NULL) ||
+       (new_allocator->deallocate == NULL)))
+    return errno = EINVAL, -1;
+  
+  pool_trim();
+  if (libgamma_allocated_bytes() != 0)
+    return errno = EBUSY, -1;
+  
+  if (new_allocator == NULL)
+    {
+      allocator.allocate   = default_allocate;
+      allocator.reallocate = default_reallocate;
+      allocator.deallocate = default_deallocate;
+      allocator.user_data  = NULL;
+    }
+  else
+    allocator = *new_allocator;
+  return 0;
+}
+
+
+/**
+ * Get the number of bytes the library currently has allocated,
+ * this includes buffers that are kept for reuse, but not memory
+ * that has been handed over to the user or memory allocated by
+ * the display server's client libraries.
+ * 
+ * @return  The number of allocated bytes.
+ */
+size_t libgamma_allocated_bytes(void)
+{
+  return __atomic_load_n(&allocated_bytes, __ATOMIC_RELAXED);
+}
+
@@ -0,0 +1,144 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBGAMMA_GAMMA_POOL_H
+#define LIBGAMMA_GAMMA_POOL_H
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#ifndef __GCC__
+# define __attribute__(x)
+#endif
+
+
+/**
+ * Allocate memory with the library's allocator,
+ * the allocation is counted as allocated by the library.
+ * 
+ * @param   size  The number of bytes to allocate.
+ * @return        The allocation, `NULL` on error, `errno` will be set accordingly.
+ */
+void* libgamma_allocate(size_t size) __attribute__((malloc));
+
+/**
+ * Allocate zero-initialised memory with the library's allocator,
+ * the allocation is counted as allocated by the library.
+ * 
+ * @param   count  The number of elements to allocate.
+ * @param   size   The size of each element.
+ * @return         The allocation, `NULL` on error, `errno` will be set accordingly.
+ */
+void* libgamma_callocate(size_t count, size_t size) __attribute__((malloc));
+
+/**
+ * Resize memory allocated with `libgamma_allocate`.
+ * 
+ * @param   ptr   The allocation, may be `NULL`.
+ * @param   size  The new size of the allocation.
+ * @return        The allocation, `NULL` on error, `errno` will be set
+ *                accordingly, `ptr` is not released on error.
+ */
+void* libgamma_reallocate(void* ptr, size_t size);
+
+/**
+ * Release memory allocated with `libgamma_allocate`.
+ * 
+ * @param  ptr  The allocation, may be `NULL`.
+ */
+void libgamma_deallocate(void* ptr);
+
+/**
+ * Allocate memory, that is handed over to the user, with the
+ * library's allocator, the allocation is not counted as
+ * allocated by the library and has no header, so that the
+ * user can release it with the allocator's deallocation
+ * function, `free` for the default allocator.
+ * 
+ * @param   size  The number of bytes to allocate.
+ * @return        The allocation, `NULL` on error, `errno` will be set accordingly.
+ */
+void* libgamma_allocate_exported(size_t size) __attribute__((malloc));
+
+/**
+ * Release memory allocated with `libgamma_allocate_exported`.
+ * 
+ * @param  ptr  The allocation, may be `NULL`.
+ */
+void libgamma_deallocate_exported(void* ptr);
+
+/**
+ * Get the deallocation function, and its `user_data`, that memory
+ * allocated with `libgamma_allocate_exported` must be released with,
+ * so that it can be stored with the memory.
+ * 
+ * @param  deallocate  Output parameter for the deallocation function.
+ * @param  user_data   Output parameter for the `user_data` argument of `*deallocate`.
+ */
+void libgamma_get_exported_deallocator(void (**deallocate)(void* ptr, void* user_data), void** user_data);
+
+
+
+/**
+ * The alignment, in bytes, of all buffers allocated by
+ * `libgamma_pool_allocate`, this is the size of a cache line.
+ */
+#define LIBGAMMA_POOL_ALIGNMENT  64
+
+/**
+ * The value `libgamma_gamma_ramps*_initialise` store in the
+ * `pool_tag` member of gamma ramps whose stops are taken from
+ * the pool. It depends on the address of the stops, so that
+ * stops the user has allocated and replaced the pooled stops
+ * with, or gamma ramps whose `pool_tag` was never set, are
+ * not mistaken for buffers from the pool.
+ * 
+ * @param   buffer  The stops, `red` of the gamma ramps.
+ * @return          The tag.
+ */
+#define LIBGAMMA_POOL_TAG(buffer)  ((uintptr_t)(void*)(buffer) ^ (uintptr_t)0x6C67706CUL)
+
+
+/**
+ * Allocate a buffer for gamma ramp stops.
+ * 
+ * The buffer is aligned to `LIBGAMMA_POOL_ALIGNMENT` bytes. Buffers
+ * for the common gamma ramp sizes, up to three channels of 4096
+ * 64-bit stops, are taken from a pool of recently released buffers
+ * of the same size class if one is available.
+ * 
+ * @param   size  The size of the buffer, in bytes.
+ * @return        The buffer, `NULL` on error, `errno` will be set accordingly.
+ */
+void* libgamma_pool_allocate(size_t size) __attribute__((malloc));
+
+/**
+ * Release a buffer allocated by `libgamma_pool_allocate`.
+ * 
+ * @param  buffer  The buffer, may be `NULL`.
+ */
+void libgamma_pool_release(void* buffer);
+
+
+#ifndef __GCC__
+# undef __attribute__
+#endif
+
+#endif
+
@@ -22,6 +22,7 @@
 #include "gamma-quartz-cg.h"
 
 #include "libgamma-error.h"
+#include "gamma-pool.h"
 
 #ifdef FAKE_LIBGAMMA_METHOD_QUARTZ_CORE_GRAPHICS
 # include "fake-quartz-cg.h"
@@ -79,6 +80,8 @@ void libgamma_quartz_cg_method_capabilities(libgamma_method_capabilities_t* rest
 #endif
   /* Gamma ramp adjustments are non-persistent. */
   this->auto_restore = 1;
+  /* Gamma ramps are applied one CRTC at a time. */
+  this->atomic_transactions = 0;
 }
 
 
@@ -155,7 +158,7 @@ int libgamma_quartz_cg_partition_initialise(libgamma_partition_state_t* restrict
     return LIBGAMMA_NO_SUCH_PARTITION;
   
   /* Allocate array of CRTC ID:s. */
-  if ((crtcs = malloc((size_t)cap * sizeof(CGDirectDisplayID))) == NULL)
+  if ((crtcs = libgamma_allocate((size_t)cap * sizeof(CGDirectDisplayID))) == NULL)
     return LIBGAMMA_ERRNO_SET;
   
   /* It is not possible to ask CoreGraphics how many CRTC:s
@@ -166,16 +169,16 @@ int libgamma_quartz_cg_partition_initialise(libgamma_partition_state_t* restrict
     {
       /* Ask for CRTC ID:s */
       if (CGGetOnlineDisplayList(cap, crtcs, &n) != kCGErrorSuccess)
-	return free(crtcs), LIBGAMMA_LIST_CRTCS_FAILED;
+	return libgamma_deallocate(crtcs), LIBGAMMA_LIST_CRTCS_FAILED;
       /* If we did not get as many as we asked for then we have all. */
       if (n < cap)
 	break;
       /* Increase the number CRTC ID:s to ask for. */
       if ((cap <<= 1) == 0) /* We could also test ~0, but it is still too many. */
-	return free(crtcs), LIBGAMMA_IMPOSSIBLE_AMOUNT;
+	return libgamma_deallocate(crtcs), LIBGAMMA_IMPOSSIBLE_AMOUNT;
       /* Grow the array of CRTC ID:s so that it can fit all we are asking for. */
-      if ((crtcs = realloc(crtcs_old = crtcs, (size_t)cap * sizeof(CGDirectDisplayID))) == NULL)
-	return free(crtcs_old), LIBGAMMA_ERRNO_SET;
+      if ((crtcs = libgamma_reallocate(crtcs_old = crtcs, (size_t)cap * sizeof(CGDirectDisplayID))) == NULL)
+	return libgamma_deallocate(crtcs_old), LIBGAMMA_ERRNO_SET;
     }
   
   /* Store CRTC ID:s and CRTC count. */
@@ -192,7 +195,7 @@ int libgamma_quartz_cg_partition_initialise(libgamma_partition_state_t* restrict
  */
 void libgamma_quartz_cg_partition_destroy(libgamma_partition_state_t* restrict this)
 {
-  free(this->data);
+  libgamma_deallocate(this->data);
 }
 
 
@@ -0,0 +1,850 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gamma-simd.h"
+
+#include <stdint.h>
+
+
+#if defined(__GNUC__) && defined(__x86_64__)
+# define HAVE_SIMD_X86
+#endif
+
+
+#ifdef HAVE_SIMD_X86
+# include <immintrin.h>
+
+
+/**
+ * Instruction set selection for a function.
+ */
+#define SSE2    __attribute__((target("sse2")))
+#define AVX2    __attribute__((target("avx2")))
+#define AVX512  __attribute__((target("avx512f")))
+#define F16C    __attribute__((target("avx,f16c")))
+
+
+/**
+ * 2 to the power of 31, the offset used to pass unsigned
+ * 32-bit integers through signed 32-bit integers.
+ */
+#define OFFSET_31  ((double)0x1p31f)
+
+/**
+ * 0x0001000100010001 as a `double`, multiplying a 16-bit
+ * value by this replicates it into a 64-bit value.
+ */
+#define REPLICATOR_16  ((double)0x0001000100010001ULL)
+
+/**
+ * 0x0000000100010001 as a `double`, the replicator for
+ * 16-bit values without the most significant word.
+ */
+#define TAIL_16  ((double)0x0000000100010001ULL)
+
+/**
+ * 0x0000000100000001 as a `double`, multiplying a 32-bit
+ * value by this replicates it into a 64-bit value.
+ */
+#define REPLICATOR_32  ((double)0x0000000100000001ULL)
+
+/**
+ * The number of stops that are converted at a time, through
+ * `float`, when converting from or to half precision floats.
+ */
+#define HALF_BLOCK  256
+
+
+/**
+ * The instruction sets we have kernels for.
+ */
+enum simd_level
+  {
+    SIMD_NONE = 0,
+    SIMD_SSE2,
+    SIMD_AVX2,
+    SIMD_AVX512
+  };
+
+/**
+ * The widest supported instruction set we have kernels for.
+ */
+static enum simd_level simd_level = SIMD_NONE;
+
+/**
+ * Whether the CPU supports F16C, for conversion
+ * between half and single precision floats.
+ */
+static int simd_f16c = 0;
+
+
+/**
+ * Select the kernels to use, once when the library is loaded.
+ */
+__attribute__((constructor))
+static void simd_detect(void)
+{
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    simd_level = SIMD_AVX512;
+  else if (__builtin_cpu_supports("avx2"))
+    simd_level = SIMD_AVX2;
+  else if (__builtin_cpu_supports("sse2"))
+    simd_level = SIMD_SSE2;
+  simd_f16c = __builtin_cpu_supports("f16c") && __builtin_cpu_supports("avx");
+}
+
+
+
+/* How the kernels get the same result as the scalar conversion:
+   
+   A value `v` in [0, 1) is converted to the `b`-bit integer
+   ⌊⌊v 2⁶⁴⌋ / R⌋, where R is a 64-bit word with 1 in the lowest
+   bit of every `b`-bit word, and ⌊⌊v 2⁶⁴⌋ / R⌋ = ⌊v 2⁶⁴ / R⌋.
+   This is either h = ⌊v 2ᵇ⌋ or h − 1: it is h exactly when
+   v 2⁶⁴ ≥ hR, that is, when (v 2ᵇ − h) 2⁶⁴⁻ᵇ ≥ h(R − 2⁶⁴⁻ᵇ).
+   For `b` = 32 and 16 every term is exactly representable in a
+   `double`, so the test is exact. For `b` = 8 the right-hand side
+   does not fit in a `double`, instead the second 8-bit word of
+   ⌊v 2¹⁶⌋ is compared to h, and only if they are equal is the
+   test for `b` = 16 used, which is then equivalent.
+   
+   The other way around, an integer `x` is converted to a `double`
+   by rounding xR to 53 bits and multiplying by 2⁻⁶⁴. For 8-bit
+   and 16-bit integers, xR is rounded once when multiplied as
+   `double`:s. The replicated bit pattern can never be rounded to
+   a halfway point for `float`, so rounding first to a `double`
+   and then to a `float` gives the same result as rounding xR to
+   a `float` directly. This is not true for 32-bit integers, so
+   conversion from 32-bit integers to `float` has no kernel. */
+
+
+
+/**
+ * Round non-negative values, no greater than 2 to the
+ * power of 32, down to the nearest integer.
+ * 
+ * @param   x  The values.
+ * @return     The values rounded down. Undefined for exactly 2³².
+ */
+SSE2 static inline __attribute__((always_inline)) __m128d sse2_floor(__m128d x)
+{
+  /* Truncation is flooring for non-negative values, but values
+     that do not fit in signed 32-bit integers must be offset. */
+  __m128d offset = _mm_and_pd(_mm_cmpge_pd(x, _mm_set1_pd(OFFSET_31)), _mm_set1_pd(OFFSET_31));
+  return _mm_add_pd(_mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_sub_pd(x, offset))), offset);
+}
+
+
+/**
+ * Calculate the most significant `log2(scale)`-bit word of
+ * ⌊v 2⁶⁴ / R⌋, before it is adjusted for the lower words.
+ * 
+ * @param   v      The values, in [0, 1].
+ * @param   scale  2 to the power of the number of bits in the word.
+ * @param   tail   R minus 2 to the power of 64 − `log2(scale)`.
+ * @param   h      Output parameter for the word.
+ * @return         All ones where the word is correct, all zeroes
+ *                 where the word needs to be decremented.
+ */
+SSE2 static inline __attribute__((always_inline)) __m128d sse2_word(__m128d v, double scale, double tail, __m128d* restrict h)
+{
+  __m128d s = _mm_mul_pd(v, _mm_set1_pd(scale));
+  *h = sse2_floor(s);
+  return _mm_cmpge_pd(_mm_mul_pd(_mm_sub_pd(s, *h), _mm_set1_pd((double)0x1p64f / scale)),
+		      _mm_mul_pd(*h, _mm_set1_pd(tail)));
+}
+
+
+/**
+ * Convert [0, 1] values to `bits`-bit integers.
+ * 
+ * @param   v     The values.
+ * @param   bits  The number of bits in the output, 8, 16 or 32.
+ * @return        The integers, as unsigned 32-bit integers in the low half.
+ */
+SSE2 static inline __attribute__((always_inline)) __m128i sse2_to_integer(__m128d v, int bits)
+{
+  const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd((double)1.0f);
+  const __m128d max = _mm_set1_pd((double)(bits == 32 ? UINT32_MAX : bits == 16 ? UINT16_MAX : UINT8_MAX));
+  __m128d top = _mm_cmpge_pd(v, one);
+  __m128d h, h16, c, c16, d;
+  
+  /* NaN becomes zero, as `_mm_max_pd` returns its second operand. */
+  v = _mm_min_pd(_mm_max_pd(v, zero), one);
+  
+  if (bits == 32)
+    c = sse2_word(v, (double)0x1p32f, (double)1.0f, &h);
+  else
+    {
+      c = c16 = sse2_word(v, (double)0x1p16f, TAIL_16, &h16);
+      h = h16;
+      if (bits == 8)
+	{
+	  h = sse2_floor(_mm_mul_pd(v, _mm_set1_pd((double)0x1p8f)));
+	  d = _mm_sub_pd(h16, _mm_mul_pd(h, _mm_set1_pd((double)0x1p8f)));
+	  c = _mm_or_pd(_mm_cmpgt_pd(d, h), _mm_and_pd(_mm_cmpeq_pd(d, h), c16));
+	}
+    }
+  
+  h = _mm_sub_pd(h, _mm_andnot_pd(c, one));
+  h = _mm_or_pd(_mm_and_pd(top, max), _mm_andnot_pd(top, h));
+  return _mm_xor_si128(_mm_cvttpd_epi32(_mm_sub_pd(h, _mm_set1_pd(OFFSET_31))),
+		       _mm_set1_epi32(INT32_MIN));
+}
+
+
+/**
+ * Convert unsigned 32-bit integers to `double`:s.
+ * 
+ * @param  x   The integers.
+ * @param  lo  Output parameter for the two first integers.
+ * @param  hi  Output parameter for the two last integers.
+ */
+SSE2 static inline __attribute__((always_inline)) void sse2_from_integer(__m128i x, __m128d* restrict lo, __m128d* restrict hi)
+{
+  const __m128d offset = _mm_set1_pd(OFFSET_31);
+  x = _mm_xor_si128(x, _mm_set1_epi32(INT32_MIN));
+  *lo = _mm_add_pd(_mm_cvtepi32_pd(x), offset);
+  *hi = _mm_add_pd(_mm_cvtepi32_pd(_mm_srli_si128(x, 8)), offset);
+}
+
+
+/**
+ * Convert `float`:s or `double`:s to integers, SSE2 version.
+ * 
+ * @param   bits  The number of bits in the output, 8, 16 or 32.
+ * @param   out   Output array.
+ * @param   fin   Input array if the input is `float`:s, otherwise `NULL`.
+ * @param   din   Input array if the input is `double`:s, otherwise `NULL`.
+ * @param   n     The number of stops in the input.
+ * @return        The number of stops that have been converted.
+ */
+SSE2 static size_t sse2_to_integers(int bits, void* restrict out, const float* restrict fin,
+				    const double* restrict din, size_t n)
+{
+  __m128d v[4];
+  __m128i a, b;
+  __m128 x;
+  size_t i, j;
+  
+  for (i = 0; i + 8 <= n; i += 8)
+    {
+      /* Load eight stops as `double`:s. */
+      if (fin != NULL)
+	for (j = 0; j < 4; j += 2)
+	  {
+	    x = _mm_loadu_ps(fin + i + 2 * j);
+	    v[j + 0] = _mm_cvtps_pd(x);
+	    v[j + 1] = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+	  }
+      else
+	for (j = 0; j < 4; j++)
+	  v[j] = _mm_loadu_pd(din + i + 2 * j);
+      
+      /* Convert them to unsigned 32-bit integers. */
+      a = _mm_unpacklo_epi64(sse2_to_integer(v[0], bits), sse2_to_integer(v[1], bits));
+      b = _mm_unpacklo_epi64(sse2_to_integer(v[2], bits), sse2_to_integer(v[3], bits));
+      
+      /* Narrow and store them. SSE2 only has signed saturation from 32-bit
+	 integers, so 16-bit values are offset to fit in signed 16-bit integers. */
+      if (bits == 32)
+	{
+	  _mm_storeu_si128((__m128i*)((uint32_t*)out + i) + 0, a);
+	  _mm_storeu_si128((__m128i*)((uint32_t*)out + i) + 1, b);
+	}
+      else if (bits == 16)
+	{
+	  a = _mm_sub_epi32(a, _mm_set1_epi32(0x8000));
+	  b = _mm_sub_epi32(b, _mm_set1_epi32(0x8000));
+	  a = _mm_xor_si128(_mm_packs_epi32(a, b), _mm_set1_epi16(INT16_MIN));
+	  _mm_storeu_si128((__m128i*)((uint16_t*)out + i), a);
+	}
+      else
+	{
+	  a = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_setzero_si128());
+	  _mm_storel_epi64((__m128i*)((uint8_t*)out + i), a);
+	}
+    }
+  
+  return i;
+}
+
+
+/**
+ * Convert integers to `float`:s or `double`:s, SSE2 version.
+ * 
+ * @param   bits  The number of bits in the input, 8, 16 or 32.
+ * @param   fout  Output array if the output is `float`:s, otherwise `NULL`.
+ * @param   dout  Output array if the output is `double`:s, otherwise `NULL`.
+ * @param   in    Input array.
+ * @param   n     The number of stops in the input.
+ * @return        The number of stops that have been converted.
+ */
+SSE2 static size_t sse2_from_integers(int bits, float* restrict fout, double* restrict dout,
+				      const void* restrict in, size_t n)
+{
+  const __m128d replicator = _mm_set1_pd(bits == 32 ? REPLICATOR_32 : REPLICATOR_16);
+  const __m128i zero = _mm_setzero_si128();
+  __m128d v[4];
+  __m128i a, b;
+  size_t i, j;
+  
+  for (i = 0; i + 8 <= n; i += 8)
+    {
+      /* Load eight stops as unsigned 32-bit integers. */
+      if (bits == 32)
+	{
+	  a = _mm_loadu_si128((const __m128i*)((const uint32_t*)in + i) + 0);
+	  b = _mm_loadu_si128((const __m128i*)((const uint32_t*)in + i) + 1);
+	}
+      else
+	{
+	  if (bits == 16)
+	    a = _mm_loadu_si128((const __m128i*)((const uint16_t*)in + i));
+	  else
+	    {
+	      /* 8-bit values are replicated to 16-bit values. */
+	      a = _mm_loadl_epi64((const __m128i*)((const uint8_t*)in + i));
+	      a = _mm_unpacklo_epi8(a, a);
+	    }
+	  b = _mm_unpackhi_epi16(a, zero);
+	  a = _mm_unpacklo_epi16(a, zero);
+	}
+      
+      /* Replicate them to 64 bits, with rounding, as `double`:s. */
+      sse2_from_integer(a, v + 0, v + 1);
+      sse2_from_integer(b, v + 2, v + 3);
+      for (j = 0; j < 4; j++)
+	v[j] = _mm_mul_pd(v[j], replicator);
+      
+      /* Scale them to [0, 1] and store them. */
+      if (dout != NULL)
+	for (j = 0; j < 4; j++)
+	  _mm_storeu_pd(dout + i + 2 * j, _mm_mul_pd(v[j], _mm_set1_pd((double)0x1p-64f)));
+      else
+	for (j = 0; j < 4; j += 2)
+	  _mm_storeu_ps(fout + i + 2 * j,
+			_mm_mul_ps(_mm_movelh_ps(_mm_cvtpd_ps(v[j]), _mm_cvtpd_ps(v[j + 1])),
+				   _mm_set1_ps(0x1p-64f)));
+    }
+  
+  return i;
+}
+
+
+
+/**
+ * Convert [0, 1] values to `bits`-bit integers.
+ * 
+ * @param   v     The values.
+ * @param   bits  The number of bits in the output, 8, 16 or 32.
+ * @return        The integers, as unsigned 32-bit integers.
+ */
+AVX2 static inline __attribute__((always_inline)) __m128i avx2_to_integer(__m256d v, int bits)
+{
+  const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd((double)1.0f);
+  const __m256d max = _mm256_set1_pd((double)(bits == 32 ? UINT32_MAX : bits == 16 ? UINT16_MAX : UINT8_MAX));
+  __m256d top = _mm256_cmp_pd(v, one, _CMP_GE_OQ);
+  __m256d s, h, h16, c, d;
+  
+  /* NaN becomes zero, as `_mm256_max_pd` returns its second operand. */
+  v = _mm256_min_pd(_mm256_max_pd(v, zero), one);
+  
+  /* See `sse2_word` and `sse2_to_integer`. */
+  s = _mm256_mul_pd(v, _mm256_set1_pd(bits == 32 ? (double)0x1p32f : (double)0x1p16f));
+  h = _mm256_floor_pd(s);
+  c = _mm256_mul_pd(_mm256_sub_pd(s, h), _mm256_set1_pd(bits == 32 ? (double)0x1p32f : (double)0x1p48f));
+  c = _mm256_cmp_pd(c, _mm256_mul_pd(h, _mm256_set1_pd(bits == 32 ? (double)1.0f : TAIL_16)), _CMP_GE_OQ);
+  if (bits == 8)
+    {
+      h16 = h;
+      h = _mm256_floor_pd(_mm256_mul_pd(v, _mm256_set1_pd((double)0x1p8f)));
+      d = _mm256_sub_pd(h16, _mm256_mul_pd(h, _mm256_set1_pd((double)0x1p8f)));
+      c = _mm256_or_pd(_mm256_cmp_pd(d, h, _CMP_GT_OQ),
+		       _mm256_and_pd(_mm256_cmp_pd(d, h, _CMP_EQ_OQ), c));
+    }
+  
+  h = _mm256_sub_pd(h, _mm256_andnot_pd(c, one));
+  h = _mm256_blendv_pd(h, max, top);
+  return _mm_xor_si128(_mm256_cvttpd_epi32(_mm256_sub_pd(h, _mm256_set1_pd(OFFSET_31))),
+		       _mm_set1_epi32(INT32_MIN));
+}
+
+
+/**
+ * Convert unsigned 32-bit integers to `double`:s.
+ * 
+ * @param  x  The integers.
+ * @return    The integers as `double`:s.
+ */
+AVX2 static inline __attribute__((always_inline)) __m256d avx2_from_integer(__m128i x)
+{
+  x = _mm_xor_si128(x, _mm_set1_epi32(INT32_MIN));
+  return _mm256_add_pd(_mm256_cvtepi32_pd(x), _mm256_set1_pd(OFFSET_31));
+}
+
+
+/**
+ * Convert `float`:s or `double`:s to integers, AVX2 version.
+ * 
+ * @param   bits  The number of bits in the output, 8, 16 or 32.
+ * @param   out   Output array.
+ * @param   fin   Input array if the input is `float`:s, otherwise `NULL`.
+ * @param   din   Input array if the input is `double`:s, otherwise `NULL`.
+ * @param   n     The number of stops in the input.
+ * @return        The number of stops that have been converted.
+ */
+AVX2 static size_t avx2_to_integers(int bits, void* restrict out, const float* restrict fin,
+				    const double* restrict din, size_t n)
+{
+  __m256d v[2];
+  __m128i a, b;
+  size_t i, j;
+  
+  for (i = 0; i + 8 <= n; i += 8)
+    {
+      /* Load eight stops as `double`:s. */
+      for (j = 0; j < 2; j++)
+	if (fin != NULL)
+	  v[j] = _mm256_cvtps_pd(_mm_loadu_ps(fin + i + 4 * j));
+	else
+	  v[j] = _mm256_loadu_pd(din + i + 4 * j);
+      
+      /* Convert them to unsigned 32-bit integers. */
+      a = avx2_to_integer(v[0], bits);
+      b = avx2_to_integer(v[1], bits);
+      
+      /* Narrow and store them. */
+      if (bits == 32)
+	{
+	  _mm_storeu_si128((__m128i*)((uint32_t*)out + i) + 0, a);
+	  _mm_storeu_si128((__m128i*)((uint32_t*)out + i) + 1, b);
+	}
+      else if (bits == 16)
+	_mm_storeu_si128((__m128i*)((uint16_t*)out + i), _mm_packus_epi32(a, b));
+      else
+	{
+	  a = _mm_packus_epi16(_mm_packus_epi32(a, b), _mm_setzero_si128());
+	  _mm_storel_epi64((__m128i*)((uint8_t*)out + i), a);
+	}
+    }
+  
+  return i;
+}
+
+
+/**
+ * Convert integers to `float`:s or `double`:s, AVX2 version.
+ * 
+ * @param   bits  The number of bits in the input, 8, 16 or 32.
+ * @param   fout  Output array if the output is `float`:s, otherwise `NULL`.
+ * @param   dout  Output array if the output is `double`:s, otherwise `NULL`.
+ * @param   in    Input array.
+ * @param   n     The number of stops in the input.
+ * @return        The number of stops that have been converted.
+ */
+AVX2 static size_t avx2_from_integers(int bits, float* restrict fout, double* restrict dout,
+				      const void* restrict in, size_t n)
+{
+  const __m256d replicator = _mm256_set1_pd(bits == 32 ? REPLICATOR_32 : REPLICATOR_16);
+  __m256d v[2];
+  __m256i x;
+  __m128 lo, hi;
+  size_t i, j;
+  
+  for (i = 0; i + 8 <= n; i += 8)
+    {
+      /* Load eight stops as unsigned 32-bit integers,
+	 8-bit values are replicated to 16-bit values. */
+      if (bits == 32)
+	x = _mm256_loadu_si256((const __m256i*)((const uint32_t*)in + i));
+      else if (bits == 16)
+	x = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)((const uint16_t*)in + i)));
+      else
+	{
+	  x = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)((const uint8_t*)in + i)));
+	  x = _mm256_or_si256(x, _mm256_slli_epi32(x, 8));
+	}
+      
+      /* Replicate them to 64 bits, with rounding, as `double`:s. */
+      v[0] = _mm256_mul_pd(avx2_from_integer(_mm256_castsi256_si128(x)), replicator);
+      v[1] = _mm256_mul_pd(avx2_from_integer(_mm256_extracti128_si256(x, 1)), replicator);
+      
+      /* Scale them to [0, 1] and store them. */
+      if (dout != NULL)
+	for (j = 0; j < 2; j++)
+	  _mm256_storeu_pd(dout + i + 4 * j, _mm256_mul_pd(v[j], _mm256_set1_pd((double)0x1p-64f)));
+      else
+	{
+	  lo = _mm_mul_ps(_mm256_cvtpd_ps(v[0]), _mm_set1_ps(0x1p-64f));
+	  hi = _mm_mul_ps(_mm256_cvtpd_ps(v[1]), _mm_set1_ps(0x1p-64f));
+	  _mm_storeu_ps(fout + i + 0, lo);
+	  _mm_storeu_ps(fout + i + 4, hi);
+	}
+    }
+  
+  return i;
+}
+
+
+
+/* Some AVX-512 intrinsics in GCC initialise a variable with
+   itself to get an undefined vector, which is reported as a
+   possibly uninitialised variable when they are inlined. */
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+
+/**
+ * Convert [0, 1] values to `bits`-bit integers.
+ * 
+ * @param   v     The values.
+ * @param   bits  The number of bits in the output, 8, 16 or 32.
+ * @return        The integers, as unsigned 32-bit integers.
+ */
+AVX512 static inline __attribute__((always_inline)) __m256i avx512_to_integer(__m512d v, int bits)
+{
+  const __m512d zero = _mm512_setzero_pd(), one = _mm512_set1_pd((double)1.0f);
+  const __m512d max = _mm512_set1_pd((double)(bits == 32 ? UINT32_MAX : bits == 16 ? UINT16_MAX : UINT8_MAX));
+  __mmask8 top = _mm512_cmp_pd_mask(v, one, _CMP_GE_OQ);
+  __mmask8 c;
+  __m512d s, h, h16, d;
+  
+  /* NaN becomes zero, as `_mm512_max_pd` returns its second operand. */
+  v = _mm512_min_pd(_mm512_max_pd(v, zero), one);
+  
+  /* See `sse2_word` and `sse2_to_integer`. */
+  s = _mm512_mul_pd(v, _mm512_set1_pd(bits == 32 ? (double)0x1p32f : (double)0x1p16f));
+  h = _mm512_roundscale_pd(s, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+  d = _mm512_mul_pd(_mm512_sub_pd(s, h), _mm512_set1_pd(bits == 32 ? (double)0x1p32f : (double)0x1p48f));
+  c = _mm512_cmp_pd_mask(d, _mm512_mul_pd(h, _mm512_set1_pd(bits == 32 ? (double)1.0f : TAIL_16)), _CMP_GE_OQ);
+  if (bits == 8)
+    {
+      h16 = h;
+      h = _mm512_roundscale_pd(_mm512_mul_pd(v, _mm512_set1_pd((double)0x1p8f)),
+			       _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+      d = _mm512_sub_pd(h16, _mm512_mul_pd(h, _mm512_set1_pd((double)0x1p8f)));
+      c = (__mmask8)(_mm512_cmp_pd_mask(d, h, _CMP_GT_OQ) |
+		     (_mm512_cmp_pd_mask(d, h, _CMP_EQ_OQ) & c));
+    }
+  
+  h = _mm512_mask_sub_pd(h, (__mmask8)~c, h, one);
+  h = _mm512_mask_blend_pd(top, h, max);
+  return _mm512_cvttpd_epu32(h);
+}
+
+
+/**
+ * Convert `float`:s or `double`:s to integers, AVX-512 version.
+ * 
+ * @param   bits  The number of bits in the output, 8, 16 or 32.
+ * @param   out   Output array.
+ * @param   fin   Input array if the input is `float`:s, otherwise `NULL`.
+ * @param   din   Input array if the input is `double`:s, otherwise `NULL`.
+ * @param   n     The number of stops in the input.
+ * @return        The number of stops that have been converted.
+ */
+AVX512 static size_t avx512_to_integers(int bits, void* restrict out, const float* restrict fin,
+					const double* restrict din, size_t n)
+{
+  __m512d v[2];
+  __m512i x;
+  size_t i, j;
+  
+  for (i = 0; i + 16 <= n; i += 16)
+    {
+      /* Load sixteen stops as `double`:s. */
+      for (j = 0; j < 2; j++)
+	if (fin != NULL)
+	  v[j] = _mm512_cvtps_pd(_mm256_loadu_ps(fin + i + 8 * j));
+	else
+	  v[j] = _mm512_loadu_pd(din + i + 8 * j);
+      
+      /* Convert them to unsigned 32-bit integers. */
+      x = _mm512_castsi256_si512(avx512_to_integer(v[0], bits));
+      x = _mm512_inserti64x4(x, avx512_to_integer(v[1], bits), 1);
+      
+      /* Narrow and store them. */
+      if (bits == 32)
+	_mm512_storeu_si512((uint32_t*)out + i, x);
+      else if (bits == 16)
+	_mm256_storeu_si256((__m256i*)((uint16_t*)out + i), _mm512_cvtepi32_epi16(x));
+      else
+	_mm_storeu_si128((__m128i*)((uint8_t*)out + i), _mm512_cvtepi32_epi8(x));
+    }
+  
+  return i;
+}
+
+
+/**
+ * Convert integers to `float`:s or `double`:s, AVX-512 version.
+ * 
+ * @param   bits  The number of bits in the input, 8, 16 or 32.
+ * @param   fout  Output array if the output is `float`:s, otherwise `NULL`.
+ * @param   dout  Output array if the output is `double`:s, otherwise `NULL`.
+ * @param   in    Input array.
+ * @param   n     The number of stops in the input.
+ * @return        The number of stops that have been converted.
+ */
+AVX512 static size_t avx512_from_integers(int bits, float* restrict fout, double* restrict dout,
+					  const void* restrict in, size_t n)
+{
+  const __m512d replicator = _mm512_set1_pd(bits == 32 ? REPLICATOR_32 : REPLICATOR_16);
+  __m512d v[2];
+  __m512i x;
+  size_t i, j;
+  
+  for (i = 0; i + 16 <= n; i += 16)
+    {
+      /* Load sixteen stops as unsigned 32-bit integers,
+	 8-bit values are replicated to 16-bit values. */
+      if (bits == 32)
+	x = _mm512_loadu_si512((const uint32_t*)in + i);
+      else if (bits == 16)
+	x = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)((const uint16_t*)in + i)));
+      else
+	{
+	  x = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)((const uint8_t*)in + i)));
+	  x = _mm512_or_si512(x, _mm512_slli_epi32(x, 8));
+	}
+      
+      /* Replicate them to 64 bits, with rounding, as `double`:s. */
+      v[0] = _mm512_mul_pd(_mm512_cvtepu32_pd(_mm512_castsi512_si256(x)), replicator);
+      v[1] = _mm512_mul_pd(_mm512_cvtepu32_pd(_mm512_extracti64x4_epi64(x, 1)), replicator);
+      
+      /* Scale them to [0, 1] and store them. */
+      for (j = 0; j < 2; j++)
+	if (dout != NULL)
+	  _mm512_storeu_pd(dout + i + 8 * j, _mm512_mul_pd(v[j], _mm512_set1_pd((double)0x1p-64f)));
+	else
+	  _mm256_storeu_ps(fout + i + 8 * j,
+			   _mm256_mul_ps(_mm512_cvtpd_ps(v[j]), _mm256_set1_ps(0x1p-64f)));
+    }
+  
+  return i;
+}
+
+# pragma GCC diagnostic pop
+
+
+
+/**
+ * Clamp values to [0, 1], NaN becomes zero,
+ * as `_mm256_max_ps` returns its second operand.
+ * 
+ * The sign bit is cleared afterwards, as the
+ * compiler may swap the operands of `_mm256_max_ps`
+ * when compiled with -Ofast, so that −0, and negative
+ * values that are flushed to −0, would stay −0 rather
+ * than become 0 as in the scalar kernels.
+ * 
+ * @param   v  The values.
+ * @return     The values clamped to [0, 1].
+ */
+F16C static inline __attribute__((always_inline)) __m256 f16c_unit(__m256 v)
+{
+  v = _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+  return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+
+/**
+ * Convert `float`:s to half precision floats, after
+ * clamping them to [0, 1], eight at a time.
+ * 
+ * @param  out  Output array.
+ * @param  in   Input array.
+ * @param  n    The number of stops, must be a multiple of 8.
+ */
+F16C static void f16c_to_half(uint16_t* restrict out, const float* restrict in, size_t n)
+{
+  size_t i;
+  for (i = 0; i < n; i += 8)
+    _mm_storeu_si128((__m128i*)(out + i),
+		     _mm256_cvtps_ph(f16c_unit(_mm256_loadu_ps(in + i)), _MM_FROUND_TO_NEAREST_INT));
+}
+
+
+/**
+ * Convert half precision floats to `float`:s, eight at a time.
+ * 
+ * @param  out    Output array.
+ * @param  in     Input array.
+ * @param  n      The number of stops, must be a multiple of 8.
+ * @param  clamp  Whether the values shall be clamped to [0, 1].
+ */
+F16C static void f16c_from_half(float* restrict out, const uint16_t* restrict in, size_t n, int clamp)
+{
+  size_t i;
+  __m256 v;
+  for (i = 0; i < n; i += 8)
+    {
+      v = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(in + i)));
+      _mm256_storeu_ps(out + i, clamp ? f16c_unit(v) : v);
+    }
+}
+
+
+/**
+ * Get the size of a stop.
+ * 
+ * @param   depth  The depth of the stop, `-1` for `float`, `-2` for `double`, `-3` for half.
+ * @return         The size of the stop, in bytes.
+ */
+static size_t stop_size(signed depth)
+{
+  return depth == -1 ? sizeof(float) : depth == -2 ? sizeof(double) :
+         depth == -3 ? sizeof(uint16_t) : (size_t)depth / 8;
+}
+
+
+/**
+ * Convert stops from or to half precision floats.
+ * 
+ * Half precision floats are converted exactly to `float`:s,
+ * so other depths are converted in blocks, that fit in the
+ * L1 cache, through `float` with the `float` kernels, and
+ * the conversion between `float` and half precision is
+ * done with F16C. Conversion stops at the first block that
+ * the `float` kernels do not convert in full.
+ * 
+ * @param   depth_out  The depth of `out`.
+ * @param   out        Output array.
+ * @param   depth_in   The depth of `in`.
+ * @param   in         Input array.
+ * @param   n          The number of stops in `in`.
+ * @return             The number of stops that have been converted.
+ */
+static size_t f16c_translate(signed depth_out, void* restrict out,
+			     signed depth_in, const void* restrict in, size_t n)
+{
+  float buffer[HALF_BLOCK];
+  const float* restrict fin;
+  size_t i, m;
+  
+  for (i = 0; n - i >= 8; i += m)
+    {
+      m = n - i < HALF_BLOCK ? (n - i) & ~(size_t)7 : HALF_BLOCK;
+      if (depth_in == -3)
+	{
+	  /* From half precision, directly to `float`
+	     or to other depths through `float`. */
+	  if (depth_out == -1)
+	    f16c_from_half((float*)out + i, (const uint16_t*)in + i, m, 1);
+	  else
+	    {
+	      f16c_from_half(buffer, (const uint16_t*)in + i, m, 0);
+	      if (libgamma_simd_translate(depth_out, (char*)out + i * stop_size(depth_out),
+					  -1, buffer, m) < m)
+		break;
+	    }
+	}
+      else
+	{
+	  /* To half precision, directly from `float`
+	     or from other depths through `float`. */
+	  if (depth_in == -1)
+	    fin = (const float*)in + i;
+	  else if (libgamma_simd_translate(-1, buffer, depth_in,
+					   (const char*)in + i * stop_size(depth_in), m) < m)
+	    break;
+	  else
+	    fin = buffer;
+	  f16c_to_half((uint16_t*)out + i, fin, m);
+	}
+    }
+  
+  return i;
+}
+
+
+#endif
+
+
+
+/**
+ * Convert the leading stops of a set of gamma ramps to another
+ * depth using the widest vector instructions the CPU supports.
+ * The instruction set is selected once, when the library is loaded.
+ * 
+ * Only conversions between floating point and integer depths,
+ * with at most 32 bits, and conversions from and to half precision
+ * floating point, through `float`, have vectorised kernels, and
+ * only whole blocks of stops are converted. The caller is responsible for
+ * converting the remaining stops, starting at the returned index.
+ * The result is identical to the scalar conversion for every
+ * finite input.
+ * 
+ * @param   depth_out  The depth of `out`, `-1` for `float`, `-2` for `double`, `-3` for half.
+ * @param   out        Output array.
+ * @param   depth_in   The depth of `in`, `-1` for `float`, `-2` for `double`, `-3` for half.
+ * @param   in         Input array.
+ * @param   n          The number of stops in `in`.
+ * @return             The number of stops that have been converted.
+ */
+size_t libgamma_simd_translate(signed depth_out, void* restrict out,
+			       signed depth_in, const void* restrict in, size_t n)
+{
+#ifdef HAVE_SIMD_X86
+  const float* fin = depth_in == -1 ? in : NULL;
+  const double* din = depth_in == -2 ? in : NULL;
+  float* fout = depth_out == -1 ? out : NULL;
+  double* dout = depth_out == -2 ? out : NULL;
+  
+  if ((depth_in == -3) || (depth_out == -3))
+    /* Half precision floating point. */
+    return simd_f16c && (depth_in != depth_out) ? f16c_translate(depth_out, out, depth_in, in, n) : 0;
+  else if ((depth_in < 0) && (8 <= depth_out) && (depth_out <= 32))
+    /* Floating point to integer. */
+    switch (simd_level)
+      {
+      case SIMD_AVX512:  return avx512_to_integers(depth_out, out, fin, din, n);
+      case SIMD_AVX2:    return   avx2_to_integers(depth_out, out, fin, din, n);
+      case SIMD_SSE2:    return   sse2_to_integers(depth_out, out, fin, din, n);
+      default:
+	break;
+      }
+  else if ((depth_out < 0) && (8 <= depth_in) && (depth_in <= 32))
+    {
+      /* Integer to floating point. (The scalar conversion
+	 from 32-bit integers to `float` is rounded once,
+	 here it would be rounded twice.) */
+      if ((depth_in == 32) && (depth_out == -1))
+	return 0;
+      switch (simd_level)
+	{
+	case SIMD_AVX512:  return avx512_from_integers(depth_in, fout, dout, in, n);
+	case SIMD_AVX2:    return   avx2_from_integers(depth_in, fout, dout, in, n);
+	case SIMD_SSE2:    return   sse2_from_integers(depth_in, fout, dout, in, n);
+	default:
+	  break;
+	}
+    }
+  
+  return 0;
+#else
+  (void) depth_out;
+  (void) out;
+  (void) depth_in;
+  (void) in;
+  (void) n;
+  return 0;
+#endif
+}
+
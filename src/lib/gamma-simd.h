@@ -0,0 +1,50 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBGAMMA_GAMMA_SIMD_H
+#define LIBGAMMA_GAMMA_SIMD_H
+
+
+#include <stddef.h>
+
+
+/**
+ * Convert the leading stops of a set of gamma ramps to another
+ * depth using the widest vector instructions the CPU supports.
+ * The instruction set is selected once, when the library is loaded.
+ * 
+ * Only conversions between floating point and integer depths,
+ * with at most 32 bits, and conversions from and to half precision
+ * floating point, through `float`, have vectorised kernels, and
+ * only whole blocks of stops are converted. The caller is responsible for
+ * converting the remaining stops, starting at the returned index.
+ * The result is identical to the scalar conversion for every
+ * finite input.
+ * 
+ * @param   depth_out  The depth of `out`, `-1` for `float`, `-2` for `double`, `-3` for half.
+ * @param   out        Output array.
+ * @param   depth_in   The depth of `in`, `-1` for `float`, `-2` for `double`, `-3` for half.
+ * @param   in         Input array.
+ * @param   n          The number of stops in `in`.
+ * @return             The number of stops that have been converted.
+ */
+size_t libgamma_simd_translate(signed depth_out, void* restrict out,
+			       signed depth_in, const void* restrict in, size_t n);
+
+
+#endif
+
@@ -86,6 +86,8 @@ void libgamma_w32_gdi_method_capabilities(libgamma_method_capabilities_t* restri
 #endif
   /* Gamma ramp adjustments are persistent. */
   this->auto_restore = 0;
+  /* Gamma ramps are applied one CRTC at a time. */
+  this->atomic_transactions = 0;
 }
 
 
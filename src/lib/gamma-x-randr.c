@@ -23,6 +23,7 @@
 
 #include "libgamma-error.h"
 #include "edid.h"
+#include "gamma-pool.h"
 
 #include <stdlib.h>
 #include <errno.h>
@@ -46,6 +47,14 @@
  */
 #define RANDR_VERSION_MINOR  3
 
+/**
+ * The maximum number of CRTC:s whose gamma ramps are requested
+ * or applied before the replies or errors are collected, by
+ * `libgamma_x_randr_crtc_get_gamma_ramps16_many` and
+ * `libgamma_x_randr_crtc_set_gamma_ramps16_many`.
+ */
+#define BATCH_SIZE  64
+
 
 
 /**
@@ -81,6 +90,12 @@ typedef struct libgamma_x_randr_partition_data
    */
   xcb_timestamp_t config_timestamp;
   
+  /**
+   * The screen's root window, events
+   * for the screen are reported on it.
+   */
+  xcb_window_t root;
+  
 } libgamma_x_randr_partition_data_t;
 
 
@@ -160,6 +175,8 @@ void libgamma_x_randr_method_capabilities(libgamma_method_capabilities_t* restri
   this->fake = 0;
   /* Gamma ramp adjustments are persistent. */
   this->auto_restore = 0;
+  /* Gamma ramps are applied one CRTC at a time, but without waiting in between. */
+  this->atomic_transactions = 0;
 }
 
 
@@ -274,6 +291,191 @@ int libgamma_x_randr_site_restore(libgamma_site_state_t* restrict this)
 }
 
 
+/**
+ * Subscribe to changes to the screens, CRTC:s and outputs of
+ * all screens, and get the file descriptor of the connection to
+ * the display server, which is readable when there are events.
+ * Events that other requests have read into the connection's queue
+ * do not make it readable, so `libgamma_x_randr_site_process_events`
+ * must be called before each time it is polled.
+ * 
+ * @param   this  The site state.
+ * @return        The file descriptor, otherwise (negative) the value
+ *                of an error identifier provided by this library.
+ */
+int libgamma_x_randr_site_event_fd(libgamma_site_state_t* restrict this)
+{
+  xcb_connection_t* restrict connection = this->data;
+  const xcb_setup_t* restrict setup;
+  xcb_screen_iterator_t iter;
+  int error;
+  
+  if ((setup = xcb_get_setup(connection)) == NULL)
+    return LIBGAMMA_LIST_PARTITIONS_FAILED;
+  
+  /* Selecting the events again is harmless, so we do not keep track of it. */
+  for (iter = xcb_setup_roots_iterator(setup); iter.rem > 0; xcb_screen_next(&iter))
+    xcb_randr_select_input(connection, iter.data->root,
+			   XCB_RANDR_NOTIFY_MASK_SCREEN_CHANGE |
+			   XCB_RANDR_NOTIFY_MASK_CRTC_CHANGE   |
+			   XCB_RANDR_NOTIFY_MASK_OUTPUT_CHANGE);
+  xcb_flush(connection);
+  
+  if ((error = xcb_connection_has_error(connection)))
+    return translate_error(error, LIBGAMMA_OPEN_SITE_FAILED, 0);
+  return xcb_get_file_descriptor(connection);
+}
+
+
+/**
+ * Update a partition's data after one of its outputs has changed.
+ * 
+ * @param   this    The partition state.
+ * @param   change  The change to the output.
+ * @return          Zero on success, 1 if the output or its CRTC is
+ *                  not known, in which case the partition's data
+ *                  is unchanged and the partition must be refreshed.
+ */
+static int apply_output_change(libgamma_partition_state_t* restrict this,
+			       const xcb_randr_output_change_t* restrict change)
+{
+  libgamma_x_randr_partition_data_t* restrict data = this->data;
+  size_t i, output, crtc = SIZE_MAX;
+  
+  for (output = 0; output < data->outputs_count; output++)
+    if (data->outputs[output] == change->output)
+      break;
+  if (output == data->outputs_count)
+    return 1;
+  
+  if (change->crtc != XCB_NONE)
+    {
+      for (crtc = 0; crtc < this->crtcs_available; crtc++)
+	if (data->crtcs[crtc] == change->crtc)
+	  break;
+      if (crtc == this->crtcs_available)
+	return 1;
+    }
+  
+  /* Move the output from its old CRTC to its new CRTC. */
+  for (i = 0; i < this->crtcs_available; i++)
+    if (data->crtc_to_output[i] == output)
+      data->crtc_to_output[i] = SIZE_MAX;
+  if (crtc != SIZE_MAX)
+    data->crtc_to_output[crtc] = output;
+  
+  data->config_timestamp = change->config_timestamp;
+  return 0;
+}
+
+
+/**
+ * Process all pending RandR events, update the data of the partitions
+ * they are for, incrementally when an output has changed, and refresh
+ * the partitions whose CRTC:s or outputs are no longer known.
+ * 
+ * @param   this        The site state.
+ * @param   partitions  The partition states that may be updated.
+ * @param   count       The number of elements in `partitions` and `results`.
+ * @param   results     For each partition state, set to 1 if it was updated,
+ *                      or (negative) the value of an error identifier provided by
+ *                      this library if it could not be refreshed, left as zero
+ *                      if the partition has not changed.
+ * @return              The number of partition states that have changed, otherwise
+ *                      (negative) the value of an error identifier provided by this
+ *                      library, if the events could not be read.
+ */
+int libgamma_x_randr_site_process_events(libgamma_site_state_t* restrict this,
+					 libgamma_partition_state_t* restrict partitions, size_t count,
+					 int* restrict results)
+{
+#define REFRESH  2
+  xcb_connection_t* restrict connection = this->data;
+  const xcb_query_extension_reply_t* restrict extension;
+  const xcb_randr_screen_change_notify_event_t* screen_change;
+  const xcb_randr_notify_event_t* notify;
+  libgamma_x_randr_partition_data_t* restrict data;
+  xcb_generic_event_t* restrict event;
+  xcb_window_t root;
+  size_t i, j;
+  int r, changed = 0;
+  
+  extension = xcb_get_extension_data(connection, &xcb_randr_id);
+  if ((extension == NULL) || !(extension->present))
+    return LIBGAMMA_PROTOCOL_VERSION_QUERY_FAILED;
+  
+  /* This also returns the events that other requests have queued. */
+  while ((event = xcb_poll_for_event(connection)) != NULL)
+    {
+      screen_change = (void*)event;
+      notify = (void*)event;
+      
+      /* Any change to the screen's configuration, for example a change
+	 of its size, is reported on the screen, so it is only refreshed
+	 if its configuration is newer than what we have, and otherwise
+	 it has not changed. */
+      if ((event->response_type & 0x7F) == extension->first_event + XCB_RANDR_SCREEN_CHANGE_NOTIFY)
+	{
+	  for (i = 0; i < count; i++)
+	    {
+	      data = partitions[i].data;
+	      if ((data->root == screen_change->root) &&
+		  (data->config_timestamp != screen_change->config_timestamp))
+		results[i] = REFRESH;
+	    }
+	}
+      
+      /* Outputs are moved between CRTC:s in the partition's data,
+	 and CRTC:s only need to exist in the partition's data. */
+      else if ((event->response_type & 0x7F) == extension->first_event + XCB_RANDR_NOTIFY)
+	{
+	  if (notify->subCode == XCB_RANDR_NOTIFY_OUTPUT_CHANGE)
+	    root = notify->u.oc.window;
+	  else if (notify->subCode == XCB_RANDR_NOTIFY_CRTC_CHANGE)
+	    root = notify->u.cc.window;
+	  else
+	    root = XCB_NONE;
+	  for (i = 0; i < count; i++)
+	    {
+	      data = partitions[i].data;
+	      if ((data->root != root) || (results[i] == REFRESH))
+		continue;
+	      results[i] = 1;
+	      if (notify->subCode == XCB_RANDR_NOTIFY_OUTPUT_CHANGE)
+		{
+		  if (apply_output_change(partitions + i, &(notify->u.oc)))
+		    results[i] = REFRESH;
+		  continue;
+		}
+	      for (j = 0; j < partitions[i].crtcs_available; j++)
+		if (data->crtcs[j] == notify->u.cc.crtc)
+		  break;
+	      if (j == partitions[i].crtcs_available)
+		results[i] = REFRESH;
+	    }
+	}
+      
+      free(event);
+    }
+  
+  if ((r = xcb_connection_has_error(connection)))
+    return translate_error(r, LIBGAMMA_OPEN_SITE_FAILED, 0);
+  
+  /* Refresh each partition that needs it once, however many events it got. */
+  for (i = 0; i < count; i++)
+    {
+      if (results[i] == 0)
+	continue;
+      changed++;
+      if (results[i] == REFRESH)
+	results[i] = (r = libgamma_x_randr_partition_refresh(partitions + i)) ? r : 1;
+    }
+  
+  return changed;
+#undef REFRESH
+}
+
+
 /**
  * Duplicate a memory area.
  * 
@@ -284,7 +486,7 @@ int libgamma_x_randr_site_restore(libgamma_site_state_t* restrict this)
 static inline void* memdup(void* restrict ptr, size_t bytes)
 {
   char* restrict rc;
-  if ((bytes == 0) || ((rc = malloc(bytes)) == NULL))
+  if ((bytes == 0) || ((rc = libgamma_allocate(bytes)) == NULL))
     return NULL;
   memcpy(rc, ptr, bytes);
   return rc;
@@ -292,55 +494,26 @@ static inline void* memdup(void* restrict ptr, size_t bytes)
 
 
 /**
- * Initialise an allocated partition state.
+ * Initialise an allocated partition state from the current resources of its screen.
  * 
- * @param   this       The partition state to initialise.
- * @param   site       The site state for the site that the partition belongs to.
- * @param   partition  The the index of the partition within the site.
- * @return             Zero on success, otherwise (negative) the value of an
- *                     error identifier provided by this library.
+ * @param   this        The partition state to initialise.
+ * @param   connection  The connection to the display server.
+ * @param   root        The screen's root window.
+ * @param   reply       The current resources of the screen, it is not released.
+ * @return              Zero on success, otherwise (negative) the value of an
+ *                      error identifier provided by this library.
  */
-int libgamma_x_randr_partition_initialise(libgamma_partition_state_t* restrict this,
-					  libgamma_site_state_t* restrict site, size_t partition)
+static int partition_initialise_from_reply(libgamma_partition_state_t* restrict this,
+					   xcb_connection_t* restrict connection, xcb_window_t root,
+					   xcb_randr_get_screen_resources_current_reply_t* restrict reply)
 {
   int fail_rc = LIBGAMMA_ERRNO_SET;
-  xcb_connection_t* restrict connection = site->data;
-  xcb_screen_t* restrict screen = NULL;
   xcb_generic_error_t* error = NULL;
-  const xcb_setup_t* restrict setup;
-  xcb_screen_iterator_t iter;
-  xcb_randr_get_screen_resources_current_cookie_t cookie;
-  xcb_randr_get_screen_resources_current_reply_t* restrict reply;
   xcb_randr_crtc_t* restrict crtcs;
   xcb_randr_output_t* restrict outputs;
+  xcb_randr_get_output_info_cookie_t* restrict out_cookies = NULL;
   libgamma_x_randr_partition_data_t* restrict data;
-  size_t i;
-  
-  /* Get screen list. */
-  if ((setup = xcb_get_setup(connection)) == NULL)
-    return LIBGAMMA_LIST_PARTITIONS_FAILED;
-  iter = xcb_setup_roots_iterator(setup);
-  
-  /* Get the screen. */
-  for (i = 0; iter.rem > 0; i++, xcb_screen_next(&iter))
-    if (i == partition)
-      {
-	screen = iter.data;
-	break;
-      }
-  /* Report failure if we did not find the screen. */
-  if (iter.rem == 0)
-    return LIBGAMMA_NO_SUCH_PARTITION;
-  
-  /* Check that the screen is not `NULL`. (Do not think this can happen, but why not.) */
-  if (screen == NULL)
-    return LIBGAMMA_NULL_PARTITION;
-  
-  /* Get the current resources of the screen. */
-  cookie = xcb_randr_get_screen_resources_current(connection, screen->root);
-  reply = xcb_randr_get_screen_resources_current_reply(connection, cookie, &error);
-  if (error != NULL)
-    return translate_error(error->error_code, LIBGAMMA_LIST_CRTCS_FAILED, 0);
+  size_t i, n;
   
   /* Get the number of available CRTC:s. */
   this->crtcs_available = reply->num_crtcs;
@@ -348,11 +521,11 @@ int libgamma_x_randr_partition_initialise(libgamma_partition_state_t* restrict t
   crtcs = xcb_randr_get_screen_resources_current_crtcs(reply);
   outputs = xcb_randr_get_screen_resources_current_outputs(reply);
   if ((crtcs == NULL) || (outputs == NULL))
-    return free(reply), LIBGAMMA_REPLY_VALUE_EXTRACTION_FAILED;
+    return LIBGAMMA_REPLY_VALUE_EXTRACTION_FAILED;
   
   /* Allocate adjustment method dependent data memory area.
-     We use `calloc` because we want `data`'s pointers to be `NULL` if not allocated at `fail`. */
-  if ((data = calloc(1, sizeof(libgamma_x_randr_partition_data_t))) == NULL)
+     We use `libgamma_callocate` because we want `data`'s pointers to be `NULL` if not allocated at `fail`. */
+  if ((data = libgamma_callocate(1, sizeof(libgamma_x_randr_partition_data_t))) == NULL)
     goto fail;
   
   /* Copy the CRTC:s, just so we do not have to keep the reply in memory. */
@@ -366,28 +539,37 @@ int libgamma_x_randr_partition_initialise(libgamma_partition_state_t* restrict t
     goto fail;
   
   /* Get the number of available outputs. */
-  data->outputs_count = (size_t)(reply->num_outputs);
+  data->outputs_count = n = (size_t)(reply->num_outputs);
   
   /* Create mapping table from CRTC indices to output indicies. (injection) */
-  if ((data->crtc_to_output = malloc((size_t)(reply->num_crtcs) * sizeof(size_t))) == NULL)
+  if ((data->crtc_to_output = libgamma_allocate((size_t)(reply->num_crtcs) * sizeof(size_t))) == NULL)
     goto fail;
   /* All CRTC:s should be mapped, but incase they are not, all unmapped CRTC:s should have
      an invalid target, namely `SIZE_MAX`, which is 1 more than the theoretical limit. */
   for (i = 0; i < (size_t)(reply->num_crtcs); i++)
     data->crtc_to_output[i] = SIZE_MAX;
+  
+  /* Query output (target) information, all requests are
+     sent before we wait for any reply, to save round trips. */
+  if ((n > 0) && ((out_cookies = libgamma_allocate(n * sizeof(*out_cookies))) == NULL))
+    goto fail;
+  for (i = 0; i < n; i++)
+    out_cookies[i] = xcb_randr_get_output_info(connection, outputs[i], reply->config_timestamp);
+  
   /* Fill the table. */
-  for (i = 0; i < (size_t)(reply->num_outputs); i++)
+  for (i = 0; i < n; i++)
     {
-      xcb_randr_get_output_info_cookie_t out_cookie;
       xcb_randr_get_output_info_reply_t* out_reply;
       uint16_t j;
       
-      /* Query output (target) information. */
-      out_cookie = xcb_randr_get_output_info(connection, outputs[i], reply->config_timestamp);
-      out_reply = xcb_randr_get_output_info_reply(connection, out_cookie, &error);
+      out_reply = xcb_randr_get_output_info_reply(connection, out_cookies[i], &error);
       if (error != NULL)
 	{
 	  fail_rc = translate_error(error->error_code, LIBGAMMA_OUTPUT_INFORMATION_QUERY_FAILED, 0);
+	  free(error);
+	  /* Discard the replies we will not read. */
+	  while (++i < n)
+	    xcb_discard_reply(connection, out_cookies[i].sequence);
 	  goto fail;
 	}
       
@@ -405,26 +587,165 @@ int libgamma_x_randr_partition_initialise(libgamma_partition_state_t* restrict t
   
   /* Store the configuration timestamp. */
   data->config_timestamp = reply->config_timestamp;
+  data->root = root;
   /* Store the adjustment method dependent data. */
   this->data = data;
   /* Release resources and return successfully. */
-  free(reply);
+  libgamma_deallocate(out_cookies);
   return 0;
   
  fail:
   /* Release resources and return with an error. */
   if (data != NULL)
     {
-      free(data->crtcs);
-      free(data->outputs);
-      free(data->crtc_to_output);
-      free(data);
+      libgamma_deallocate(data->crtcs);
+      libgamma_deallocate(data->outputs);
+      libgamma_deallocate(data->crtc_to_output);
+      libgamma_deallocate(data);
     }
-  free(reply);
+  libgamma_deallocate(out_cookies);
   return fail_rc;
 }
 
 
+/**
+ * Initialise an allocated partition state.
+ * 
+ * @param   this       The partition state to initialise.
+ * @param   site       The site state for the site that the partition belongs to.
+ * @param   partition  The the index of the partition within the site.
+ * @return             Zero on success, otherwise (negative) the value of an
+ *                     error identifier provided by this library.
+ */
+int libgamma_x_randr_partition_initialise(libgamma_partition_state_t* restrict this,
+					  libgamma_site_state_t* restrict site, size_t partition)
+{
+  xcb_connection_t* restrict connection = site->data;
+  xcb_screen_t* restrict screen = NULL;
+  xcb_generic_error_t* error = NULL;
+  const xcb_setup_t* restrict setup;
+  xcb_screen_iterator_t iter;
+  xcb_randr_get_screen_resources_current_cookie_t cookie;
+  xcb_randr_get_screen_resources_current_reply_t* restrict reply;
+  size_t i;
+  int r;
+  
+  /* Get screen list. */
+  if ((setup = xcb_get_setup(connection)) == NULL)
+    return LIBGAMMA_LIST_PARTITIONS_FAILED;
+  iter = xcb_setup_roots_iterator(setup);
+  
+  /* Get the screen. */
+  for (i = 0; iter.rem > 0; i++, xcb_screen_next(&iter))
+    if (i == partition)
+      {
+	screen = iter.data;
+	break;
+      }
+  /* Report failure if we did not find the screen. */
+  if (iter.rem == 0)
+    return LIBGAMMA_NO_SUCH_PARTITION;
+  
+  /* Check that the screen is not `NULL`. (Do not think this can happen, but why not.) */
+  if (screen == NULL)
+    return LIBGAMMA_NULL_PARTITION;
+  
+  /* Get the current resources of the screen. */
+  cookie = xcb_randr_get_screen_resources_current(connection, screen->root);
+  reply = xcb_randr_get_screen_resources_current_reply(connection, cookie, &error);
+  if (error != NULL)
+    return translate_error(error->error_code, LIBGAMMA_LIST_CRTCS_FAILED, 0);
+  
+  r = partition_initialise_from_reply(this, connection, screen->root, reply);
+  free(reply);
+  return r;
+}
+
+
+/**
+ * Initialise the allocated partition states of all partitions on a site.
+ * The current resources of all screens are requested before we wait
+ * for any of them, so that it costs one round trip rather than one
+ * per screen.
+ * 
+ * @param   partitions  The partition states to initialise, `site->partitions_available`
+ *                      elements, their `site` and `partition` have been set.
+ * @param   site        The site state for the site that the partitions belongs to.
+ * @return              Zero on success, otherwise (negative) the value of an error
+ *                      identifier provided by this library, in which case none of
+ *                      the partition states are left initialised.
+ */
+int libgamma_x_randr_partition_initialise_all(libgamma_partition_state_t* restrict partitions,
+					      libgamma_site_state_t* restrict site)
+{
+  xcb_connection_t* restrict connection = site->data;
+  xcb_generic_error_t* error = NULL;
+  const xcb_setup_t* restrict setup;
+  xcb_screen_iterator_t iter;
+  xcb_randr_get_screen_resources_current_cookie_t* restrict cookies;
+  xcb_randr_get_screen_resources_current_reply_t* restrict reply;
+  size_t i, sent, initialised = 0, n = site->partitions_available;
+  int r = 0;
+  
+  if (n == 0)
+    return 0;
+  
+  /* Get screen list. */
+  if ((setup = xcb_get_setup(connection)) == NULL)
+    return LIBGAMMA_LIST_PARTITIONS_FAILED;
+  iter = xcb_setup_roots_iterator(setup);
+  
+  if ((cookies = libgamma_allocate(n * sizeof(*cookies))) == NULL)
+    return LIBGAMMA_ERRNO_SET;
+  
+  /* Request the current resources of all screens. */
+  for (sent = 0; sent < n; sent++, xcb_screen_next(&iter))
+    {
+      if (iter.rem == 0)
+	{
+	  r = LIBGAMMA_NO_SUCH_PARTITION;
+	  break;
+	}
+      if (iter.data == NULL)
+	{
+	  r = LIBGAMMA_NULL_PARTITION;
+	  break;
+	}
+      cookies[sent] = xcb_randr_get_screen_resources_current(connection, iter.data->root);
+    }
+  
+  /* Initialise the partitions from the replies, after a
+     failure the remaining replies are only discarded. */
+  iter = xcb_setup_roots_iterator(setup);
+  for (i = 0; i < sent; i++, xcb_screen_next(&iter))
+    {
+      if (r != 0)
+	{
+	  xcb_discard_reply(connection, cookies[i].sequence);
+	  continue;
+	}
+      reply = xcb_randr_get_screen_resources_current_reply(connection, cookies[i], &error);
+      if (error != NULL)
+	{
+	  r = translate_error(error->error_code, LIBGAMMA_LIST_CRTCS_FAILED, 0);
+	  free(error);
+	  continue;
+	}
+      r = partition_initialise_from_reply(partitions + i, connection, iter.data->root, reply);
+      free(reply);
+      if (r == 0)
+	initialised++;
+    }
+  libgamma_deallocate(cookies);
+  
+  /* Release the partitions that were initialised if any failed. */
+  if (r != 0)
+    while (initialised--)
+      libgamma_x_randr_partition_destroy(partitions + initialised);
+  return r;
+}
+
+
 /**
  * Release all resources held by a partition state.
  * 
@@ -433,10 +754,10 @@ int libgamma_x_randr_partition_initialise(libgamma_partition_state_t* restrict t
 void libgamma_x_randr_partition_destroy(libgamma_partition_state_t* restrict this)
 {
   libgamma_x_randr_partition_data_t* restrict data = this->data;
-  free(data->crtcs);
-  free(data->outputs);
-  free(data->crtc_to_output);
-  free(data);
+  libgamma_deallocate(data->crtcs);
+  libgamma_deallocate(data->outputs);
+  libgamma_deallocate(data->crtc_to_output);
+  libgamma_deallocate(data);
 }
 
 
@@ -454,6 +775,26 @@ int libgamma_x_randr_partition_restore(libgamma_partition_state_t* restrict this
 }
 
 
+/**
+ * Refresh a partition state, so that it reflects the current CRTC:s
+ * and outputs of the screen, by reading the screen's resources anew.
+ * 
+ * @param   this  The partition state.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library.
+ */
+int libgamma_x_randr_partition_refresh(libgamma_partition_state_t* restrict this)
+{
+  libgamma_partition_state_t fresh = *this;
+  int r;
+  if ((r = libgamma_x_randr_partition_initialise(&fresh, this->site, this->partition)))
+    return r;
+  libgamma_x_randr_partition_destroy(this);
+  *this = fresh;
+  return 0;
+}
+
+
 
 /**
  * Initialise an allocated CRTC state.
@@ -499,6 +840,29 @@ int libgamma_x_randr_crtc_restore(libgamma_crtc_state_t* restrict this)
 }
 
 
+/**
+ * Get the handle for a CRTC.
+ * 
+ * @param   partition  The partition state for the partition that the CRTC belongs to.
+ * @param   crtc       The index of the CRTC within the partition.
+ * @param   handle     Output parameter for the CRTC's handle.
+ * @return             Zero on success, otherwise (negative) the value of an
+ *                     error identifier provided by this library.
+ */
+int libgamma_x_randr_crtc_handle(libgamma_partition_state_t* restrict partition, size_t crtc,
+				 libgamma_crtc_handle_t* restrict handle)
+{
+  libgamma_x_randr_partition_data_t* restrict screen_data = partition->data;
+  size_t output_index;
+  if (crtc >= partition->crtcs_available)
+    return LIBGAMMA_NO_SUCH_CRTC;
+  output_index = screen_data->crtc_to_output[crtc];
+  handle->crtc = (uint64_t)(screen_data->crtcs[crtc]);
+  handle->connector = output_index == SIZE_MAX ? 0 : (uint64_t)(screen_data->outputs[output_index]);
+  return 0;
+}
+
+
 
 /**
  * Get the gamma ramp size of a CRTC.
@@ -646,7 +1010,7 @@ static int get_output_name(libgamma_crtc_information_t* restrict out, xcb_randr_
     return out->connector_name_error = LIBGAMMA_REPLY_VALUE_EXTRACTION_FAILED;
   
   /* Allocate a memory area for a NUL-terminated copy of the name. */
-  store = out->connector_name = malloc(((size_t)length + 1) * sizeof(char));
+  store = out->connector_name = libgamma_allocate_exported(((size_t)length + 1) * sizeof(char));
   if (store == NULL)
     return out->connector_name_error = errno, -1;
   
@@ -756,7 +1120,7 @@ static int get_edid(libgamma_crtc_information_t* restrict out,
       
       /* Store the EDID. */
       out->edid_length = (size_t)length;
-      out->edid = malloc((size_t)length * sizeof(unsigned char));
+      out->edid = libgamma_allocate_exported((size_t)length * sizeof(unsigned char));
       if (out->edid == NULL)
 	out->edid_error = errno;
       else
@@ -881,13 +1245,13 @@ int libgamma_x_randr_get_crtc_information(libgamma_crtc_information_t* restrict
   /* Free the EDID after us. */
   if (free_edid)
     {
-      free(this->edid);
+      libgamma_deallocate_exported(this->edid);
       this->edid = NULL;
     }
   /* Free the output name after us. */
   if (free_name)
     {
-      free(this->connector_name);
+      libgamma_deallocate_exported(this->connector_name);
       this->connector_name = NULL;
     }
   
@@ -945,6 +1309,86 @@ int libgamma_x_randr_crtc_get_gamma_ramps16(libgamma_crtc_state_t* restrict this
 }
 
 
+/**
+ * Get the current gamma ramps for multiple CRTC:s on the same site, 16-bit gamma-depth version.
+ * 
+ * All requests are sent before any reply is waited for,
+ * so the whole batch costs one round trip to the X server
+ * rather than one round trip per CRTC.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to fill with the current values, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   errors  Output parameter for the return value of each CRTC, may be `NULL`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; this is the error of
+ *                  the first CRTC that failed.
+ */
+int libgamma_x_randr_crtc_get_gamma_ramps16_many(libgamma_crtc_state_t* restrict const* restrict crtcs,
+						 libgamma_gamma_ramps16_t* restrict ramps,
+						 size_t count, int* restrict errors)
+{
+  xcb_connection_t* restrict connection = crtcs[0]->partition->site->data;
+  xcb_randr_get_crtc_gamma_cookie_t cookies[BATCH_SIZE];
+  xcb_randr_get_crtc_gamma_reply_t* restrict reply;
+  xcb_generic_error_t* error;
+  int results[BATCH_SIZE];
+  size_t i, j, n;
+  int rc = 0;
+  
+  for (i = 0; i < count; i += n)
+    {
+      n = count - i < BATCH_SIZE ? count - i : BATCH_SIZE;
+      
+      /* Request current gamma ramps, without waiting for the X server. */
+      for (j = 0; j < n; j++)
+	{
+	  results[j] = 0;
+#ifdef DEBUG
+	  /* Gamma ramp sizes are identical but not fixed. */
+	  if ((ramps[i + j].red_size != ramps[i + j].green_size) ||
+	      (ramps[i + j].red_size != ramps[i + j].blue_size))
+	    {
+	      results[j] = LIBGAMMA_MIXED_GAMMA_RAMP_SIZE;
+	      continue;
+	    }
+#endif
+	  cookies[j] = xcb_randr_get_crtc_gamma(connection, *(xcb_randr_crtc_t*)(crtcs[i + j]->data));
+	}
+      
+      /* Collect the replies. Only the first one has to be waited for,
+	 the X server answers the requests in the order they were sent. */
+      for (j = 0; j < n; j++)
+	{
+	  libgamma_gamma_ramps16_t* restrict ramps_ = ramps + i + j;
+	  if (results[j] == 0)
+	    {
+	      reply = xcb_randr_get_crtc_gamma_reply(connection, cookies[j], &error);
+	      if (error != NULL)
+		{
+		  results[j] = translate_error(error->error_code, LIBGAMMA_GAMMA_RAMP_READ_FAILED, 0);
+		  free(error);
+		}
+	      else
+		{
+		  /* Copy over the gamma ramps to our memory. */
+		  memcpy(ramps_->red,   xcb_randr_get_crtc_gamma_red(reply),   ramps_->red_size   * sizeof(uint16_t));
+		  memcpy(ramps_->green, xcb_randr_get_crtc_gamma_green(reply), ramps_->green_size * sizeof(uint16_t));
+		  memcpy(ramps_->blue,  xcb_randr_get_crtc_gamma_blue(reply),  ramps_->blue_size  * sizeof(uint16_t));
+		  free(reply);
+		}
+	    }
+	  if (errors != NULL)
+	    errors[i + j] = results[j];
+	  if (results[j] && !rc)
+	    rc = results[j];
+	}
+    }
+  
+  return rc;
+}
+
+
 /**
  * Set the gamma ramps for a CRTC, 16-bit gamma-depth version.
  * 
@@ -976,6 +1420,130 @@ int libgamma_x_randr_crtc_set_gamma_ramps16(libgamma_crtc_state_t* restrict this
 }
 
 
+/**
+ * Set the gamma ramps for multiple CRTC:s on the same site, 16-bit gamma-depth version.
+ * 
+ * All requests are sent before any errors are collected,
+ * so the whole batch costs one round trip to the X server
+ * rather than one round trip per CRTC.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to apply, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   grab    Whether to grab the X server while the requests are sent,
+ *                  so that no other client's requests are processed in between.
+ * @param   errors  Output parameter for the return value of each CRTC, may be `NULL`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; this is the error of
+ *                  the first CRTC that failed.
+ */
+static int set_gamma_ramps16_many(libgamma_crtc_state_t* restrict const* restrict crtcs,
+				  const libgamma_gamma_ramps16_t* restrict ramps,
+				  size_t count, int grab, int* restrict errors)
+{
+  xcb_connection_t* restrict connection = crtcs[0]->partition->site->data;
+  xcb_void_cookie_t cookies[BATCH_SIZE];
+  int results[BATCH_SIZE];
+  xcb_generic_error_t* restrict error;
+  size_t i, j, n;
+  int rc = 0;
+  
+  if (grab)
+    xcb_grab_server(connection);
+  
+  for (i = 0; i < count; i += n)
+    {
+      n = count - i < BATCH_SIZE ? count - i : BATCH_SIZE;
+      
+      /* Apply gamma ramps, without waiting for the X server. */
+      for (j = 0; j < n; j++)
+	{
+	  const libgamma_gamma_ramps16_t* restrict ramps_ = ramps + i + j;
+	  results[j] = 0;
+#ifdef DEBUG
+	  /* Gamma ramp sizes are identical but not fixed. */
+	  if ((ramps_->red_size != ramps_->green_size) ||
+	      (ramps_->red_size != ramps_->blue_size))
+	    {
+	      results[j] = LIBGAMMA_MIXED_GAMMA_RAMP_SIZE;
+	      continue;
+	    }
+#endif
+	  cookies[j] = xcb_randr_set_crtc_gamma_checked(connection, *(xcb_randr_crtc_t*)(crtcs[i + j]->data),
+							(uint16_t)(ramps_->red_size), ramps_->red, ramps_->green, ramps_->blue);
+	}
+      
+      /* Let other clients in as soon as all requests have been sent. */
+      if (grab && (i + n == count))
+	xcb_ungrab_server(connection);
+      
+      /* Check for errors. Checking the first request waits for the X server
+	 to process all of them, the rest are then answered without asking it. */
+      for (j = 0; j < n; j++)
+	{
+	  if ((results[j] == 0) && ((error = xcb_request_check(connection, cookies[j])) != NULL))
+	    {
+	      results[j] = translate_error(error->error_code, LIBGAMMA_GAMMA_RAMP_WRITE_FAILED, 0);
+	      free(error);
+	    }
+	  if (errors != NULL)
+	    errors[i + j] = results[j];
+	  if (results[j] && !rc)
+	    rc = results[j];
+	}
+    }
+  
+  return rc;
+}
+
+
+/**
+ * Set the gamma ramps for multiple CRTC:s on the same site, 16-bit gamma-depth version.
+ * 
+ * All requests are sent before any errors are collected,
+ * so the whole batch costs one round trip to the X server
+ * rather than one round trip per CRTC.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to apply, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   errors  Output parameter for the return value of each CRTC, may be `NULL`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; this is the error of
+ *                  the first CRTC that failed.
+ */
+int libgamma_x_randr_crtc_set_gamma_ramps16_many(libgamma_crtc_state_t* restrict const* restrict crtcs,
+						 const libgamma_gamma_ramps16_t* restrict ramps,
+						 size_t count, int* restrict errors)
+{
+  return set_gamma_ramps16_many(crtcs, ramps, count, 0, errors);
+}
+
+
+/**
+ * Apply gamma ramps to multiple CRTC:s as one transaction, 16-bit gamma-depth version.
+ * 
+ * RandR cannot apply the gamma ramps of multiple CRTC:s in one update,
+ * but all requests are sent before any errors are collected, inside
+ * a grab of the X server if `LIBGAMMA_TRANSACTION_GRAB_SERVER` is used.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to apply, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   flags   The transaction's flags, a combination of `LIBGAMMA_TRANSACTION_*`.
+ * @param   errors  Output parameter for the return value of each CRTC, may be `NULL`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; this is the error of
+ *                  the first CRTC that failed.
+ */
+int libgamma_x_randr_crtc_commit_gamma_ramps16(libgamma_crtc_state_t* restrict const* restrict crtcs,
+					       const libgamma_gamma_ramps16_t* restrict ramps,
+					       size_t count, int flags, int* restrict errors)
+{
+  return set_gamma_ramps16_many(crtcs, ramps, count, flags & LIBGAMMA_TRANSACTION_GRAB_SERVER, errors);
+}
+
+
 #ifdef __GCC__
 # pragma GCC diagnostic pop
 #endif
@@ -65,6 +65,40 @@ void libgamma_x_randr_site_destroy(libgamma_site_state_t* restrict this);
  */
 int libgamma_x_randr_site_restore(libgamma_site_state_t* restrict this);
 
+/**
+ * Subscribe to changes to the screens, CRTC:s and outputs of
+ * all screens, and get the file descriptor of the connection to
+ * the display server, which is readable when there are events.
+ * Events that other requests have read into the connection's queue
+ * do not make it readable, so `libgamma_x_randr_site_process_events`
+ * must be called before each time it is polled.
+ * 
+ * @param   this  The site state.
+ * @return        The file descriptor, otherwise (negative) the value
+ *                of an error identifier provided by this library.
+ */
+int libgamma_x_randr_site_event_fd(libgamma_site_state_t* restrict this);
+
+/**
+ * Process all pending RandR events, update the data of the partitions
+ * they are for, incrementally when an output has changed, and refresh
+ * the partitions whose CRTC:s or outputs are no longer known.
+ * 
+ * @param   this        The site state.
+ * @param   partitions  The partition states that may be updated.
+ * @param   count       The number of elements in `partitions` and `results`.
+ * @param   results     For each partition state, set to 1 if it was updated,
+ *                      or (negative) the value of an error identifier provided by
+ *                      this library if it could not be refreshed, left as zero
+ *                      if the partition has not changed.
+ * @return              The number of partition states that have changed, otherwise
+ *                      (negative) the value of an error identifier provided by this
+ *                      library, if the events could not be read.
+ */
+int libgamma_x_randr_site_process_events(libgamma_site_state_t* restrict this,
+					 libgamma_partition_state_t* restrict partitions, size_t count,
+					 int* restrict results);
+
 
 /**
  * Initialise an allocated partition state.
@@ -78,6 +112,22 @@ int libgamma_x_randr_site_restore(libgamma_site_state_t* restrict this);
 int libgamma_x_randr_partition_initialise(libgamma_partition_state_t* restrict this,
 					  libgamma_site_state_t* restrict site, size_t partition);
 
+/**
+ * Initialise the allocated partition states of all partitions on a site.
+ * The current resources of all screens are requested before we wait
+ * for any of them, so that it costs one round trip rather than one
+ * per screen.
+ * 
+ * @param   partitions  The partition states to initialise, `site->partitions_available`
+ *                      elements, their `site` and `partition` have been set.
+ * @param   site        The site state for the site that the partitions belongs to.
+ * @return              Zero on success, otherwise (negative) the value of an error
+ *                      identifier provided by this library, in which case none of
+ *                      the partition states are left initialised.
+ */
+int libgamma_x_randr_partition_initialise_all(libgamma_partition_state_t* restrict partitions,
+					      libgamma_site_state_t* restrict site);
+
 /**
  * Release all resources held by a partition state.
  * 
@@ -94,6 +144,16 @@ void libgamma_x_randr_partition_destroy(libgamma_partition_state_t* restrict thi
  */
 int libgamma_x_randr_partition_restore(libgamma_partition_state_t* restrict this);
 
+/**
+ * Refresh a partition state, so that it reflects the current CRTC:s
+ * and outputs of the screen, by reading the screen's resources anew.
+ * 
+ * @param   this  The partition state.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library.
+ */
+int libgamma_x_randr_partition_refresh(libgamma_partition_state_t* restrict this);
+
 
 /**
  * Initialise an allocated CRTC state.
@@ -123,6 +183,18 @@ void libgamma_x_randr_crtc_destroy(libgamma_crtc_state_t* restrict this) __attri
  */
 int libgamma_x_randr_crtc_restore(libgamma_crtc_state_t* restrict this);
 
+/**
+ * Get the handle for a CRTC.
+ * 
+ * @param   partition  The partition state for the partition that the CRTC belongs to.
+ * @param   crtc       The index of the CRTC within the partition.
+ * @param   handle     Output parameter for the CRTC's handle.
+ * @return             Zero on success, otherwise (negative) the value of an
+ *                     error identifier provided by this library.
+ */
+int libgamma_x_randr_crtc_handle(libgamma_partition_state_t* restrict partition, size_t crtc,
+				 libgamma_crtc_handle_t* restrict handle);
+
 
 /**
  * Read information about a CRTC.
@@ -157,6 +229,64 @@ int libgamma_x_randr_crtc_get_gamma_ramps16(libgamma_crtc_state_t* restrict this
 int libgamma_x_randr_crtc_set_gamma_ramps16(libgamma_crtc_state_t* restrict this,
 					    libgamma_gamma_ramps16_t ramps);
 
+/**
+ * Get the current gamma ramps for multiple CRTC:s on the same site, 16-bit gamma-depth version.
+ * 
+ * All requests are sent before any reply is waited for,
+ * so the whole batch costs one round trip to the X server
+ * rather than one round trip per CRTC.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to fill with the current values, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   errors  Output parameter for the return value of each CRTC, may be `NULL`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; this is the error of
+ *                  the first CRTC that failed.
+ */
+int libgamma_x_randr_crtc_get_gamma_ramps16_many(libgamma_crtc_state_t* restrict const* restrict crtcs,
+						 libgamma_gamma_ramps16_t* restrict ramps,
+						 size_t count, int* restrict errors);
+
+/**
+ * Set the gamma ramps for multiple CRTC:s on the same site, 16-bit gamma-depth version.
+ * 
+ * All requests are sent before any errors are collected,
+ * so the whole batch costs one round trip to the X server
+ * rather than one round trip per CRTC.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to apply, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   errors  Output parameter for the return value of each CRTC, may be `NULL`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; this is the error of
+ *                  the first CRTC that failed.
+ */
+int libgamma_x_randr_crtc_set_gamma_ramps16_many(libgamma_crtc_state_t* restrict const* restrict crtcs,
+						 const libgamma_gamma_ramps16_t* restrict ramps,
+						 size_t count, int* restrict errors);
+
+/**
+ * Apply gamma ramps to multiple CRTC:s as one transaction, 16-bit gamma-depth version.
+ * 
+ * RandR cannot apply the gamma ramps of multiple CRTC:s in one update,
+ * but all requests are sent before any errors are collected, inside
+ * a grab of the X server if `LIBGAMMA_TRANSACTION_GRAB_SERVER` is used.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to apply, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   flags   The transaction's flags, a combination of `LIBGAMMA_TRANSACTION_*`.
+ * @param   errors  Output parameter for the return value of each CRTC, may be `NULL`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; this is the error of
+ *                  the first CRTC that failed.
+ */
+int libgamma_x_randr_crtc_commit_gamma_ramps16(libgamma_crtc_state_t* restrict const* restrict crtcs,
+					       const libgamma_gamma_ramps16_t* restrict ramps,
+					       size_t count, int flags, int* restrict errors);
+
 
 #endif
 
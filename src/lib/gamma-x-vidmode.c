@@ -62,6 +62,8 @@ void libgamma_x_vidmode_method_capabilities(libgamma_method_capabilities_t* rest
   this->fake = 0;
   /* Gamma ramp adjustments are persistent. */
   this->auto_restore = 0;
+  /* Gamma ramps are applied one CRTC at a time. */
+  this->atomic_transactions = 0;
 }
 
 
@@ -310,3 +312,51 @@ int libgamma_x_vidmode_crtc_set_gamma_ramps16(libgamma_crtc_state_t* restrict th
   return 0;
 }
 
+
+/**
+ * Set the gamma ramps for multiple CRTC:s on the same site, 16-bit gamma-depth version.
+ * 
+ * All requests are queued before the X server is
+ * synchronised with, once for the whole batch.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to apply, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   errors  Output parameter for the return value of each CRTC, may be `NULL`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; this is the error of
+ *                  the first CRTC that failed.
+ */
+int libgamma_x_vidmode_crtc_set_gamma_ramps16_many(libgamma_crtc_state_t* restrict const* restrict crtcs,
+						   const libgamma_gamma_ramps16_t* restrict ramps,
+						   size_t count, int* restrict errors)
+{
+  Display* restrict display = crtcs[0]->partition->site->data;
+  size_t i;
+  int r, rc = 0;
+  
+  /* Apply gamma ramps, Xlib sends the requests together. */
+  for (i = 0; i < count; i++)
+    {
+      r = 0;
+#ifdef DEBUG
+      /* Gamma ramp sizes are identical but not fixed. */
+      if ((ramps[i].red_size != ramps[i].green_size) ||
+	  (ramps[i].red_size != ramps[i].blue_size))
+	r = LIBGAMMA_MIXED_GAMMA_RAMP_SIZE;
+      else
+#endif
+      if (!XF86VidModeSetGammaRamp(display, (int)(crtcs[i]->partition->partition), (int)(ramps[i].red_size),
+				   ramps[i].red, ramps[i].green, ramps[i].blue))
+	r = LIBGAMMA_GAMMA_RAMP_WRITE_FAILED;
+      if (errors != NULL)
+	errors[i] = r;
+      if (r && !rc)
+	rc = r;
+    }
+  
+  /* Wait, once, for the X server to apply all of them. */
+  XSync(display, False);
+  return rc;
+}
+
@@ -157,6 +157,24 @@ int libgamma_x_vidmode_crtc_get_gamma_ramps16(libgamma_crtc_state_t* restrict th
 int libgamma_x_vidmode_crtc_set_gamma_ramps16(libgamma_crtc_state_t* restrict this,
 					      libgamma_gamma_ramps16_t ramps);
 
+/**
+ * Set the gamma ramps for multiple CRTC:s on the same site, 16-bit gamma-depth version.
+ * 
+ * All requests are queued before the X server is
+ * synchronised with, once for the whole batch.
+ * 
+ * @param   crtcs   The CRTC states, all of them must belong to the same site.
+ * @param   ramps   The gamma ramps to apply, one for each CRTC.
+ * @param   count   The number of elements in `crtcs` and `ramps`, at least 1.
+ * @param   errors  Output parameter for the return value of each CRTC, may be `NULL`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; this is the error of
+ *                  the first CRTC that failed.
+ */
+int libgamma_x_vidmode_crtc_set_gamma_ramps16_many(libgamma_crtc_state_t* restrict const* restrict crtcs,
+						   const libgamma_gamma_ramps16_t* restrict ramps,
+						   size_t count, int* restrict errors);
+
 
 #endif
 
@@ -83,11 +83,200 @@ typedef float libgamma_gamma_rampsf_fun(float encoding);
  */
 typedef double libgamma_gamma_rampsd_fun(double encoding);
 
+/**
+ * Mapping function from [0, 1] float encoding value to [0, 1] float output
+ * value, for half precision floating point gamma ramps. The output is
+ * converted to half precision floating point by the library.
+ * 
+ * @param   encoding  [0, 1] float encoding value.
+ * @return            [0, 1] float output value.
+ */
+typedef float libgamma_gamma_rampsh_fun(float encoding);
+
+/**
+ * Mapping function from [0, 1] float encoding values to
+ * [0, 2⁸ − 1] integer output values, for an entire channel at a time.
+ * 
+ * @param  output     Output array for the output values.
+ * @param  encodings  The encoding values, evenly spaced over [0, 1].
+ * @param  n          The number of elements in `output` and `encodings`.
+ */
+typedef void libgamma_gamma_ramps8_batch_fun(uint8_t* restrict output, const float* restrict encodings, size_t n);
+
+/**
+ * Mapping function from [0, 1] float encoding values to
+ * [0, 2¹⁶ − 1] integer output values, for an entire channel at a time.
+ * 
+ * @param  output     Output array for the output values.
+ * @param  encodings  The encoding values, evenly spaced over [0, 1].
+ * @param  n          The number of elements in `output` and `encodings`.
+ */
+typedef void libgamma_gamma_ramps16_batch_fun(uint16_t* restrict output, const float* restrict encodings, size_t n);
+
+/**
+ * Mapping function from [0, 1] float encoding values to
+ * [0, 2³² − 1] integer output values, for an entire channel at a time.
+ * 
+ * @param  output     Output array for the output values.
+ * @param  encodings  The encoding values, evenly spaced over [0, 1].
+ * @param  n          The number of elements in `output` and `encodings`.
+ */
+typedef void libgamma_gamma_ramps32_batch_fun(uint32_t* restrict output, const float* restrict encodings, size_t n);
+
+/**
+ * Mapping function from [0, 1] float encoding values to
+ * [0, 2⁶⁴ − 1] integer output values, for an entire channel at a time.
+ * 
+ * @param  output     Output array for the output values.
+ * @param  encodings  The encoding values, evenly spaced over [0, 1].
+ * @param  n          The number of elements in `output` and `encodings`.
+ */
+typedef void libgamma_gamma_ramps64_batch_fun(uint64_t* restrict output, const float* restrict encodings, size_t n);
+
+/**
+ * Mapping function from [0, 1] float encoding values to
+ * [0, 1] float output values, for an entire channel at a time.
+ * 
+ * @param  output     Output array for the output values.
+ * @param  encodings  The encoding values, evenly spaced over [0, 1].
+ * @param  n          The number of elements in `output` and `encodings`.
+ */
+typedef void libgamma_gamma_rampsf_batch_fun(float* restrict output, const float* restrict encodings, size_t n);
+
+/**
+ * Mapping function from [0, 1] double precision float encoding values to
+ * [0, 1] double precision float output values, for an entire channel at a time.
+ * 
+ * @param  output     Output array for the output values.
+ * @param  encodings  The encoding values, evenly spaced over [0, 1].
+ * @param  n          The number of elements in `output` and `encodings`.
+ */
+typedef void libgamma_gamma_rampsd_batch_fun(double* restrict output, const double* restrict encodings, size_t n);
+
+/**
+ * Mapping function from [0, 1] float encoding values to
+ * [0, 1] float output values, for an entire channel at a time. The output values are converted to half
+ * precision floating point by the library.
+ * 
+ * @param  output     Output array for the output values.
+ * @param  encodings  The encoding values, evenly spaced over [0, 1].
+ * @param  n          The number of elements in `output` and `encodings`.
+ */
+typedef void libgamma_gamma_rampsh_batch_fun(float* restrict output, const float* restrict encodings, size_t n);
+
+/**
+ * Mapping function from [0, 1] float encoding values to
+ * [0, 2⁸ − 1] integer output values, for all channels at once.
+ * 
+ * The encoding value arrays have the same size as the corresponding
+ * channels in `ramps`, channels of the same size may share the array.
+ * 
+ * @param  ramps            The gamma ramps to fill, the sizes are set.
+ * @param  red_encodings    The encoding values for the red channel, evenly spaced over [0, 1].
+ * @param  green_encodings  The encoding values for the green channel, evenly spaced over [0, 1].
+ * @param  blue_encodings   The encoding values for the blue channel, evenly spaced over [0, 1].
+ */
+typedef void libgamma_gamma_ramps8_rgb_fun(libgamma_gamma_ramps8_t* restrict ramps, const float* red_encodings,
+					   const float* green_encodings, const float* blue_encodings);
+
+/**
+ * Mapping function from [0, 1] float encoding values to
+ * [0, 2¹⁶ − 1] integer output values, for all channels at once.
+ * 
+ * The encoding value arrays have the same size as the corresponding
+ * channels in `ramps`, channels of the same size may share the array.
+ * 
+ * @param  ramps            The gamma ramps to fill, the sizes are set.
+ * @param  red_encodings    The encoding values for the red channel, evenly spaced over [0, 1].
+ * @param  green_encodings  The encoding values for the green channel, evenly spaced over [0, 1].
+ * @param  blue_encodings   The encoding values for the blue channel, evenly spaced over [0, 1].
+ */
+typedef void libgamma_gamma_ramps16_rgb_fun(libgamma_gamma_ramps16_t* restrict ramps, const float* red_encodings,
+					    const float* green_encodings, const float* blue_encodings);
+
+/**
+ * Mapping function from [0, 1] float encoding values to
+ * [0, 2³² − 1] integer output values, for all channels at once.
+ * 
+ * The encoding value arrays have the same size as the corresponding
+ * channels in `ramps`, channels of the same size may share the array.
+ * 
+ * @param  ramps            The gamma ramps to fill, the sizes are set.
+ * @param  red_encodings    The encoding values for the red channel, evenly spaced over [0, 1].
+ * @param  green_encodings  The encoding values for the green channel, evenly spaced over [0, 1].
+ * @param  blue_encodings   The encoding values for the blue channel, evenly spaced over [0, 1].
+ */
+typedef void libgamma_gamma_ramps32_rgb_fun(libgamma_gamma_ramps32_t* restrict ramps, const float* red_encodings,
+					    const float* green_encodings, const float* blue_encodings);
+
+/**
+ * Mapping function from [0, 1] float encoding values to
+ * [0, 2⁶⁴ − 1] integer output values, for all channels at once.
+ * 
+ * The encoding value arrays have the same size as the corresponding
+ * channels in `ramps`, channels of the same size may share the array.
+ * 
+ * @param  ramps            The gamma ramps to fill, the sizes are set.
+ * @param  red_encodings    The encoding values for the red channel, evenly spaced over [0, 1].
+ * @param  green_encodings  The encoding values for the green channel, evenly spaced over [0, 1].
+ * @param  blue_encodings   The encoding values for the blue channel, evenly spaced over [0, 1].
+ */
+typedef void libgamma_gamma_ramps64_rgb_fun(libgamma_gamma_ramps64_t* restrict ramps, const float* red_encodings,
+					    const float* green_encodings, const float* blue_encodings);
+
+/**
+ * Mapping function from [0, 1] float encoding values to
+ * [0, 1] float output values, for all channels at once.
+ * 
+ * The encoding value arrays have the same size as the corresponding
+ * channels in `ramps`, channels of the same size may share the array.
+ * 
+ * @param  ramps            The gamma ramps to fill, the sizes are set.
+ * @param  red_encodings    The encoding values for the red channel, evenly spaced over [0, 1].
+ * @param  green_encodings  The encoding values for the green channel, evenly spaced over [0, 1].
+ * @param  blue_encodings   The encoding values for the blue channel, evenly spaced over [0, 1].
+ */
+typedef void libgamma_gamma_rampsf_rgb_fun(libgamma_gamma_rampsf_t* restrict ramps, const float* red_encodings,
+					   const float* green_encodings, const float* blue_encodings);
+
+/**
+ * Mapping function from [0, 1] double precision float encoding values to
+ * [0, 1] double precision float output values, for all channels at once.
+ * 
+ * The encoding value arrays have the same size as the corresponding
+ * channels in `ramps`, channels of the same size may share the array.
+ * 
+ * @param  ramps            The gamma ramps to fill, the sizes are set.
+ * @param  red_encodings    The encoding values for the red channel, evenly spaced over [0, 1].
+ * @param  green_encodings  The encoding values for the green channel, evenly spaced over [0, 1].
+ * @param  blue_encodings   The encoding values for the blue channel, evenly spaced over [0, 1].
+ */
+typedef void libgamma_gamma_rampsd_rgb_fun(libgamma_gamma_rampsd_t* restrict ramps, const double* red_encodings,
+					   const double* green_encodings, const double* blue_encodings);
+
+/**
+ * Mapping function from [0, 1] float encoding values to
+ * [0, 1] float output values, for all channels at once. The output values are converted to half
+ * precision floating point by the library.
+ * 
+ * The encoding value arrays have the same size as the corresponding
+ * channels in `ramps`, channels of the same size may share the array.
+ * 
+ * @param  ramps            The gamma ramps to fill, the sizes are set.
+ * @param  red_encodings    The encoding values for the red channel, evenly spaced over [0, 1].
+ * @param  green_encodings  The encoding values for the green channel, evenly spaced over [0, 1].
+ * @param  blue_encodings   The encoding values for the blue channel, evenly spaced over [0, 1].
+ */
+typedef void libgamma_gamma_rampsh_rgb_fun(libgamma_gamma_rampsf_t* restrict ramps, const float* red_encodings,
+					   const float* green_encodings, const float* blue_encodings);
+
 
 
 /**
  * List available adjustment methods by their order of preference based on the environment.
  * 
+ * The lists are cached until `libgamma_methods_invalidate` is called.
+ * 
  * @param  methods    Output array of methods, should be able to hold `LIBGAMMA_METHOD_COUNT` elements.
  * @param  buf_size   The number of elements that fits in `methods`, it should be `LIBGAMMA_METHOD_COUNT`,
  *                    This is used to avoid writing outside the output buffer if this library adds new
@@ -116,11 +305,24 @@ int libgamma_is_method_available(int method) __attribute__((const));
 /**
  * Return the capabilities of an adjustment method.
  * 
+ * The capabilities are cached until `libgamma_methods_invalidate` is called.
+ * 
  * @param  this    The data structure to fill with the method's capabilities
  * @param  method  The adjustment method (display server and protocol).
  */
 void libgamma_method_capabilities(libgamma_method_capabilities_t* restrict this, int method);
 
+/**
+ * Discard the cached results of `libgamma_method_capabilities`
+ * and `libgamma_list_methods`, so that they are read from the
+ * adjustment methods and the environment the next time. This
+ * should be done when the environment has changed, for example
+ * when the process has changed `DISPLAY` or its controlling TTY.
+ * Adjustment methods whose plugins could not be loaded are
+ * also looked for again.
+ */
+void libgamma_methods_invalidate(void);
+
 /**
  * Return the default site for an adjustment method.
  * 
@@ -185,6 +387,77 @@ void libgamma_site_free(libgamma_site_state_t* restrict this);
  */
 int libgamma_site_restore(libgamma_site_state_t* restrict this);
 
+/**
+ * Discard the information that the CRTC states on a site have
+ * cached, so that it is read from the adjustment method the
+ * next time it is requested. This should be done when the
+ * CRTC:s on the site may have changed.
+ * 
+ * @param  this  The site state.
+ */
+void libgamma_site_invalidate(libgamma_site_state_t* restrict this);
+
+/**
+ * Start listening for changes to the display configuration, such as
+ * monitors being connected or disconnected, if not already listening,
+ * and get a file descriptor that can be polled for readability, which
+ * indicates that `libgamma_site_process_events` should be called.
+ * 
+ * With X RandR, the file descriptor is that of the connection to the
+ * display server, and other requests on the connection can read events
+ * into the connection's queue, where they do not make the file descriptor
+ * readable. Therefore, `libgamma_site_process_events`, which does not
+ * block, must be called before each time the file descriptor is polled.
+ * 
+ * @param   this  The site state.
+ * @return        The file descriptor, otherwise (negative) the value of an
+ *                error identifier provided by this library. `LIBGAMMA_ERRNO_SET`
+ *                with `errno` set to `ENOTSUP` if the adjustment method
+ *                cannot report changes to the display configuration.
+ */
+int libgamma_site_event_fd(libgamma_site_state_t* restrict this);
+
+/**
+ * Replace the source of the events that `libgamma_site_process_events`
+ * reads. The events must be in the adjustment method's own format, for
+ * Linux DRM that is kernel uevents, one per datagram. This lets you inject
+ * synthetic events, for example over one end of a `socketpair`, for testing.
+ * 
+ * @param   this  The site state.
+ * @param   fd    The new source of events, it will be closed by the library.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library. `LIBGAMMA_ERRNO_SET`
+ *                with `errno` set to `ENOTSUP` if the adjustment method
+ *                does not support this.
+ */
+int libgamma_site_set_event_fd(libgamma_site_state_t* restrict this, int fd);
+
+/**
+ * Process all pending changes to the display configuration, without
+ * blocking, and refresh the partition states for the partitions that
+ * have changed, as with `libgamma_partition_refresh`. Afterwards,
+ * `libgamma_crtc_refresh` must be called for the CRTC states of
+ * each refreshed partition before they are used again. Partitions
+ * that have not changed are left untouched.
+ * 
+ * @param   this        The site state, `libgamma_site_event_fd`
+ *                      must have been called for it.
+ * @param   partitions  The partition states, on the site, that may be refreshed,
+ *                      for example the `partitions` of a `libgamma_topology_t`.
+ * @param   count       The number of elements in `partitions` and `results`.
+ * @param   results     For each partition state, set to 1 if it was refreshed,
+ *                      to zero if the partition has not changed, or to (negative)
+ *                      the value of an error identifier provided by this library
+ *                      if it could not be refreshed, `LIBGAMMA_GRAPHICS_CARD_REMOVED`
+ *                      if the partition has been removed.
+ * @return              The number of partition states that have changed, otherwise
+ *                      (negative) the value of an error identifier provided by
+ *                      this library, if the changes could not be read.
+ */
+int libgamma_site_process_events(libgamma_site_state_t* restrict this,
+				 libgamma_partition_state_t* restrict partitions, size_t count,
+				 int* restrict results);
+
 
 /**
  * Initialise an allocated partition state.
@@ -222,6 +495,51 @@ void libgamma_partition_free(libgamma_partition_state_t* restrict this);
  */
 int libgamma_partition_restore(libgamma_partition_state_t* restrict this);
 
+/**
+ * Refresh a partition state, so that it reflects the current CRTC:s
+ * of the partition, for example after a monitor has been connected
+ * or disconnected. The CRTC states for the partition must be refreshed
+ * with `libgamma_crtc_refresh` before they are used again. On success,
+ * the information cached in the CRTC states on the site is discarded,
+ * as with `libgamma_site_invalidate`.
+ * 
+ * @param   this  The partition state.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library. On failure,
+ *                the partition state is unchanged.
+ */
+int libgamma_partition_refresh(libgamma_partition_state_t* restrict this);
+
+/**
+ * Get the handle for a CRTC in a partition.
+ * 
+ * @param   this    The partition state.
+ * @param   crtc    The index of the CRTC within the partition.
+ * @param   handle  Output parameter for the CRTC's handle.
+ * @return          Zero on success, otherwise (negative) the value of an
+ *                  error identifier provided by this library.
+ */
+int libgamma_partition_get_crtc_handle(libgamma_partition_state_t* restrict this, size_t crtc,
+				       libgamma_crtc_handle_t* restrict handle);
+
+/**
+ * Find the CRTC in a partition that a handle identifies.
+ * 
+ * A CRTC that drives the same connector as the handle is preferred,
+ * so that a monitor keeps its CRTC state if the adjustment method
+ * moves it to another CRTC. Otherwise the CRTC with the same
+ * identifier as the handle is selected.
+ * 
+ * @param   this    The partition state.
+ * @param   handle  The CRTC's handle.
+ * @param   crtc    Output parameter for the index of the CRTC within the partition.
+ * @return          Zero on success, otherwise (negative) the value of an
+ *                  error identifier provided by this library,
+ *                  `LIBGAMMA_NO_SUCH_CRTC` if the CRTC does not exist.
+ */
+int libgamma_partition_find_crtc(libgamma_partition_state_t* restrict this,
+				 const libgamma_crtc_handle_t* restrict handle, size_t* restrict crtc);
+
 
 /**
  * Initialise an allocated CRTC state.
@@ -259,10 +577,40 @@ void libgamma_crtc_free(libgamma_crtc_state_t* restrict this);
  */
 int libgamma_crtc_restore(libgamma_crtc_state_t* restrict this);
 
+/**
+ * Get the handle for a CRTC. The handle identifies the CRTC by the
+ * adjustment method's own identifiers, so unlike the CRTC's index, it
+ * can be used to find the CRTC again after its partition has been
+ * refreshed with `libgamma_partition_refresh`.
+ * 
+ * @param  this    The CRTC state.
+ * @param  handle  Output parameter for the CRTC's handle.
+ */
+void libgamma_crtc_get_handle(const libgamma_crtc_state_t* restrict this, libgamma_crtc_handle_t* restrict handle);
+
+/**
+ * Update a CRTC state after its partition has been refreshed with
+ * `libgamma_partition_refresh`, so that it refers to the same CRTC,
+ * which may have a new index, as before. The CRTC state's kept
+ * temporary gamma ramps and resampling mode are kept.
+ * 
+ * @param   this  The CRTC state.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library,
+ *                `LIBGAMMA_NO_SUCH_CRTC` if the CRTC has been removed.
+ *                On failure, the CRTC state is unchanged.
+ */
+int libgamma_crtc_refresh(libgamma_crtc_state_t* restrict this);
+
 
 /**
  * Read information about a CRTC.
  * 
+ * The gamma ramp sizes and the gamma ramp depth are cached in
+ * the CRTC state, and are only read from the adjustment method
+ * the first time they are requested, after `libgamma_site_invalidate`,
+ * and when `LIBGAMMA_CRTC_INFO_REFRESH` is included in `fields`.
+ * 
  * @param   this    Instance of a data structure to fill with the information about the CRTC.
  * @param   crtc    The state of the CRTC whose information should be read.
  * @param   fields  OR:ed identifiers for the information about the CRTC that should be read.
@@ -286,6 +634,63 @@ void libgamma_crtc_information_destroy(libgamma_crtc_information_t* restrict thi
  */
 void libgamma_crtc_information_free(libgamma_crtc_information_t* restrict this);
 
+
+/**
+ * Enumerate all partitions and CRTC:s on a site.
+ * 
+ * The partition states and the CRTC states are initialised, and the
+ * information about the CRTC:s is read, as if `libgamma_partition_initialise`,
+ * `libgamma_crtc_initialise` and `libgamma_get_crtc_information` had
+ * been called for each of them, but they are all stored in one allocation,
+ * and the adjustment method can batch its queries to the display server.
+ * 
+ * @param   topology  Output parameter for the topology, release it with
+ *                    `libgamma_topology_free`, it is set to `NULL` on error.
+ * @param   site      The site state, it must not be destroyed before the
+ *                    topology is released.
+ * @param   fields    OR:ed identifiers for the information about the CRTC:s
+ *                    that should be read, zero if none should be read.
+ * @return            Zero on success, otherwise (negative) the value of an
+ *                    error identifier provided by this library. Errors when
+ *                    reading the information about the CRTC:s are not
+ *                    reported here, refer to the error reports in
+ *                    `(*topology)->crtc_information`.
+ */
+int libgamma_site_enumerate(libgamma_topology_t** restrict topology,
+			    libgamma_site_state_t* restrict site, int32_t fields);
+
+/**
+ * Release a topology that has been created by `libgamma_site_enumerate`,
+ * and all states and information in it. The site state is not destroyed.
+ * 
+ * @param  this  The topology, may be `NULL`.
+ */
+void libgamma_topology_free(libgamma_topology_t* restrict this);
+
+/**
+ * Compare two topologies of the same site, as enumerated by
+ * `libgamma_site_enumerate`, and list the CRTC:s that have changed.
+ * 
+ * CRTC:s are matched by their handles, and compared by the identifiers of
+ * their connectors, the gamma ramp sizes and depths cached in the CRTC
+ * states, and hashes of their EDID:s. CRTC:s that have not changed are
+ * not listed, so after a change to the display configuration, gamma ramps
+ * only need to be reapplied to the CRTC:s that are listed.
+ * 
+ * @param   changes       Output array for the changes, it must have room for
+ *                        `old_topology->crtc_count + new_topology->crtc_count`
+ *                        elements. The changed and added CRTC:s are listed in
+ *                        the order of the new topology, followed by the
+ *                        removed CRTC:s in the order of the old topology.
+ * @param   old_topology  The old topology.
+ * @param   new_topology  The new topology.
+ * @return                The number of elements stored in `changes`,
+ *                        zero if the topologies are equivalent.
+ */
+size_t libgamma_topology_diff(libgamma_topology_change_t* restrict changes,
+			      const libgamma_topology_t* restrict old_topology,
+			      const libgamma_topology_t* restrict new_topology);
+
 /**
  * Convert a raw representation of an EDID to a lowercase hexadecimal representation.
  * 
@@ -466,6 +871,253 @@ int libgamma_crtc_set_gamma_rampsd(libgamma_crtc_state_t* restrict this,
 				   libgamma_gamma_rampsd_t ramps);
 
 
+/**
+ * Get the current gamma ramps for a CRTC, half precision floating point version.
+ * 
+ * @param   this   The CRTC state.
+ * @param   ramps  The gamma ramps to fill with the current values.
+ * @return         Zero on success, otherwise (negative) the value of an
+ *                 error identifier provided by this library.
+ */
+int libgamma_crtc_get_gamma_rampsh(libgamma_crtc_state_t* restrict this,
+				   libgamma_gamma_rampsh_t* restrict ramps);
+
+/**
+ * Set the gamma ramps for a CRTC, half precision floating point version.
+ * 
+ * @param   this   The CRTC state.
+ * @param   ramps  The gamma ramps to apply.
+ * @return         Zero on success, otherwise (negative) the value of an
+ *                 error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_rampsh(libgamma_crtc_state_t* restrict this,
+				   libgamma_gamma_rampsh_t ramps);
+
+
+/**
+ * Get the current gamma ramps for a CRTC, as reference-counted
+ * gamma ramps, for example to save them so they can be restored
+ * later, or to keep them in an undo history.
+ * 
+ * @param   this   The CRTC state.
+ * @param   depth  The depth of the gamma ramps to create, `-1` for
+ *                 `float`, `-2` for `double`, `-3` for half.
+ * @param   ramps  Output parameter for the gamma ramps, with one reference,
+ *                 that shall be removed with `libgamma_gamma_ramps_shared_unref`.
+ * @return         Zero on success, otherwise (negative) the value of an
+ *                 error identifier provided by this library.
+ */
+int libgamma_crtc_get_gamma_ramps_shared(libgamma_crtc_state_t* restrict this, signed depth,
+					 libgamma_gamma_ramps_shared_t** restrict ramps);
+
+
+/**
+ * Set the gamma ramps for a CRTC, from a view of gamma ramps.
+ * 
+ * The stops are read directly from the view, and converted
+ * to the adjustment method's depth in the same pass as they
+ * are packed into the adjustment method's layout. If
+ * `this->resample` says so, they are also resampled, which
+ * is done on `double`:s in a scratch buffer.
+ * 
+ * @param   this  The CRTC state.
+ * @param   view  The gamma ramps to apply.
+ * @return        Zero on success, otherwise (negative) the value of an
+ *                error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_ramps_view(libgamma_crtc_state_t* restrict this,
+				       const libgamma_gamma_ramps_view_t* restrict view);
+
+
+/**
+ * Translate gamma ramps, once and for all, into the format
+ * that a CRTC's adjustment method uses natively, so that
+ * they can be applied repeatedly with
+ * `libgamma_crtc_set_gamma_ramps_prepared`.
+ * 
+ * The gamma ramps are also resampled if `this->resample` is
+ * not `LIBGAMMA_RESAMPLE_NONE` and their sizes do not match
+ * the CRTC's.
+ * 
+ * @param   this      The CRTC state.
+ * @param   view      The gamma ramps to prepare.
+ * @param   prepared  Output parameter for the prepared gamma ramps, they
+ *                    shall be released with `libgamma_gamma_ramps_prepared_free`.
+ * @return            Zero on success, otherwise (negative) the value of an
+ *                    error identifier provided by this library.
+ */
+int libgamma_crtc_prepare_gamma_ramps(libgamma_crtc_state_t* restrict this,
+				      const libgamma_gamma_ramps_view_t* restrict view,
+				      libgamma_gamma_ramps_prepared_t** restrict prepared);
+
+/**
+ * Apply gamma ramps that have been prepared with
+ * `libgamma_crtc_prepare_gamma_ramps` to a CRTC.
+ * 
+ * The gamma ramps are passed directly to the adjustment
+ * method, they are neither translated nor resampled, and
+ * no memory is allocated. They can be applied to any CRTC
+ * that uses the same adjustment method, the same gamma ramp
+ * depth and the same gamma ramp sizes as the CRTC they were
+ * prepared for.
+ * 
+ * @param   this      The CRTC state.
+ * @param   prepared  The prepared gamma ramps.
+ * @return            Zero on success, otherwise (negative) the value of an
+ *                    error identifier provided by this library. If the
+ *                    gamma ramps were prepared for another adjustment method
+ *                    or another gamma ramp depth, `LIBGAMMA_ERRNO_SET` is
+ *                    returned and `errno` is set to `EINVAL`, and if they
+ *                    have other sizes than the CRTC's gamma ramps,
+ *                    `LIBGAMMA_WRONG_GAMMA_RAMP_SIZE` is returned.
+ */
+int libgamma_crtc_set_gamma_ramps_prepared(libgamma_crtc_state_t* restrict this,
+					   const libgamma_gamma_ramps_prepared_t* restrict prepared);
+
+/**
+ * Set the gamma ramps for multiple CRTC:s, from a view of gamma ramps.
+ * 
+ * The CRTC:s are grouped by adjustment method, gamma ramp
+ * sizes, gamma ramp depth and resampling mode, and the
+ * gamma ramps are translated only once for each group.
+ * If these properties cannot be determined for a CRTC,
+ * the gamma ramps are translated separately for that CRTC.
+ * 
+ * @param   crtcs   The CRTC states.
+ * @param   count   The number of elements in `crtcs`.
+ * @param   view    The gamma ramps to apply.
+ * @param   errors  Output parameter for the return value of each CRTC, as it would
+ *                  have been returned by `libgamma_crtc_set_gamma_ramps_view`, may
+ *                  be `NULL`. The values are stored in the same order as `crtcs`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; if applying the gamma
+ *                  ramps failed on some CRTC:s, this is the error of the first
+ *                  CRTC that failed, and the gamma ramps have still been
+ *                  applied to all other CRTC:s.
+ */
+int libgamma_crtc_set_gamma_ramps_view_many(libgamma_crtc_state_t* restrict const* restrict crtcs,
+					    size_t count, const libgamma_gamma_ramps_view_t* restrict view,
+					    int* restrict errors);
+
+/**
+ * Get the current gamma ramps for multiple CRTC:s, 16-bit gamma-depth version.
+ * 
+ * Consecutive CRTC:s on the same site are handed to the adjustment
+ * method together, if it can read gamma ramps from multiple CRTC:s
+ * more efficiently than one at a time, for example RandR sends all
+ * requests before it waits for the first reply. CRTC:s that
+ * resample their gamma ramps are read one at a time.
+ * 
+ * @param   crtcs   The CRTC states.
+ * @param   ramps   The gamma ramps to fill with the current values,
+ *                  `ramps[i]` is filled with the values for `crtcs[i]`.
+ * @param   count   The number of elements in `crtcs` and `ramps`.
+ * @param   errors  Output parameter for the return value of each CRTC, as it would
+ *                  have been returned by `libgamma_crtc_get_gamma_ramps16`, may
+ *                  be `NULL`. The values are stored in the same order as `crtcs`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; if reading the gamma
+ *                  ramps failed on some CRTC:s, this is the error of the first
+ *                  CRTC that failed, and the gamma ramps have still been
+ *                  read from all other CRTC:s.
+ */
+int libgamma_crtc_get_gamma_ramps16_many(libgamma_crtc_state_t* restrict const* restrict crtcs,
+					 libgamma_gamma_ramps16_t* restrict ramps,
+					 size_t count, int* restrict errors);
+
+/**
+ * Set the gamma ramps for multiple CRTC:s, 16-bit gamma-depth version.
+ * 
+ * Consecutive CRTC:s on the same site are handed to the adjustment
+ * method together, if it can apply gamma ramps to multiple CRTC:s
+ * more efficiently than one at a time, for example RandR waits for
+ * the X server only once rather than once per CRTC. CRTC:s that
+ * resample their gamma ramps are applied one at a time.
+ * 
+ * @param   crtcs   The CRTC states.
+ * @param   ramps   The gamma ramps to apply, `ramps[i]` is applied to `crtcs[i]`.
+ * @param   count   The number of elements in `crtcs` and `ramps`.
+ * @param   errors  Output parameter for the return value of each CRTC, as it would
+ *                  have been returned by `libgamma_crtc_set_gamma_ramps16`, may
+ *                  be `NULL`. The values are stored in the same order as `crtcs`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; if applying the gamma
+ *                  ramps failed on some CRTC:s, this is the error of the first
+ *                  CRTC that failed, and the gamma ramps have still been
+ *                  applied to all other CRTC:s.
+ */
+int libgamma_crtc_set_gamma_ramps16_many(libgamma_crtc_state_t* restrict const* restrict crtcs,
+					 const libgamma_gamma_ramps16_t* restrict ramps,
+					 size_t count, int* restrict errors);
+
+/**
+ * Start a transaction, in which gamma ramps for multiple CRTC:s are
+ * staged with `libgamma_gamma_transaction_stage16` and then applied
+ * together with `libgamma_gamma_transaction_commit`.
+ * 
+ * @param   transaction  Output parameter for the transaction, it shall be
+ *                       released with `libgamma_gamma_transaction_free`.
+ * @param   flags        A combination of `LIBGAMMA_TRANSACTION_ATOMIC` and
+ *                       `LIBGAMMA_TRANSACTION_GRAB_SERVER`, or zero.
+ * @return               Zero on success, otherwise (negative) the value of an
+ *                       error identifier provided by this library.
+ */
+int libgamma_gamma_transaction_begin(libgamma_gamma_transaction_t** restrict transaction, int flags);
+
+/**
+ * Stage gamma ramps for a CRTC in a transaction.
+ * 
+ * The gamma ramps are copied, and if the CRTC has already been
+ * staged its gamma ramps are replaced. A transaction can be
+ * committed any number of times, so a transaction that is
+ * restaged and committed repeatedly, for example for each frame
+ * of a transition, does not allocate any memory once each CRTC
+ * has been staged once. The gamma ramps are not resampled, they
+ * must have the sizes of the CRTC's gamma ramps.
+ * 
+ * @param   this   The transaction.
+ * @param   crtc   The CRTC state, it must be on the same site as all other CRTC:s
+ *                 in the transaction, and must not be destroyed before the
+ *                 transaction is released.
+ * @param   ramps  The gamma ramps to apply to the CRTC.
+ * @return         Zero on success, otherwise (negative) the value of an
+ *                 error identifier provided by this library.
+ */
+int libgamma_gamma_transaction_stage16(libgamma_gamma_transaction_t* restrict this,
+				       libgamma_crtc_state_t* restrict crtc, libgamma_gamma_ramps16_t ramps);
+
+/**
+ * Apply the gamma ramps that are staged in a transaction.
+ * 
+ * With the Linux DRM adjustment method, all CRTC:s on one graphics card
+ * are updated in one atomic commit of their `GAMMA_LUT` properties, with
+ * the dummy adjustment method all of them are updated at once, and with
+ * RandR the requests are pipelined, inside a grab of the X server if
+ * the transaction was started with `LIBGAMMA_TRANSACTION_GRAB_SERVER`.
+ * Other adjustment methods apply the gamma ramps one CRTC at a time.
+ * If the transaction was started with `LIBGAMMA_TRANSACTION_ATOMIC`,
+ * this function fails with `ENOTSUP`, without applying any gamma ramps,
+ * where the gamma ramps cannot be applied in one update.
+ * 
+ * @param   this    The transaction, it is not modified.
+ * @param   errors  Output parameter for the return value of each CRTC, in the order
+ *                  they were first staged, may be `NULL`.
+ * @return          Zero on success, otherwise (negative) the value of an error
+ *                  identifier provided by this library; if applying the gamma
+ *                  ramps failed on some CRTC:s, this is the error of the first
+ *                  CRTC that failed.
+ */
+int libgamma_gamma_transaction_commit(const libgamma_gamma_transaction_t* restrict this, int* restrict errors);
+
+/**
+ * Release a transaction that has been created
+ * by `libgamma_gamma_transaction_begin`.
+ * 
+ * @param  this  The transaction, may be `NULL`.
+ */
+void libgamma_gamma_transaction_free(libgamma_gamma_transaction_t* restrict this);
+
+
 /**
  * Set the gamma ramps for a CRTC, 8-bit gamma-depth function version.
  * 
@@ -568,6 +1220,316 @@ int libgamma_crtc_set_gamma_rampsd_f(libgamma_crtc_state_t* restrict this,
 				     libgamma_gamma_rampsd_fun* green_function,
 				     libgamma_gamma_rampsd_fun* blue_function) __attribute__((cold));
 
+/**
+ * Set the gamma ramps for a CRTC, half precision floating point function version.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this            The CRTC state.
+ * @param   red_function    The function that generates the gamma ramp for the red channel.
+ * @param   green_function  The function that generates the gamma ramp for the green channel.
+ * @param   blue_function   The function that generates the gamma ramp for the blue channel.
+ * @return                  Zero on success, otherwise (negative) the value of an
+ *                          error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_rampsh_f(libgamma_crtc_state_t* restrict this,
+				     libgamma_gamma_rampsh_fun* red_function,
+				     libgamma_gamma_rampsh_fun* green_function,
+				     libgamma_gamma_rampsh_fun* blue_function) __attribute__((cold));
+
+/**
+ * Set the gamma ramps for a CRTC, 8-bit gamma-depth batch function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_ramps8_f`, except the functions
+ * are called once per channel, rather than once per stop.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this            The CRTC state.
+ * @param   red_function    The function that generates the gamma ramp for the red channel.
+ * @param   green_function  The function that generates the gamma ramp for the green channel.
+ * @param   blue_function   The function that generates the gamma ramp for the blue channel.
+ * @return                  Zero on success, otherwise (negative) the value of an
+ *                          error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_ramps8_batch_f(libgamma_crtc_state_t* restrict this,
+					   libgamma_gamma_ramps8_batch_fun* red_function,
+					   libgamma_gamma_ramps8_batch_fun* green_function,
+					   libgamma_gamma_ramps8_batch_fun* blue_function);
+
+/**
+ * Set the gamma ramps for a CRTC, 16-bit gamma-depth batch function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_ramps16_f`, except the functions
+ * are called once per channel, rather than once per stop.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this            The CRTC state.
+ * @param   red_function    The function that generates the gamma ramp for the red channel.
+ * @param   green_function  The function that generates the gamma ramp for the green channel.
+ * @param   blue_function   The function that generates the gamma ramp for the blue channel.
+ * @return                  Zero on success, otherwise (negative) the value of an
+ *                          error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_ramps16_batch_f(libgamma_crtc_state_t* restrict this,
+					    libgamma_gamma_ramps16_batch_fun* red_function,
+					    libgamma_gamma_ramps16_batch_fun* green_function,
+					    libgamma_gamma_ramps16_batch_fun* blue_function);
+
+/**
+ * Set the gamma ramps for a CRTC, 32-bit gamma-depth batch function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_ramps32_f`, except the functions
+ * are called once per channel, rather than once per stop.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this            The CRTC state.
+ * @param   red_function    The function that generates the gamma ramp for the red channel.
+ * @param   green_function  The function that generates the gamma ramp for the green channel.
+ * @param   blue_function   The function that generates the gamma ramp for the blue channel.
+ * @return                  Zero on success, otherwise (negative) the value of an
+ *                          error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_ramps32_batch_f(libgamma_crtc_state_t* restrict this,
+					    libgamma_gamma_ramps32_batch_fun* red_function,
+					    libgamma_gamma_ramps32_batch_fun* green_function,
+					    libgamma_gamma_ramps32_batch_fun* blue_function);
+
+/**
+ * Set the gamma ramps for a CRTC, 64-bit gamma-depth batch function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_ramps64_f`, except the functions
+ * are called once per channel, rather than once per stop.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this            The CRTC state.
+ * @param   red_function    The function that generates the gamma ramp for the red channel.
+ * @param   green_function  The function that generates the gamma ramp for the green channel.
+ * @param   blue_function   The function that generates the gamma ramp for the blue channel.
+ * @return                  Zero on success, otherwise (negative) the value of an
+ *                          error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_ramps64_batch_f(libgamma_crtc_state_t* restrict this,
+					    libgamma_gamma_ramps64_batch_fun* red_function,
+					    libgamma_gamma_ramps64_batch_fun* green_function,
+					    libgamma_gamma_ramps64_batch_fun* blue_function);
+
+/**
+ * Set the gamma ramps for a CRTC, `float` batch function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_rampsf_f`, except the functions
+ * are called once per channel, rather than once per stop.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this            The CRTC state.
+ * @param   red_function    The function that generates the gamma ramp for the red channel.
+ * @param   green_function  The function that generates the gamma ramp for the green channel.
+ * @param   blue_function   The function that generates the gamma ramp for the blue channel.
+ * @return                  Zero on success, otherwise (negative) the value of an
+ *                          error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_rampsf_batch_f(libgamma_crtc_state_t* restrict this,
+					   libgamma_gamma_rampsf_batch_fun* red_function,
+					   libgamma_gamma_rampsf_batch_fun* green_function,
+					   libgamma_gamma_rampsf_batch_fun* blue_function);
+
+/**
+ * Set the gamma ramps for a CRTC, `double` batch function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_rampsd_f`, except the functions
+ * are called once per channel, rather than once per stop.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this            The CRTC state.
+ * @param   red_function    The function that generates the gamma ramp for the red channel.
+ * @param   green_function  The function that generates the gamma ramp for the green channel.
+ * @param   blue_function   The function that generates the gamma ramp for the blue channel.
+ * @return                  Zero on success, otherwise (negative) the value of an
+ *                          error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_rampsd_batch_f(libgamma_crtc_state_t* restrict this,
+					   libgamma_gamma_rampsd_batch_fun* red_function,
+					   libgamma_gamma_rampsd_batch_fun* green_function,
+					   libgamma_gamma_rampsd_batch_fun* blue_function);
+
+/**
+ * Set the gamma ramps for a CRTC, half precision floating point batch function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_rampsh_f`, except the functions
+ * are called once per channel, rather than once per stop.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this            The CRTC state.
+ * @param   red_function    The function that generates the gamma ramp for the red channel.
+ * @param   green_function  The function that generates the gamma ramp for the green channel.
+ * @param   blue_function   The function that generates the gamma ramp for the blue channel.
+ * @return                  Zero on success, otherwise (negative) the value of an
+ *                          error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_rampsh_batch_f(libgamma_crtc_state_t* restrict this,
+					   libgamma_gamma_rampsh_batch_fun* red_function,
+					   libgamma_gamma_rampsh_batch_fun* green_function,
+					   libgamma_gamma_rampsh_batch_fun* blue_function);
+
+/**
+ * Set the gamma ramps for a CRTC, 8-bit gamma-depth single function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_ramps8_f`, except one
+ * function is called once to generate all channels.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this      The CRTC state.
+ * @param   function  The function that generates the gamma ramps.
+ * @return            Zero on success, otherwise (negative) the value of an
+ *                    error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_ramps8_rgb_f(libgamma_crtc_state_t* restrict this,
+					 libgamma_gamma_ramps8_rgb_fun* function);
+
+/**
+ * Set the gamma ramps for a CRTC, 16-bit gamma-depth single function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_ramps16_f`, except one
+ * function is called once to generate all channels.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this      The CRTC state.
+ * @param   function  The function that generates the gamma ramps.
+ * @return            Zero on success, otherwise (negative) the value of an
+ *                    error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_ramps16_rgb_f(libgamma_crtc_state_t* restrict this,
+					  libgamma_gamma_ramps16_rgb_fun* function);
+
+/**
+ * Set the gamma ramps for a CRTC, 32-bit gamma-depth single function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_ramps32_f`, except one
+ * function is called once to generate all channels.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this      The CRTC state.
+ * @param   function  The function that generates the gamma ramps.
+ * @return            Zero on success, otherwise (negative) the value of an
+ *                    error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_ramps32_rgb_f(libgamma_crtc_state_t* restrict this,
+					  libgamma_gamma_ramps32_rgb_fun* function);
+
+/**
+ * Set the gamma ramps for a CRTC, 64-bit gamma-depth single function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_ramps64_f`, except one
+ * function is called once to generate all channels.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this      The CRTC state.
+ * @param   function  The function that generates the gamma ramps.
+ * @return            Zero on success, otherwise (negative) the value of an
+ *                    error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_ramps64_rgb_f(libgamma_crtc_state_t* restrict this,
+					  libgamma_gamma_ramps64_rgb_fun* function);
+
+/**
+ * Set the gamma ramps for a CRTC, `float` single function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_rampsf_f`, except one
+ * function is called once to generate all channels.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this      The CRTC state.
+ * @param   function  The function that generates the gamma ramps.
+ * @return            Zero on success, otherwise (negative) the value of an
+ *                    error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_rampsf_rgb_f(libgamma_crtc_state_t* restrict this,
+					 libgamma_gamma_rampsf_rgb_fun* function);
+
+/**
+ * Set the gamma ramps for a CRTC, `double` single function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_rampsd_f`, except one
+ * function is called once to generate all channels.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this      The CRTC state.
+ * @param   function  The function that generates the gamma ramps.
+ * @return            Zero on success, otherwise (negative) the value of an
+ *                    error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_rampsd_rgb_f(libgamma_crtc_state_t* restrict this,
+					 libgamma_gamma_rampsd_rgb_fun* function);
+
+/**
+ * Set the gamma ramps for a CRTC, half precision floating point single function version.
+ * 
+ * This is like `libgamma_crtc_set_gamma_rampsh_f`, except one
+ * function is called once to generate all channels.
+ * 
+ * Note that this will probably involve the library allocating temporary data.
+ * 
+ * @param   this      The CRTC state.
+ * @param   function  The function that generates the gamma ramps.
+ * @return            Zero on success, otherwise (negative) the value of an
+ *                    error identifier provided by this library.
+ */
+int libgamma_crtc_set_gamma_rampsh_rgb_f(libgamma_crtc_state_t* restrict this,
+					 libgamma_gamma_rampsh_rgb_fun* function);
+
+
+
+/**
+ * Select the allocator the library uses for all memory it allocates,
+ * except memory allocated by the display server's client libraries.
+ * 
+ * The allocator can only be changed when the library has no
+ * allocated memory, that is, before any state has been initialised
+ * or after all states have been destroyed. Buffers that are kept
+ * for reuse are released first.
+ * 
+ * Memory that is handed over to the user, for example EDID:s and
+ * connector names, is allocated with the allocator's allocation
+ * function, and must be released with its deallocation function.
+ * It is not counted, so the allocator can be changed while the user
+ * holds such memory. `libgamma_crtc_information_destroy` uses the
+ * deallocation function that is recorded in the CRTC information.
+ * 
+ * This function is not thread-safe, no other thread may use the
+ * library while it is called.
+ * 
+ * @param   allocator  The allocator, `NULL` to restore the
+ *                     default allocator, which uses `malloc`,
+ *                     `realloc` and `free`.
+ * @return             Zero on success, -1 on error, `errno`
+ *                     will be set accordingly: `EINVAL` if a
+ *                     function is missing in `allocator`,
+ *                     `EBUSY` if the library has allocated memory.
+ */
+int libgamma_set_allocator(const libgamma_allocator_t* restrict allocator);
+
+/**
+ * Get the number of bytes the library currently has allocated,
+ * this includes buffers that are kept for reuse, but not memory
+ * that has been handed over to the user or memory allocated by
+ * the display server's client libraries.
+ * 
+ * @return  The number of allocated bytes.
+ */
+size_t libgamma_allocated_bytes(void);
+
 
 #ifndef __GCC__
 # undef __attribute__
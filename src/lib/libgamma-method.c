@@ -17,11 +17,42 @@
  */
 #include "libgamma-method.h"
 
+#include "gamma-pool.h"
 
+
+#include <errno.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+
 
+/* The reference counts of shared gamma ramps are updated with the
+   `__atomic` builtins, which GCC and Clang provide regardless of
+   `-std`. `__GNUC__` is tested rather than `__GCC__`, which is only
+   defined by the makefile when `CC` is `gcc`. There is no fallback,
+   a non-atomic reference count could release gamma ramps twice. */
+#ifndef __GNUC__
+# error "libgamma requires a compiler that provides the __atomic builtins"
+#endif
+
+
+/**
+ * Release the stops of gamma ramps. The `_destroy` and `_free`
+ * functions accept both stops that the `_initialise` functions
+ * have taken from the pool, recognised by the `pool_tag` member,
+ * and stops that the user has allocated with `malloc`.
+ * 
+ * @param  red       The stops, `red` of the gamma ramps.
+ * @param  pool_tag  `pool_tag` of the gamma ramps.
+ */
+static void release_stops(void* red, uintptr_t pool_tag)
+{
+  if (pool_tag == LIBGAMMA_POOL_TAG(red))
+    libgamma_pool_release(red);
+  else
+    free(red);
+}
 
 
 /**
@@ -31,15 +62,20 @@
  * The input must have `red_size`, `green_size` and `blue_size` set to the
  * sizes of the gamma ramps that should be allocated.
  * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_ramps8_destroy` or `libgamma_gamma_ramps8_free`.
+ * 
  * @param   this  The gamma ramps.
  * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
  */
 int libgamma_gamma_ramps8_initialise(libgamma_gamma_ramps8_t* restrict this)
 {
   size_t n = this->red_size + this->green_size + this->blue_size;
-  this->red   = malloc(n * sizeof(uint8_t));
+  this->red   = libgamma_pool_allocate(n * sizeof(uint8_t));
   this->green = this->  red + this->  red_size;
   this->blue  = this->green + this->green_size;
+  this->pool_tag = LIBGAMMA_POOL_TAG(this->red);
   return this->red == NULL ? -1 : 0;
 }
 
@@ -53,7 +89,7 @@ int libgamma_gamma_ramps8_initialise(libgamma_gamma_ramps8_t* restrict this)
  */
 void libgamma_gamma_ramps8_destroy(libgamma_gamma_ramps8_t* restrict this)
 {
-  free(this->red);
+  release_stops(this->red, this->pool_tag);
 }
 
 
@@ -67,7 +103,7 @@ void libgamma_gamma_ramps8_destroy(libgamma_gamma_ramps8_t* restrict this)
  */
 void libgamma_gamma_ramps8_free(libgamma_gamma_ramps8_t* restrict this)
 {
-  free(this->red);
+  release_stops(this->red, this->pool_tag);
   free(this);
 }
 
@@ -80,20 +116,25 @@ void libgamma_gamma_ramps8_free(libgamma_gamma_ramps8_t* restrict this)
  * The input must have `red_size`, `green_size` and `blue_size` set to the
  * sizes of the gamma ramps that should be allocated.
  * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_ramps16_destroy` or `libgamma_gamma_ramps16_free`.
+ * 
  * @param   this  The gamma ramps.
  * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
  */
 int libgamma_gamma_ramps16_initialise(libgamma_gamma_ramps16_t* restrict this)
 {
   size_t n = this->red_size + this->green_size + this->blue_size;
+  this->red = libgamma_pool_allocate(n * sizeof(uint16_t));
 #ifdef HAVE_LIBGAMMA_METHOD_LINUX_DRM
-  /* Valgrind complains about us reading uninitialize memory if we just use malloc. */
-  this->red = calloc(n, sizeof(uint16_t));
-#else
-  this->red = malloc(n * sizeof(uint16_t));
+  /* Valgrind complains about us reading uninitialize memory if we do not clear it. */
+  if (this->red != NULL)
+    memset(this->red, 0, n * sizeof(uint16_t));
 #endif
   this->green = this->  red + this->  red_size;
   this->blue  = this->green + this->green_size;
+  this->pool_tag = LIBGAMMA_POOL_TAG(this->red);
   return this->red == NULL ? -1 : 0;
 }
 
@@ -107,7 +148,7 @@ int libgamma_gamma_ramps16_initialise(libgamma_gamma_ramps16_t* restrict this)
  */
 void libgamma_gamma_ramps16_destroy(libgamma_gamma_ramps16_t* restrict this)
 {
-  free(this->red);
+  release_stops(this->red, this->pool_tag);
 }
 
 
@@ -121,7 +162,7 @@ void libgamma_gamma_ramps16_destroy(libgamma_gamma_ramps16_t* restrict this)
  */
 void libgamma_gamma_ramps16_free(libgamma_gamma_ramps16_t* restrict this)
 {
-  free(this->red);
+  release_stops(this->red, this->pool_tag);
   free(this);
 }
 
@@ -134,15 +175,20 @@ void libgamma_gamma_ramps16_free(libgamma_gamma_ramps16_t* restrict this)
  * The input must have `red_size`, `green_size` and `blue_size` set to the
  * sizes of the gamma ramps that should be allocated.
  * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_ramps32_destroy` or `libgamma_gamma_ramps32_free`.
+ * 
  * @param   this  The gamma ramps.
  * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
  */
 int libgamma_gamma_ramps32_initialise(libgamma_gamma_ramps32_t* restrict this)
 {
   size_t n = this->red_size + this->green_size + this->blue_size;
-  this->red   = malloc(n * sizeof(uint32_t));
+  this->red   = libgamma_pool_allocate(n * sizeof(uint32_t));
   this->green = this->  red + this->  red_size;
   this->blue  = this->green + this->green_size;
+  this->pool_tag = LIBGAMMA_POOL_TAG(this->red);
   return this->red == NULL ? -1 : 0;
 }
 
@@ -156,7 +202,7 @@ int libgamma_gamma_ramps32_initialise(libgamma_gamma_ramps32_t* restrict this)
  */
 void libgamma_gamma_ramps32_destroy(libgamma_gamma_ramps32_t* restrict this)
 {
-  free(this->red);
+  release_stops(this->red, this->pool_tag);
 }
 
 
@@ -170,7 +216,7 @@ void libgamma_gamma_ramps32_destroy(libgamma_gamma_ramps32_t* restrict this)
  */
 void libgamma_gamma_ramps32_free(libgamma_gamma_ramps32_t* restrict this)
 {
-  free(this->red);
+  release_stops(this->red, this->pool_tag);
   free(this);
 }
 
@@ -183,15 +229,20 @@ void libgamma_gamma_ramps32_free(libgamma_gamma_ramps32_t* restrict this)
  * The input must have `red_size`, `green_size` and `blue_size` set to the
  * sizes of the gamma ramps that should be allocated.
  * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_ramps64_destroy` or `libgamma_gamma_ramps64_free`.
+ * 
  * @param   this  The gamma ramps.
  * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
  */
 int libgamma_gamma_ramps64_initialise(libgamma_gamma_ramps64_t* restrict this)
 {
   size_t n = this->red_size + this->green_size + this->blue_size;
-  this->red   = malloc(n * sizeof(uint64_t));
+  this->red   = libgamma_pool_allocate(n * sizeof(uint64_t));
   this->green = this->  red + this->  red_size;
   this->blue  = this->green + this->green_size;
+  this->pool_tag = LIBGAMMA_POOL_TAG(this->red);
   return this->red == NULL ? -1 : 0;
 }
 
@@ -205,7 +256,7 @@ int libgamma_gamma_ramps64_initialise(libgamma_gamma_ramps64_t* restrict this)
  */
 void libgamma_gamma_ramps64_destroy(libgamma_gamma_ramps64_t* restrict this)
 {
-  free(this->red);
+  release_stops(this->red, this->pool_tag);
 }
 
 
@@ -219,7 +270,7 @@ void libgamma_gamma_ramps64_destroy(libgamma_gamma_ramps64_t* restrict this)
  */
 void libgamma_gamma_ramps64_free(libgamma_gamma_ramps64_t* restrict this)
 {
-  free(this->red);
+  release_stops(this->red, this->pool_tag);
   free(this);
 }
 
@@ -232,15 +283,20 @@ void libgamma_gamma_ramps64_free(libgamma_gamma_ramps64_t* restrict this)
  * The input must have `red_size`, `green_size` and `blue_size` set to the
  * sizes of the gamma ramps that should be allocated.
  * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_rampsf_destroy` or `libgamma_gamma_rampsf_free`.
+ * 
  * @param   this  The gamma ramps.
  * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
  */
 int libgamma_gamma_rampsf_initialise(libgamma_gamma_rampsf_t* restrict this)
 {
   size_t n = this->red_size + this->green_size + this->blue_size;
-  this->red   = malloc(n * sizeof(float));
+  this->red   = libgamma_pool_allocate(n * sizeof(float));
   this->green = this->  red + this->  red_size;
   this->blue  = this->green + this->green_size;
+  this->pool_tag = LIBGAMMA_POOL_TAG(this->red);
   return this->red == NULL ? -1 : 0;
 }
 
@@ -254,7 +310,7 @@ int libgamma_gamma_rampsf_initialise(libgamma_gamma_rampsf_t* restrict this)
  */
 void libgamma_gamma_rampsf_destroy(libgamma_gamma_rampsf_t* restrict this)
 {
-  free(this->red);
+  release_stops(this->red, this->pool_tag);
 }
 
 
@@ -268,7 +324,7 @@ void libgamma_gamma_rampsf_destroy(libgamma_gamma_rampsf_t* restrict this)
  */
 void libgamma_gamma_rampsf_free(libgamma_gamma_rampsf_t* restrict this)
 {
-  free(this->red);
+  release_stops(this->red, this->pool_tag);
   free(this);
 }
 
@@ -281,15 +337,20 @@ void libgamma_gamma_rampsf_free(libgamma_gamma_rampsf_t* restrict this)
  * The input must have `red_size`, `green_size` and `blue_size` set to the
  * sizes of the gamma ramps that should be allocated.
  * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_rampsd_destroy` or `libgamma_gamma_rampsd_free`.
+ * 
  * @param   this  The gamma ramps.
  * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
  */
 int libgamma_gamma_rampsd_initialise(libgamma_gamma_rampsd_t* restrict this)
 {
   size_t n = this->red_size + this->green_size + this->blue_size;
-  this->red   = malloc(n * sizeof(double));
+  this->red   = libgamma_pool_allocate(n * sizeof(double));
   this->green = this->  red + this->  red_size;
   this->blue  = this->green + this->green_size;
+  this->pool_tag = LIBGAMMA_POOL_TAG(this->red);
   return this->red == NULL ? -1 : 0;
 }
 
@@ -303,7 +364,7 @@ int libgamma_gamma_rampsd_initialise(libgamma_gamma_rampsd_t* restrict this)
  */
 void libgamma_gamma_rampsd_destroy(libgamma_gamma_rampsd_t* restrict this)
 {
-  free(this->red);
+  release_stops(this->red, this->pool_tag);
 }
 
 
@@ -317,7 +378,259 @@ void libgamma_gamma_rampsd_destroy(libgamma_gamma_rampsd_t* restrict this)
  */
 void libgamma_gamma_rampsd_free(libgamma_gamma_rampsd_t* restrict this)
 {
-  free(this->red);
+  release_stops(this->red, this->pool_tag);
+  free(this);
+}
+
+
+/**
+ * Initialise a gamma ramp in the proper way that allows all adjustment
+ * methods to read from and write to it without causing segmentation violation.
+ * 
+ * The input must have `red_size`, `green_size` and `blue_size` set to the
+ * sizes of the gamma ramps that should be allocated.
+ * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_rampsh_destroy` or `libgamma_gamma_rampsh_free`.
+ * 
+ * @param   this  The gamma ramps.
+ * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
+ */
+int libgamma_gamma_rampsh_initialise(libgamma_gamma_rampsh_t* restrict this)
+{
+  size_t n = this->red_size + this->green_size + this->blue_size;
+  this->red   = libgamma_pool_allocate(n * sizeof(libgamma_float_half_t));
+  this->green = this->  red + this->  red_size;
+  this->blue  = this->green + this->green_size;
+  this->pool_tag = LIBGAMMA_POOL_TAG(this->red);
+  return this->red == NULL ? -1 : 0;
+}
+
+
+/**
+ * Release resources that are held by a gamma ramp strcuture that
+ * has been allocated by `libgamma_gamma_rampsh_initialise` or otherwise
+ * initialises in the proper manner.
+ * 
+ * @param  this  The gamma ramps.
+ */
+void libgamma_gamma_rampsh_destroy(libgamma_gamma_rampsh_t* restrict this)
+{
+  release_stops(this->red, this->pool_tag);
+}
+
+
+/**
+ * Release resources that are held by a gamma ramp strcuture that
+ * has been allocated by `libgamma_gamma_rampsh_initialise` or otherwise
+ * initialises in the proper manner, as well as release the pointer
+ * to the structure.
+ * 
+ * @param  this  The gamma ramps.
+ */
+void libgamma_gamma_rampsh_free(libgamma_gamma_rampsh_t* restrict this)
+{
+  release_stops(this->red, this->pool_tag);
   free(this);
 }
 
+
+/**
+ * Release prepared gamma ramps that have been created
+ * by `libgamma_crtc_prepare_gamma_ramps`.
+ * 
+ * @param  this  The prepared gamma ramps, may be `NULL`.
+ */
+void libgamma_gamma_ramps_prepared_free(libgamma_gamma_ramps_prepared_t* restrict this)
+{
+  /* The stops are stored in the same allocation as the structure. */
+  libgamma_pool_release(this);
+}
+
+
+
+/**
+ * Get the size of a stop in a gamma ramp.
+ * 
+ * @param   depth  The depth of the gamma ramp,
+ *                 `-1` for `float`, `-2` for `double`, `-3` for half.
+ * @return         The size of a stop, zero if `depth` is invalid.
+ */
+static size_t stop_size(signed depth)
+{
+  switch (depth)
+    {
+    case  8:  return sizeof(uint8_t);
+    case 16:  return sizeof(uint16_t);
+    case 32:  return sizeof(uint32_t);
+    case 64:  return sizeof(uint64_t);
+    case -1:  return sizeof(float);
+    case -2:  return sizeof(double);
+    case -3:  return sizeof(libgamma_float_half_t);
+    default:
+      return 0;
+    }
+}
+
+
+/**
+ * Create reference-counted gamma ramps, with one reference.
+ * The stops are not initialised.
+ * 
+ * @param   red_size    The size of the red gamma ramp.
+ * @param   green_size  The size of the green gamma ramp.
+ * @param   blue_size   The size of the blue gamma ramp.
+ * @param   depth       The depth of the stops, `-1` for `float`,
+ *                      `-2` for `double`, `-3` for half.
+ * @return              The gamma ramps, `NULL` on error, `errno`
+ *                      will be set accordingly.
+ */
+libgamma_gamma_ramps_shared_t* libgamma_gamma_ramps_shared_create(size_t red_size, size_t green_size,
+								  size_t blue_size, signed depth)
+{
+  libgamma_gamma_ramps_shared_t* this;
+  size_t d = stop_size(depth);
+  
+  if (d == 0)
+    return errno = EINVAL, NULL;
+  
+  /* The stops are stored directly after the structure,
+     which is sufficiently aligned for any of the stop types. */
+  this = libgamma_pool_allocate(sizeof(libgamma_gamma_ramps_shared_t) + (red_size + green_size + blue_size) * d);
+  if (this == NULL)
+    return NULL;
+  
+  this->red_size   = red_size;
+  this->green_size = green_size;
+  this->blue_size  = blue_size;
+  this->red   = (void*)(this + 1);
+  this->green = (void*)(((char*)(this->  red)) +   red_size * d / sizeof(char));
+  this->blue  = (void*)(((char*)(this->green)) + green_size * d / sizeof(char));
+  this->depth = depth;
+  this->refcount = 1;
+  return this;
+}
+
+
+/**
+ * Create reference-counted gamma ramps, with one reference,
+ * from a copy of a view of gamma ramps. The gamma ramps
+ * will have the same depth and sizes as the view.
+ * 
+ * @param   view  The gamma ramps to copy.
+ * @return        The gamma ramps, `NULL` on error, `errno`
+ *                will be set accordingly.
+ */
+libgamma_gamma_ramps_shared_t* libgamma_gamma_ramps_shared_from_view(const libgamma_gamma_ramps_view_t* restrict view)
+{
+  libgamma_gamma_ramps_shared_t* this;
+  const char* restrict in;
+  char* restrict out;
+  size_t i, d, n, stride;
+  int c;
+  
+  this = libgamma_gamma_ramps_shared_create(view->red_size, view->green_size, view->blue_size, view->depth);
+  if (this == NULL)
+    return NULL;
+  
+  d = stop_size(view->depth);
+  
+  /* Copy the channels, one memcpy per channel if the stops are adjacent. */
+  for (c = 0; c < 3; c++)
+    {
+      in     = c == 0 ? view->red        : c == 1 ? view->green        : view->blue;
+      out    = c == 0 ? this->red        : c == 1 ? this->green        : this->blue;
+      n      = c == 0 ? view->red_size   : c == 1 ? view->green_size   : view->blue_size;
+      stride = c == 0 ? view->red_stride : c == 1 ? view->green_stride : view->blue_stride;
+      if (stride == 1)
+	memcpy(out, in, n * d);
+      else
+	for (i = 0; i < n; i++)
+	  memcpy(out + i * d, in + i * stride * d, d);
+    }
+  
+  return this;
+}
+
+
+/**
+ * Add a reference to reference-counted gamma ramps.
+ * 
+ * @param   this  The gamma ramps.
+ * @return        `this`.
+ */
+libgamma_gamma_ramps_shared_t* libgamma_gamma_ramps_shared_ref(libgamma_gamma_ramps_shared_t* restrict this)
+{
+  __atomic_add_fetch(&(this->refcount), 1, __ATOMIC_RELAXED);
+  return this;
+}
+
+
+/**
+ * Remove a reference to reference-counted gamma ramps,
+ * and release them if it was the last reference.
+ * 
+ * @param  this  The gamma ramps, may be `NULL`.
+ */
+void libgamma_gamma_ramps_shared_unref(libgamma_gamma_ramps_shared_t* restrict this)
+{
+  if (this == NULL)
+    return;
+  /* The release–acquire ordering makes all modifications, by other
+     threads, of the stops happen before they are released here. */
+  if (__atomic_sub_fetch(&(this->refcount), 1, __ATOMIC_ACQ_REL) == 0)
+    libgamma_pool_release(this);
+}
+
+
+/**
+ * Make sure that the caller's reference to reference-counted
+ * gamma ramps is the only reference, so that the stops can
+ * be modified. If there are other references, the gamma ramps
+ * are copied, the caller's reference to the original gamma
+ * ramps is removed and replaced by a reference to the copy.
+ * 
+ * @param   this  Reference to the caller's reference to the gamma ramps.
+ * @return        Zero on success, -1 on allocation error, `errno` will be set
+ *                accordingly; `*this` is not modified on failure.
+ */
+int libgamma_gamma_ramps_shared_unshare(libgamma_gamma_ramps_shared_t** restrict this)
+{
+  libgamma_gamma_ramps_shared_t* old = *this;
+  libgamma_gamma_ramps_shared_t* new;
+  
+  /* If we hold the only reference, no one else can add a reference. */
+  if (__atomic_load_n(&(old->refcount), __ATOMIC_ACQUIRE) == 1)
+    return 0;
+  
+  new = libgamma_gamma_ramps_shared_create(old->red_size, old->green_size, old->blue_size, old->depth);
+  if (new == NULL)
+    return -1;
+  memcpy(new->red, old->red, (old->red_size + old->green_size + old->blue_size) * stop_size(old->depth));
+  
+  libgamma_gamma_ramps_shared_unref(old);
+  *this = new;
+  return 0;
+}
+
+
+/**
+ * Get a view of reference-counted gamma ramps, so that they can
+ * be applied with for example `libgamma_crtc_set_gamma_ramps_view`.
+ * 
+ * @param  this  The gamma ramps.
+ * @param  view  Output parameter for the view.
+ */
+void libgamma_gamma_ramps_shared_view(const libgamma_gamma_ramps_shared_t* restrict this,
+				      libgamma_gamma_ramps_view_t* restrict view)
+{
+  view->red_size   = this->red_size;
+  view->green_size = this->green_size;
+  view->blue_size  = this->blue_size;
+  view->red_stride = view->green_stride = view->blue_stride = 1;
+  view->red   = this->red;
+  view->green = this->green;
+  view->blue  = this->blue;
+  view->depth = this->depth;
+}
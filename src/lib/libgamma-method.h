@@ -192,6 +192,15 @@ typedef struct libgamma_method_capabilities
    * the display server.
    */
   unsigned auto_restore : 1;
+  
+  /**
+   * Whether `libgamma_gamma_transaction_commit` can apply the gamma
+   * ramps of all CRTC:s in a transaction in one update, so that either
+   * all of them or none of them are applied. For some adjustment methods
+   * this also depends on the graphics card's driver, see
+   * `LIBGAMMA_TRANSACTION_ATOMIC`.
+   */
+  unsigned atomic_transactions : 1;
 
 } libgamma_method_capabilities_t;
 
@@ -220,6 +229,13 @@ typedef struct libgamma_site_state
    */
   int method;
   
+  /**
+   * The adjustment method's implementations of the library's
+   * functions, resolved from `method` when the site is initialised.
+   * You as a user of this library should not touch this.
+   */
+  const struct libgamma_method_ops* ops;
+  
   /**
    * The site identifier. It can either be `NULL` or a string.
    * `NULL` indicates the default site. On systems like the
@@ -242,6 +258,14 @@ typedef struct libgamma_site_state
    */
   size_t partitions_available;
   
+  /**
+   * Incremented by `libgamma_site_invalidate` when the CRTC:s
+   * on the site may have changed, information that CRTC states
+   * have cached before that is discarded. You as a user of
+   * this library should not touch this.
+   */
+  unsigned long int generation;
+  
 } libgamma_site_state_t;
 
 
@@ -285,6 +309,75 @@ typedef struct libgamma_partition_state
 } libgamma_partition_state_t;
 
 
+/**
+ * How gamma ramps are resampled when their sizes
+ * do not match the sizes of a CRTC's gamma ramps.
+ */
+typedef enum libgamma_resample_mode
+  {
+    /**
+     * The gamma ramps are not resampled, they are passed
+     * to the adjustment method as is, which will fail
+     * unless the sizes match.
+     */
+    LIBGAMMA_RESAMPLE_NONE = 0,
+    
+    /**
+     * The gamma ramps are resampled with linear
+     * interpolation between the two nearest stops.
+     */
+    LIBGAMMA_RESAMPLE_LINEAR = 1,
+    
+    /**
+     * The gamma ramps are resampled with monotone cubic
+     * Hermite interpolation (Fritsch–Butland tangents,)
+     * which is smoother than linear interpolation but
+     * never overshoots or turns a monotonic ramp into
+     * a non-monotonic ramp.
+     */
+    LIBGAMMA_RESAMPLE_MONOTONE_CUBIC = 2
+    
+  } libgamma_resample_mode_t;
+
+/**
+ * The number of values defined in `libgamma_resample_mode_t`.
+ */
+#define LIBGAMMA_RESAMPLE_COUNT  3
+
+
+/**
+ * A handle for a CRTC that identifies it by the adjustment
+ * method's own identifiers rather than by its index, so
+ * that the CRTC can be found again after the partition's
+ * CRTC:s have been re-enumerated.
+ */
+typedef struct libgamma_crtc_handle
+{
+  /**
+   * The index of the partition the CRTC belongs to.
+   */
+  size_t partition;
+  
+  /**
+   * The adjustment method's identifier for the CRTC, that
+   * is the `xcb_randr_crtc_t` with X RandR and the CRTC ID
+   * with Linux DRM. For adjustment methods that do not have
+   * identifiers for CRTC:s, this is the index of the CRTC.
+   */
+  uint64_t crtc;
+  
+  /**
+   * The adjustment method's identifier for the connector
+   * that the CRTC drives, that is the `xcb_randr_output_t`
+   * with X RandR and the connector ID with Linux DRM.
+   * Zero if the CRTC does not drive a connector, or
+   * if the adjustment method does not know it.
+   */
+  uint64_t connector;
+  
+} libgamma_crtc_handle_t;
+
+
 /**
  * Cathode ray tube controller state.
  * 
@@ -310,6 +403,93 @@ typedef struct libgamma_crtc_state
    */
   size_t crtc;
   
+  /**
+   * Whether the temporary gamma ramps that are used when the
+   * gamma ramps are re-encoded to the depth of the adjustment
+   * method should be kept in `scratch` and reused, rather than
+   * allocated and freed on every call. This is zero after
+   * `libgamma_crtc_initialise`, but you may set it to any
+   * value at any time, the memory is freed when it is set
+   * to zero and the CRTC's gamma ramps are read or written,
+   * and when the CRTC state is destroyed.
+   */
+  int keep_scratch;
+  
+  /**
+   * Temporary gamma ramps that are kept for reuse,
+   * `NULL` if none are kept. You as a user of this
+   * library should not touch this.
+   */
+  void* scratch;
+  
+  /**
+   * The size of the allocation of `scratch`, in bytes.
+   * You as a user of this library should not touch this.
+   */
+  size_t scratch_size;
+  
+  /**
+   * How gamma ramps should be resampled when their sizes
+   * do not match the sizes of the CRTC's gamma ramps. This
+   * lets you keep one set of gamma ramps of any size and
+   * apply it to CRTC:s of different gamma ramp sizes, or
+   * read a CRTC's gamma ramps into gamma ramps of any size.
+   * This is `LIBGAMMA_RESAMPLE_NONE` after
+   * `libgamma_crtc_initialise`, but you may set it to
+   * any value at any time.
+   */
+  libgamma_resample_mode_t resample;
+  
+  /**
+   * OR:ed `LIBGAMMA_CRTC_INFO_GAMMA_SIZE` and
+   * `LIBGAMMA_CRTC_INFO_GAMMA_DEPTH` for the information
+   * that is cached in `cached_red_gamma_size`,
+   * `cached_green_gamma_size`, `cached_blue_gamma_size`
+   * and `cached_gamma_depth`. You as a user of this
+   * library should not touch this.
+   */
+  int32_t cached;
+  
+  /**
+   * The value of the site's `generation` when the
+   * information was cached. You as a user of this
+   * library should not touch this.
+   */
+  unsigned long int cached_generation;
+  
+  /**
+   * The cached size of the CRTC's gamma ramp for the red channel.
+   * You as a user of this library should not touch this.
+   */
+  size_t cached_red_gamma_size;
+  
+  /**
+   * The cached size of the CRTC's gamma ramp for the green channel.
+   * You as a user of this library should not touch this.
+   */
+  size_t cached_green_gamma_size;
+  
+  /**
+   * The cached size of the CRTC's gamma ramp for the blue channel.
+   * You as a user of this library should not touch this.
+   */
+  size_t cached_blue_gamma_size;
+  
+  /**
+   * The cached gamma ramp depth of the CRTC.
+   * You as a user of this library should not touch this.
+   */
+  signed cached_gamma_depth;
+  
+  /**
+   * The CRTC's handle, as it was when the CRTC state
+   * was initialised or last refreshed with
+   * `libgamma_crtc_refresh`. You as a user of this
+   * library should not touch this, use
+   * `libgamma_crtc_get_handle` to read it.
+   */
+  libgamma_crtc_handle_t handle;
+  
 } libgamma_crtc_state_t;
 
 
@@ -580,6 +760,14 @@ typedef enum libgamma_decision
  */
 #define LIBGAMMA_CRTC_INFO_COUNT  13
 
+/**
+ * Do not use the CRTC state's cached gamma ramp sizes and
+ * gamma ramp depth, but read them from the adjustment method
+ * and update the cache. This is not a field and is not
+ * counted in `LIBGAMMA_CRTC_INFO_COUNT`.
+ */
+#define LIBGAMMA_CRTC_INFO_REFRESH  (1 << 30)
+
 /**
  * Macro for both `libgamma_crtc_information_t` fields
  * that can specify the size of the monitor's viewport
@@ -765,7 +953,9 @@ typedef struct libgamma_crtc_information
   /**
    * The bit-depth of the value axes of gamma ramps,
    * -1 for single precision floating point, and -2 for
-   * double precision floating point.
+   * double precision floating point. (-3 is reserved for
+   * half precision floating point, but is currently not
+   * used by any adjustment method.)
    */
   signed gamma_depth;
   
@@ -891,9 +1081,151 @@ typedef struct libgamma_crtc_information
    */
   int gamma_error;
   
+  /**
+   * The deallocation function of the allocator that `edid` and
+   * `connector_name` were allocated with. It is recorded so that
+   * `libgamma_crtc_information_destroy` releases them correctly
+   * even if the allocator has been changed since.
+   */
+  void (*deallocate)(void* ptr, void* user_data);
+  
+  /**
+   * The `user_data` of the allocator that `edid` and
+   * `connector_name` were allocated with.
+   */
+  void* deallocate_user_data;
+  
 } libgamma_crtc_information_t;
 
 
+/**
+ * All partitions and CRTC:s on a site, as enumerated by
+ * `libgamma_site_enumerate`. The topology and all states
+ * in it are stored in one allocation, that is released
+ * by `libgamma_topology_free`.
+ */
+typedef struct libgamma_topology
+{
+  /**
+   * The site that was enumerated.
+   */
+  libgamma_site_state_t* site;
+  
+  /**
+   * The number of elements in `partitions`, this is
+   * the site's `partitions_available`.
+   */
+  size_t partition_count;
+  
+  /**
+   * The partition states for all partitions on
+   * the site, in order of their index.
+   */
+  libgamma_partition_state_t* partitions;
+  
+  /**
+   * The number of elements in `crtcs`, this is the sum
+   * of `crtcs_available` for all partitions.
+   */
+  size_t crtc_count;
+  
+  /**
+   * The CRTC states for all CRTC:s on the site, ordered
+   * by partition and then by index within the partition.
+   */
+  libgamma_crtc_state_t* crtcs;
+  
+  /**
+   * The information about each CRTC in `crtcs`, `NULL`
+   * unless information was requested. On error, refer
+   * to the error reports in each element.
+   */
+  libgamma_crtc_information_t* crtc_information;
+  
+  /**
+   * The information about the CRTC:s that was requested.
+   */
+  int32_t fields;
+  
+  /**
+   * A hash of the EDID of each CRTC in `crtcs`, zero if
+   * the CRTC's EDID could not be read. `NULL` unless
+   * `LIBGAMMA_CRTC_INFO_EDID` is included in `fields`.
+   */
+  uint64_t* edid_hashes;
+  
+} libgamma_topology_t;
+
+
+/**
+ * The CRTC is in the new topology but not in the old topology.
+ */
+#define LIBGAMMA_TOPOLOGY_CRTC_ADDED  (1 << 0)
+
+/**
+ * The CRTC is in the old topology but not in the new topology.
+ */
+#define LIBGAMMA_TOPOLOGY_CRTC_REMOVED  (1 << 1)
+
+/**
+ * A monitor has been connected to the CRTC. If the CRTC has
+ * been moved from one connector to another, both this and
+ * `LIBGAMMA_TOPOLOGY_DISCONNECTED` are set.
+ */
+#define LIBGAMMA_TOPOLOGY_CONNECTED  (1 << 2)
+
+/**
+ * The monitor has been disconnected from the CRTC.
+ */
+#define LIBGAMMA_TOPOLOGY_DISCONNECTED  (1 << 3)
+
+/**
+ * The size or depth of the CRTC's gamma ramps has changed.
+ * This is only detected if `LIBGAMMA_CRTC_INFO_GAMMA_SIZE`
+ * or `LIBGAMMA_CRTC_INFO_GAMMA_DEPTH`, respectively, was
+ * read in both topologies.
+ */
+#define LIBGAMMA_TOPOLOGY_GAMMA_SIZE_CHANGED  (1 << 4)
+
+/**
+ * The monitor's EDID has changed. This is only detected
+ * if `LIBGAMMA_CRTC_INFO_EDID` was read in both topologies.
+ */
+#define LIBGAMMA_TOPOLOGY_EDID_CHANGED  (1 << 5)
+
+
+/**
+ * A change to a CRTC between two topologies, as
+ * reported by `libgamma_topology_diff`.
+ */
+typedef struct libgamma_topology_change
+{
+  /**
+   * OR:ed `LIBGAMMA_TOPOLOGY_*` values for the changes.
+   */
+  int changes;
+  
+  /**
+   * The CRTC's handle in the new topology, or in
+   * the old topology if the CRTC has been removed.
+   */
+  libgamma_crtc_handle_t handle;
+  
+  /**
+   * The index of the CRTC in the old topology's `crtcs`,
+   * `SIZE_MAX` if the CRTC has been added.
+   */
+  size_t old_crtc;
+  
+  /**
+   * The index of the CRTC in the new topology's `crtcs`,
+   * `SIZE_MAX` if the CRTC has been removed.
+   */
+  size_t new_crtc;
+  
+} libgamma_topology_change_t;
+
+
 
 /**
  * Gamma ramp structure for 8-bit gamma ramps.
@@ -930,6 +1262,12 @@ typedef struct libgamma_gamma_ramps8
    */
   uint8_t* blue;
   
+  /**
+   * Marks stops that `libgamma_gamma_ramps8_initialise` has
+   * taken from the library's pool of buffers, do not modify.
+   */
+  uintptr_t pool_tag;
+  
 } libgamma_gamma_ramps8_t;
 
 
@@ -968,6 +1306,12 @@ typedef struct libgamma_gamma_ramps16
    */
   uint16_t* blue;
   
+  /**
+   * Marks stops that `libgamma_gamma_ramps16_initialise` has
+   * taken from the library's pool of buffers, do not modify.
+   */
+  uintptr_t pool_tag;
+  
 } libgamma_gamma_ramps16_t;
 
 
@@ -1006,6 +1350,12 @@ typedef struct libgamma_gamma_ramps32
    */
   uint32_t* blue;
   
+  /**
+   * Marks stops that `libgamma_gamma_ramps32_initialise` has
+   * taken from the library's pool of buffers, do not modify.
+   */
+  uintptr_t pool_tag;
+  
 } libgamma_gamma_ramps32_t;
 
 
@@ -1044,6 +1394,12 @@ typedef struct libgamma_gamma_ramps64
    */
   uint64_t* blue;
   
+  /**
+   * Marks stops that `libgamma_gamma_ramps64_initialise` has
+   * taken from the library's pool of buffers, do not modify.
+   */
+  uintptr_t pool_tag;
+  
 } libgamma_gamma_ramps64_t;
 
 
@@ -1082,6 +1438,12 @@ typedef struct libgamma_gamma_rampsf
    */
   float* blue;
   
+  /**
+   * Marks stops that `libgamma_gamma_rampsf_initialise` has
+   * taken from the library's pool of buffers, do not modify.
+   */
+  uintptr_t pool_tag;
+  
 } libgamma_gamma_rampsf_t;
 
 
@@ -1120,9 +1482,288 @@ typedef struct libgamma_gamma_rampsd
    */
   double* blue;
   
+  /**
+   * Marks stops that `libgamma_gamma_rampsd_initialise` has
+   * taken from the library's pool of buffers, do not modify.
+   */
+  uintptr_t pool_tag;
+  
 } libgamma_gamma_rampsd_t;
 
 
+/**
+ * Half precision floating point value (IEEE 754 binary16),
+ * stored as its bit pattern as C does not have a portable
+ * half precision floating point type. Use `libgamma_float_to_half`
+ * and `libgamma_half_to_float` to convert from and to `float`.
+ */
+typedef uint16_t libgamma_float_half_t;
+
+
+/**
+ * Gamma ramp structure for half precision floating point
+ * gamma ramps. This uses half as much memory as `float`
+ * gamma ramps, and its 11 bits of precision are still more
+ * than 16-bit gamma ramps need in the mid-range.
+ */
+typedef struct libgamma_gamma_rampsh
+{
+  /**
+   * The size of `red`.
+   */
+  size_t red_size;
+  
+  /**
+   * The size of `green`.
+   */
+  size_t green_size;
+  
+  /**
+   * The size of `blue`.
+   */
+  size_t blue_size;
+  
+  /**
+   * The gamma ramp for the red channel.
+   */
+  libgamma_float_half_t* red;
+  
+  /**
+   * The gamma ramp for the green channel.
+   */
+  libgamma_float_half_t* green;
+  
+  /**
+   * The gamma ramp for the blue channel.
+   */
+  libgamma_float_half_t* blue;
+  
+  /**
+   * Marks stops that `libgamma_gamma_rampsh_initialise` has
+   * taken from the library's pool of buffers, do not modify.
+   */
+  uintptr_t pool_tag;
+  
+} libgamma_gamma_rampsh_t;
+
+
+/**
+ * View of gamma ramps of any depth whose stops are not necessarily
+ * adjacent, for example interleaved RGB or RGBA lookup tables. This
+ * lets gamma ramps be applied without first being copied into the
+ * planar layout of the other gamma ramp structures.
+ * 
+ * For example, for interleaved RGBA `uint16_t` gamma ramps, `depth`
+ * is 16, `red`, `green` and `blue` point to the first, second and
+ * third element, and `red_stride`, `green_stride` and `blue_stride`
+ * are all 4.
+ */
+typedef struct libgamma_gamma_ramps_view
+{
+  /**
+   * The number of stops in the red channel.
+   */
+  size_t red_size;
+  
+  /**
+   * The number of stops in the green channel.
+   */
+  size_t green_size;
+  
+  /**
+   * The number of stops in the blue channel.
+   */
+  size_t blue_size;
+  
+  /**
+   * The distance between two adjacent stops
+   * in the red channel, in stops, not bytes.
+   */
+  size_t red_stride;
+  
+  /**
+   * The distance between two adjacent stops
+   * in the green channel, in stops, not bytes.
+   */
+  size_t green_stride;
+  
+  /**
+   * The distance between two adjacent stops
+   * in the blue channel, in stops, not bytes.
+   */
+  size_t blue_stride;
+  
+  /**
+   * The first stop in the red channel.
+   */
+  const void* red;
+  
+  /**
+   * The first stop in the green channel.
+   */
+  const void* green;
+  
+  /**
+   * The first stop in the blue channel.
+   */
+  const void* blue;
+  
+  /**
+   * The depth of the stops: 8, 16, 32 or 64 for `uint8_t`,
+   * `uint16_t`, `uint32_t` or `uint64_t`, -1 for `float`, -2
+   * for `double`, and -3 for `libgamma_float_half_t`.
+   */
+  signed depth;
+  
+} libgamma_gamma_ramps_view_t;
+
+
+/**
+ * Gamma ramps that have been translated, once and for all,
+ * to the format that a CRTC's adjustment method uses natively,
+ * so that they can be applied repeatedly without any
+ * translation or allocation.
+ * 
+ * The structure is opaque, it is created with
+ * `libgamma_crtc_prepare_gamma_ramps` and released
+ * with `libgamma_gamma_ramps_prepared_free`.
+ */
+typedef struct libgamma_gamma_ramps_prepared libgamma_gamma_ramps_prepared_t;
+
+
+/**
+ * Gamma ramps for multiple CRTC:s on the same site that
+ * are staged to be applied together.
+ * 
+ * The structure is opaque, it is created with
+ * `libgamma_gamma_transaction_begin` and released
+ * with `libgamma_gamma_transaction_free`.
+ */
+typedef struct libgamma_gamma_transaction libgamma_gamma_transaction_t;
+
+/**
+ * Flag for `libgamma_gamma_transaction_begin`: if the gamma ramps
+ * cannot be applied to all CRTC:s in one update, so that either all
+ * of them or none of them are applied, `libgamma_gamma_transaction_commit`
+ * shall fail with `ENOTSUP` rather than apply them one CRTC at a time.
+ */
+#define LIBGAMMA_TRANSACTION_ATOMIC  (1 << 0)
+
+/**
+ * Flag for `libgamma_gamma_transaction_begin`: with the RandR
+ * adjustment method, grab the X server while the gamma ramps
+ * are applied, so that it does not process any other client's
+ * requests in between. Ignored by other adjustment methods.
+ */
+#define LIBGAMMA_TRANSACTION_GRAB_SERVER  (1 << 1)
+
+
+/**
+ * Reference-counted, copy-on-write gamma ramps of any depth.
+ * 
+ * Copies are made with `libgamma_gamma_ramps_shared_ref`, which
+ * only increases the reference count, so that for example saved
+ * gamma ramps, undo history and per-client copies can share
+ * their stops until one of them is modified. Before the stops
+ * are modified, `libgamma_gamma_ramps_shared_unshare` must be
+ * called, it gives the caller a private copy if, and only if,
+ * the stops are shared. The reference count is updated atomically.
+ * 
+ * The stops are stored in the same allocation as the structure,
+ * and the structure must only be created with
+ * `libgamma_gamma_ramps_shared_create` or
+ * `libgamma_gamma_ramps_shared_from_view`.
+ */
+typedef struct libgamma_gamma_ramps_shared
+{
+  /**
+   * The size of `red`.
+   */
+  size_t red_size;
+  
+  /**
+   * The size of `green`.
+   */
+  size_t green_size;
+  
+  /**
+   * The size of `blue`.
+   */
+  size_t blue_size;
+  
+  /**
+   * The gamma ramp for the red channel.
+   */
+  void* red;
+  
+  /**
+   * The gamma ramp for the green channel.
+   */
+  void* green;
+  
+  /**
+   * The gamma ramp for the blue channel.
+   */
+  void* blue;
+  
+  /**
+   * The depth of the stops: 8, 16, 32 or 64 for `uint8_t`,
+   * `uint16_t`, `uint32_t` or `uint64_t`, -1 for `float`, -2
+   * for `double`, and -3 for `libgamma_float_half_t`.
+   */
+  signed depth;
+  
+  /**
+   * The number of references to the gamma ramps,
+   * this must only be modified by the library.
+   */
+  size_t refcount;
+  
+} libgamma_gamma_ramps_shared_t;
+
+
+/**
+ * Memory allocation functions that the library shall
+ * use instead of `malloc`, `realloc` and `free`.
+ */
+typedef struct libgamma_allocator
+{
+  /**
+   * Allocate memory, with the same alignment as `malloc`.
+   * 
+   * @param   size       The number of bytes to allocate.
+   * @param   user_data  The value of `user_data` in this structure.
+   * @return             The allocation, `NULL` on error.
+   */
+  void* (*allocate)(size_t size, void* user_data);
+  
+  /**
+   * Resize memory allocated with `allocate`.
+   * 
+   * @param   ptr        The allocation to resize.
+   * @param   size       The new size of the allocation.
+   * @param   user_data  The value of `user_data` in this structure.
+   * @return             The allocation, `NULL` on error,
+   *                     in which case `ptr` is still valid.
+   */
+  void* (*reallocate)(void* ptr, size_t size, void* user_data);
+  
+  /**
+   * Release memory allocated with `allocate` or `reallocate`.
+   * 
+   * @param  ptr        The allocation to release.
+   * @param  user_data  The value of `user_data` in this structure.
+   */
+  void (*deallocate)(void* ptr, void* user_data);
+  
+  /**
+   * Value passed to the functions, for example an arena.
+   */
+  void* user_data;
+  
+} libgamma_allocator_t;
+
+
 
 /**
  * Initialise a gamma ramp in the proper way that allows all adjustment
@@ -1131,6 +1772,10 @@ typedef struct libgamma_gamma_rampsd
  * The input must have `red_size`, `green_size` and `blue_size` set to the
  * sizes of the gamma ramps that should be allocated.
  * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_ramps8_destroy` or `libgamma_gamma_ramps8_free`.
+ * 
  * @param   this  The gamma ramps.
  * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
  */
@@ -1163,6 +1808,10 @@ void libgamma_gamma_ramps8_free(libgamma_gamma_ramps8_t* restrict this);
  * The input must have `red_size`, `green_size` and `blue_size` set to the
  * sizes of the gamma ramps that should be allocated.
  * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_ramps16_destroy` or `libgamma_gamma_ramps16_free`.
+ * 
  * @param   this  The gamma ramps.
  * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
  */
@@ -1195,6 +1844,10 @@ void libgamma_gamma_ramps16_free(libgamma_gamma_ramps16_t* restrict this);
  * The input must have `red_size`, `green_size` and `blue_size` set to the
  * sizes of the gamma ramps that should be allocated.
  * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_ramps32_destroy` or `libgamma_gamma_ramps32_free`.
+ * 
  * @param   this  The gamma ramps.
  * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
  */
@@ -1227,6 +1880,10 @@ void libgamma_gamma_ramps32_free(libgamma_gamma_ramps32_t* restrict this);
  * The input must have `red_size`, `green_size` and `blue_size` set to the
  * sizes of the gamma ramps that should be allocated.
  * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_ramps64_destroy` or `libgamma_gamma_ramps64_free`.
+ * 
  * @param   this  The gamma ramps.
  * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
  */
@@ -1259,6 +1916,10 @@ void libgamma_gamma_ramps64_free(libgamma_gamma_ramps64_t* restrict this);
  * The input must have `red_size`, `green_size` and `blue_size` set to the
  * sizes of the gamma ramps that should be allocated.
  * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_rampsf_destroy` or `libgamma_gamma_rampsf_free`.
+ * 
  * @param   this  The gamma ramps.
  * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
  */
@@ -1291,6 +1952,10 @@ void libgamma_gamma_rampsf_free(libgamma_gamma_rampsf_t* restrict this);
  * The input must have `red_size`, `green_size` and `blue_size` set to the
  * sizes of the gamma ramps that should be allocated.
  * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_rampsd_destroy` or `libgamma_gamma_rampsd_free`.
+ * 
  * @param   this  The gamma ramps
  * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
  */
@@ -1316,6 +1981,136 @@ void libgamma_gamma_rampsd_destroy(libgamma_gamma_rampsd_t* restrict this);
 void libgamma_gamma_rampsd_free(libgamma_gamma_rampsd_t* restrict this);
 
 
+/**
+ * Initialise a gamma ramp in the proper way that allows all adjustment
+ * methods to read from and write to it without causing segmentation violation.
+ * 
+ * The input must have `red_size`, `green_size` and `blue_size` set to the
+ * sizes of the gamma ramps that should be allocated.
+ * 
+ * The stops are allocated, aligned to 64 bytes, from a pool of buffers
+ * shared by the library, and must only be released with
+ * `libgamma_gamma_rampsh_destroy` or `libgamma_gamma_rampsh_free`.
+ * 
+ * @param   this  The gamma ramps.
+ * @return        Zero on success, -1 on allocation error, `errno` will be set accordingly.
+ */
+int libgamma_gamma_rampsh_initialise(libgamma_gamma_rampsh_t* restrict this);
+
+/**
+ * Release resources that are held by a gamma ramp strcuture that
+ * has been allocated by `libgamma_gamma_rampsh_initialise` or otherwise
+ * initialised in the proper manner.
+ * 
+ * @param  this  The gamma ramps.
+ */
+void libgamma_gamma_rampsh_destroy(libgamma_gamma_rampsh_t* restrict this);
+
+/**
+ * Release resources that are held by a gamma ramp strcuture that
+ * has been allocated by `libgamma_gamma_rampsh_initialise` or otherwise
+ * initialised in the proper manner, as well as release the pointer
+ * to the structure.
+ * 
+ * @param  this  The gamma ramps.
+ */
+void libgamma_gamma_rampsh_free(libgamma_gamma_rampsh_t* restrict this);
+
+
+/**
+ * Release prepared gamma ramps that have been created
+ * by `libgamma_crtc_prepare_gamma_ramps`.
+ * 
+ * @param  this  The prepared gamma ramps, may be `NULL`.
+ */
+void libgamma_gamma_ramps_prepared_free(libgamma_gamma_ramps_prepared_t* restrict this);
+
+
+/**
+ * Create reference-counted gamma ramps, with one reference.
+ * The stops are not initialised.
+ * 
+ * @param   red_size    The size of the red gamma ramp.
+ * @param   green_size  The size of the green gamma ramp.
+ * @param   blue_size   The size of the blue gamma ramp.
+ * @param   depth       The depth of the stops, `-1` for `float`,
+ *                      `-2` for `double`, `-3` for half.
+ * @return              The gamma ramps, `NULL` on error, `errno`
+ *                      will be set accordingly.
+ */
+libgamma_gamma_ramps_shared_t* libgamma_gamma_ramps_shared_create(size_t red_size, size_t green_size,
+								  size_t blue_size, signed depth);
+
+/**
+ * Create reference-counted gamma ramps, with one reference,
+ * from a copy of a view of gamma ramps. The gamma ramps
+ * will have the same depth and sizes as the view.
+ * 
+ * @param   view  The gamma ramps to copy.
+ * @return        The gamma ramps, `NULL` on error, `errno`
+ *                will be set accordingly.
+ */
+libgamma_gamma_ramps_shared_t* libgamma_gamma_ramps_shared_from_view(const libgamma_gamma_ramps_view_t* restrict view);
+
+/**
+ * Add a reference to reference-counted gamma ramps.
+ * 
+ * @param   this  The gamma ramps.
+ * @return        `this`.
+ */
+libgamma_gamma_ramps_shared_t* libgamma_gamma_ramps_shared_ref(libgamma_gamma_ramps_shared_t* restrict this);
+
+/**
+ * Remove a reference to reference-counted gamma ramps,
+ * and release them if it was the last reference.
+ * 
+ * @param  this  The gamma ramps, may be `NULL`.
+ */
+void libgamma_gamma_ramps_shared_unref(libgamma_gamma_ramps_shared_t* restrict this);
+
+/**
+ * Make sure that the caller's reference to reference-counted
+ * gamma ramps is the only reference, so that the stops can
+ * be modified. If there are other references, the gamma ramps
+ * are copied, the caller's reference to the original gamma
+ * ramps is removed and replaced by a reference to the copy.
+ * 
+ * @param   this  Reference to the caller's reference to the gamma ramps.
+ * @return        Zero on success, -1 on allocation error, `errno` will be set
+ *                accordingly; `*this` is not modified on failure.
+ */
+int libgamma_gamma_ramps_shared_unshare(libgamma_gamma_ramps_shared_t** restrict this);
+
+/**
+ * Get a view of reference-counted gamma ramps, so that they can
+ * be applied with for example `libgamma_crtc_set_gamma_ramps_view`.
+ * 
+ * @param  this  The gamma ramps.
+ * @param  view  Output parameter for the view.
+ */
+void libgamma_gamma_ramps_shared_view(const libgamma_gamma_ramps_shared_t* restrict this,
+				      libgamma_gamma_ramps_view_t* restrict view);
+
+
+/**
+ * Convert a `float` to half precision floating point,
+ * rounding to nearest, ties to even.
+ * 
+ * @param   value  The value to convert.
+ * @return         The value as a half precision floating point value.
+ */
+libgamma_float_half_t libgamma_float_to_half(float value) __attribute__((const));
+
+/**
+ * Convert a half precision floating point value to a `float`,
+ * this conversion is exact.
+ * 
+ * @param   value  The value to convert.
+ * @return         The value as a `float`.
+ */
+float libgamma_half_to_float(libgamma_float_half_t value) __attribute__((const));
+
+
 
 #ifndef __GCC__
 # undef __attribute__
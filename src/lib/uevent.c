@@ -0,0 +1,65 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "uevent.h"
+
+#include <limits.h>
+#include <string.h>
+
+
+/**
+ * Parse a kernel uevent and find the graphics card it is for.
+ * 
+ * @param   message  The uevent, a `ACTION@DEVPATH` header followed by
+ *                   `KEY=value` strings, all NUL-terminated.
+ * @param   length   The length of `message`, `message[length]` must be NUL.
+ * @param   card     Output parameter for the index of the graphics card.
+ * @return           `LIBGAMMA_UEVENT_CHANGE`, `LIBGAMMA_UEVENT_ADD` or
+ *                   `LIBGAMMA_UEVENT_REMOVE`, zero if the uevent is not
+ *                   for a graphics card.
+ */
+int libgamma_parse_uevent(const char* restrict message, size_t length, size_t* restrict card)
+{
+  const char* restrict end = message + length;
+  const char* restrict action = NULL;
+  const char* restrict devname = NULL;
+  const char* restrict p;
+  int drm = 0;
+  size_t n = 0;
+  
+  for (; message < end; message += strlen(message) + 1)
+    if      (!strncmp(message, "ACTION=",    7))  action  = message + 7;
+    else if (!strncmp(message, "DEVNAME=",   8))  devname = message + 8;
+    else if (!strncmp(message, "SUBSYSTEM=", 10))  drm = !strcmp(message + 10, "drm");
+  
+  /* Render nodes and connectors also belong to the
+     drm subsystem, but only cards have partitions. */
+  if (!drm || (action == NULL) || (devname == NULL) || strncmp(devname, "dri/card", 8))
+    return 0;
+  for (p = devname + 8; ('0' <= *p) && (*p <= '9'); p++)
+    if ((n = n * 10 + (size_t)(*p & 15)) > INT_MAX)
+      return 0;
+  if ((p == devname + 8) || *p)
+    return 0;
+  *card = n;
+  
+  if (!strcmp(action, "change"))  return LIBGAMMA_UEVENT_CHANGE;
+  if (!strcmp(action, "add"))     return LIBGAMMA_UEVENT_ADD;
+  if (!strcmp(action, "remove"))  return LIBGAMMA_UEVENT_REMOVE;
+  return 0;
+}
+
@@ -0,0 +1,56 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBGAMMA_UEVENT_H
+#define LIBGAMMA_UEVENT_H
+
+
+#include <stddef.h>
+
+
+/**
+ * Return value of `libgamma_parse_uevent` for a graphics card that has changed.
+ */
+#define LIBGAMMA_UEVENT_CHANGE  1
+
+/**
+ * Return value of `libgamma_parse_uevent` for a graphics card that has been added.
+ */
+#define LIBGAMMA_UEVENT_ADD  2
+
+/**
+ * Return value of `libgamma_parse_uevent` for a graphics card that has been removed.
+ */
+#define LIBGAMMA_UEVENT_REMOVE  3
+
+
+/**
+ * Parse a kernel uevent and find the graphics card it is for.
+ * 
+ * @param   message  The uevent, a `ACTION@DEVPATH` header followed by
+ *                   `KEY=value` strings, all NUL-terminated.
+ * @param   length   The length of `message`, `message[length]` must be NUL.
+ * @param   card     Output parameter for the index of the graphics card.
+ * @return           `LIBGAMMA_UEVENT_CHANGE`, `LIBGAMMA_UEVENT_ADD` or
+ *                   `LIBGAMMA_UEVENT_REMOVE`, zero if the uevent is not
+ *                   for a graphics card.
+ */
+int libgamma_parse_uevent(const char* restrict message, size_t length, size_t* restrict card);
+
+
+#endif
+
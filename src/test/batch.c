@@ -0,0 +1,295 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "batch.h"
+
+
+/**
+ * Print whether a test passed.
+ * 
+ * @param  description  A description of the test.
+ * @param  passed       Whether the test passed.
+ */
+static void report(const char* description, int passed)
+{
+  printf("  %s: %s\n", description, passed ? "passed" : "failed");
+}
+
+
+/**
+ * Allocate 16-bit gamma ramps with the sizes of a CRTC's gamma
+ * ramps, and fill them with a pattern that depends on a seed.
+ * 
+ * @param   ramps  The gamma ramps to initialise.
+ * @param   crtc   The CRTC state.
+ * @param   seed   The seed of the pattern.
+ * @return         Zero on success, non-zero on error.
+ */
+static int make_ramps16(libgamma_gamma_ramps16_t* restrict ramps, libgamma_crtc_state_t* restrict crtc, size_t seed)
+{
+  libgamma_crtc_information_t info;
+  size_t i;
+  
+  if (libgamma_get_crtc_information(&info, crtc, LIBGAMMA_CRTC_INFO_GAMMA_SIZE))
+    return -1;
+  ramps->red_size   = info.red_gamma_size;
+  ramps->green_size = info.green_gamma_size;
+  ramps->blue_size  = info.blue_gamma_size;
+  if (libgamma_gamma_ramps16_initialise(ramps))
+    return -1;
+  
+  for (i = 0; i < ramps->red_size; i++)    ramps->red[i]   = (uint16_t)(i * 7  + seed * 101);
+  for (i = 0; i < ramps->green_size; i++)  ramps->green[i] = (uint16_t)(i * 11 + seed * 103);
+  for (i = 0; i < ramps->blue_size; i++)   ramps->blue[i]  = (uint16_t)(i * 13 + seed * 107);
+  return 0;
+}
+
+
+/**
+ * Check whether a CRTC's current gamma ramps are the expected gamma ramps.
+ * 
+ * @param   crtc      The CRTC state.
+ * @param   expected  The expected gamma ramps.
+ * @return            Whether the CRTC has the expected gamma ramps.
+ */
+static int has_ramps16(libgamma_crtc_state_t* restrict crtc, const libgamma_gamma_ramps16_t* restrict expected)
+{
+  libgamma_gamma_ramps16_t ramps;
+  int equal;
+  
+  ramps.red_size   = expected->red_size;
+  ramps.green_size = expected->green_size;
+  ramps.blue_size  = expected->blue_size;
+  if (libgamma_gamma_ramps16_initialise(&ramps))
+    return 0;
+  
+  equal = !libgamma_crtc_get_gamma_ramps16(crtc, &ramps) &&
+    !memcmp(ramps.red,   expected->red,   ramps.red_size   * sizeof(uint16_t)) &&
+    !memcmp(ramps.green, expected->green, ramps.green_size * sizeof(uint16_t)) &&
+    !memcmp(ramps.blue,  expected->blue,  ramps.blue_size  * sizeof(uint16_t));
+  
+  libgamma_gamma_ramps16_destroy(&ramps);
+  return equal;
+}
+
+
+/**
+ * Check whether all elements in an array of return values are zero.
+ * 
+ * @param   errors  The return values.
+ * @param   count   The number of elements in `errors`.
+ * @return          Whether all return values are zero.
+ */
+static int all_succeeded(const int* restrict errors, size_t count)
+{
+  size_t i;
+  for (i = 0; i < count; i++)
+    if (errors[i])
+      return 0;
+  return 1;
+}
+
+
+/**
+ * Test applying gamma ramps to multiple CRTC:s, in batches and in
+ * transactions, and from views, prepared and reference-counted gamma
+ * ramps, on all CRTC:s of a site with the dummy adjustment method.
+ */
+void gamma_batches(void)
+{
+  libgamma_site_state_t site;
+  libgamma_topology_t* topology = NULL;
+  libgamma_crtc_state_t** crtcs = NULL;
+  libgamma_gamma_ramps16_t* ramps = NULL;
+  libgamma_gamma_ramps16_t* read = NULL;
+  libgamma_gamma_transaction_t* transaction = NULL;
+  libgamma_gamma_ramps_prepared_t* prepared = NULL;
+  libgamma_gamma_ramps_prepared_t other_depth;
+  libgamma_gamma_ramps_shared_t* shared = NULL;
+  libgamma_gamma_ramps_shared_t* copy;
+  libgamma_gamma_ramps_view_t view;
+  uint16_t* interleaved = NULL;
+  int* errors = NULL;
+  size_t i, j, n, initialised = 0;
+  int r, passed;
+  
+  printf("Testing gamma ramps for multiple CRTC:s:\n");
+  
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      printf("  skipped, the dummy adjustment method is not available\n\n");
+      return;
+    }
+  if ((r = libgamma_site_initialise(&site, LIBGAMMA_METHOD_DUMMY, NULL)))
+    {
+      libgamma_perror("  skipped, libgamma_site_initialise", r);
+      printf("\n");
+      return;
+    }
+  if ((r = libgamma_site_enumerate(&topology, &site, 0)))
+    {
+      libgamma_perror("  skipped, libgamma_site_enumerate", r);
+      printf("\n");
+      goto done;
+    }
+  
+  if ((n = topology->crtc_count) < 2)
+    {
+      printf("  skipped, the site has less than two CRTC:s\n\n");
+      libgamma_topology_free(topology);
+      goto done;
+    }
+  
+  /* Give each CRTC its own gamma ramps. */
+  crtcs  = calloc(n, sizeof(*crtcs));
+  ramps  = calloc(n, sizeof(*ramps));
+  read   = calloc(n, sizeof(*read));
+  errors = calloc(n, sizeof(*errors));
+  if ((crtcs == NULL) || (ramps == NULL) || (read == NULL) || (errors == NULL))
+    goto fail;
+  for (initialised = 0; initialised < n; initialised++)
+    {
+      crtcs[initialised] = topology->crtcs + initialised;
+      if (make_ramps16(ramps + initialised, crtcs[initialised], initialised))
+	goto fail;
+      if (make_ramps16(read + initialised, crtcs[initialised], 0))
+	{
+	  libgamma_gamma_ramps16_destroy(ramps + initialised);
+	  goto fail;
+	}
+    }
+  
+  /* Batches. */
+  r = libgamma_crtc_set_gamma_ramps16_many(crtcs, ramps, n, errors);
+  for (passed = !r && all_succeeded(errors, n), i = 0; i < n; i++)
+    passed &= has_ramps16(crtcs[i], ramps + i);
+  report("libgamma_crtc_set_gamma_ramps16_many", passed);
+  
+  r = libgamma_crtc_get_gamma_ramps16_many(crtcs, read, n, errors);
+  for (passed = !r && all_succeeded(errors, n), i = 0; i < n; i++)
+    passed &= !memcmp(read[i].red, ramps[i].red, ramps[i].red_size * sizeof(uint16_t)) &&
+      !memcmp(read[i].green, ramps[i].green, ramps[i].green_size * sizeof(uint16_t)) &&
+      !memcmp(read[i].blue, ramps[i].blue, ramps[i].blue_size * sizeof(uint16_t));
+  report("libgamma_crtc_get_gamma_ramps16_many", passed);
+  
+  /* Transactions, they can be restaged and committed again. */
+  if ((r = libgamma_gamma_transaction_begin(&transaction, LIBGAMMA_TRANSACTION_ATOMIC)))
+    goto fail;
+  for (passed = 1, i = 0; i < n; i++)
+    passed &= !libgamma_gamma_transaction_stage16(transaction, crtcs[i], ramps[n - 1 - i]);
+  passed &= !libgamma_gamma_transaction_commit(transaction, errors) && all_succeeded(errors, n);
+  for (i = 0; i < n; i++)
+    passed &= has_ramps16(crtcs[i], ramps + (n - 1 - i));
+  report("Atomic transaction", passed);
+  
+  passed = !libgamma_gamma_transaction_stage16(transaction, crtcs[0], ramps[0]);
+  passed &= !libgamma_gamma_transaction_commit(transaction, NULL);
+  for (passed &= has_ramps16(crtcs[0], ramps), i = 1; i < n; i++)
+    passed &= has_ramps16(crtcs[i], ramps + (n - 1 - i));
+  report("Restaged transaction", passed);
+  
+  /* Views, with the channels interleaved. */
+  j = ramps[0].red_size;
+  j = j > ramps[0].green_size ? j : ramps[0].green_size;
+  j = j > ramps[0].blue_size  ? j : ramps[0].blue_size;
+  if ((interleaved = calloc(3 * j, sizeof(uint16_t))) == NULL)
+    goto fail;
+  for (i = 0; i < ramps[0].red_size; i++)    interleaved[3 * i + 0] = ramps[0].red[i];
+  for (i = 0; i < ramps[0].green_size; i++)  interleaved[3 * i + 1] = ramps[0].green[i];
+  for (i = 0; i < ramps[0].blue_size; i++)   interleaved[3 * i + 2] = ramps[0].blue[i];
+  view.red_size   = ramps[0].red_size,   view.red_stride   = 3, view.red   = interleaved + 0;
+  view.green_size = ramps[0].green_size, view.green_stride = 3, view.green = interleaved + 1;
+  view.blue_size  = ramps[0].blue_size,  view.blue_stride  = 3, view.blue  = interleaved + 2;
+  view.depth = 16;
+  
+  passed = !libgamma_crtc_set_gamma_ramps_view(crtcs[n - 1], &view);
+  report("libgamma_crtc_set_gamma_ramps_view", passed && has_ramps16(crtcs[n - 1], ramps));
+  
+  r = libgamma_crtc_set_gamma_ramps_view_many(crtcs, n, &view, errors);
+  for (passed = !r && all_succeeded(errors, n), i = 0; i < n; i++)
+    passed &= has_ramps16(crtcs[i], ramps);
+  report("libgamma_crtc_set_gamma_ramps_view_many", passed);
+  
+  /* Prepared gamma ramps can be applied to any CRTC with the same gamma ramp sizes. */
+  view.red_size   = ramps[1].red_size,   view.red_stride   = 1, view.red   = ramps[1].red;
+  view.green_size = ramps[1].green_size, view.green_stride = 1, view.green = ramps[1].green;
+  view.blue_size  = ramps[1].blue_size,  view.blue_stride  = 1, view.blue  = ramps[1].blue;
+  passed = !libgamma_crtc_prepare_gamma_ramps(crtcs[0], &view, &prepared);
+  for (i = 0; passed && (i < n); i++)
+    passed &= !libgamma_crtc_set_gamma_ramps_prepared(crtcs[i], prepared) && has_ramps16(crtcs[i], ramps + 1);
+  report("Prepared gamma ramps", passed);
+  
+  /* Prepared gamma ramps are rejected by CRTC:s with other gamma ramp sizes or depths. */
+  libgamma_gamma_ramps_prepared_free(prepared), prepared = NULL;
+  view.red_size -= 1;
+  passed = !libgamma_crtc_prepare_gamma_ramps(crtcs[0], &view, &prepared);
+  view.red_size += 1;
+  passed = passed && (libgamma_crtc_set_gamma_ramps_prepared(crtcs[0], prepared) == LIBGAMMA_WRONG_GAMMA_RAMP_SIZE);
+  report("Prepared gamma ramps of another size", passed && has_ramps16(crtcs[0], ramps + 1));
+  
+  libgamma_gamma_ramps_prepared_free(prepared), prepared = NULL;
+  passed = !libgamma_crtc_prepare_gamma_ramps(crtcs[0], &view, &prepared);
+  if (passed)
+    {
+      other_depth = *prepared;
+      other_depth.depth = other_depth.depth == 8 ? 16 : 8;
+      errno = 0;
+      passed &= (libgamma_crtc_set_gamma_ramps_prepared(crtcs[0], &other_depth) == LIBGAMMA_ERRNO_SET);
+      passed &= (errno == EINVAL) && has_ramps16(crtcs[0], ramps + 1);
+    }
+  report("Prepared gamma ramps of another depth", passed);
+  
+  /* Reference-counted gamma ramps are copied before they are modified. */
+  passed = !libgamma_crtc_get_gamma_ramps_shared(crtcs[0], 16, &shared);
+  if (passed)
+    {
+      copy = libgamma_gamma_ramps_shared_ref(shared);
+      passed &= (shared->refcount == 2) && !libgamma_gamma_ramps_shared_unshare(&copy);
+      passed &= (copy != shared) && (shared->refcount == 1) && (copy->refcount == 1);
+      passed &= !memcmp(copy->red, ramps[1].red, ramps[1].red_size * sizeof(uint16_t));
+      ((uint16_t*)(copy->red))[0] ^= 1;
+      passed &= ((uint16_t*)(shared->red))[0] == ramps[1].red[0];
+      passed &= !libgamma_gamma_ramps_shared_unshare(&copy) && (copy->refcount == 1);
+      libgamma_gamma_ramps_shared_unref(copy);
+      libgamma_gamma_ramps_shared_view(shared, &view);
+      passed &= !libgamma_crtc_set_gamma_ramps_view(crtcs[n - 1], &view) && has_ramps16(crtcs[n - 1], ramps + 1);
+    }
+  report("Reference-counted gamma ramps", passed);
+  
+  goto release;
+ fail:
+  perror("  gamma_batches");
+ release:
+  printf("\n");
+  libgamma_gamma_ramps_shared_unref(shared);
+  libgamma_gamma_ramps_prepared_free(prepared);
+  libgamma_gamma_transaction_free(transaction);
+  free(interleaved);
+  for (i = 0; i < initialised; i++)
+    {
+      libgamma_gamma_ramps16_destroy(ramps + i);
+      libgamma_gamma_ramps16_destroy(read + i);
+    }
+  free(errors);
+  free(read);
+  free(ramps);
+  free(crtcs);
+  libgamma_topology_free(topology);
+ done:
+  libgamma_site_destroy(&site);
+}
+
@@ -0,0 +1,242 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "events.h"
+
+
+/**
+ * A kernel uevent, as a string literal.
+ * 
+ * @param  ACTION:string-literal     The action, "change", "add" or "remove" for graphics cards.
+ * @param  SUBSYSTEM:string-literal  The subsystem of the device, "drm" for graphics cards.
+ * @param  DEVNAME:string-literal    The device's name relative to /dev.
+ */
+#define UEVENT(ACTION, SUBSYSTEM, DEVNAME)		\
+  ACTION "@/devices/pci0000:00/drm/card0\0"		\
+  "ACTION=" ACTION "\0"					\
+  "DEVPATH=/devices/pci0000:00/drm/card0\0"		\
+  "SUBSYSTEM=" SUBSYSTEM "\0"				\
+  "DEVNAME=" DEVNAME
+
+/**
+ * Send a kernel uevent, given as a string literal,
+ * including its final NUL byte, over `fds[1]`.
+ * 
+ * @param  MESSAGE:string-literal  The uevent.
+ */
+#define SEND(MESSAGE)  send_uevent(fds[1], MESSAGE, sizeof(MESSAGE))
+
+
+/**
+ * Send a kernel uevent.
+ * 
+ * @param  fd       The socket to send the uevent over.
+ * @param  message  The uevent.
+ * @param  length   The length of `message`.
+ */
+static void send_uevent(int fd, const char* message, size_t length)
+{
+  if (send(fd, message, length, 0) < 0)
+    perror("send");
+}
+
+
+/**
+ * Process the sent uevents, and print whether
+ * the partition state got the expected result.
+ * 
+ * @param  site         The site state.
+ * @param  partition    The partition state.
+ * @param  description  A description of the sent uevents.
+ * @param  changed      The expected return value of `libgamma_site_process_events`.
+ * @param  expected     The expected result for the partition state.
+ */
+static void expect(libgamma_site_state_t* restrict site, libgamma_partition_state_t* restrict partition,
+		   const char* description, int changed, int expected)
+{
+  int r, result;
+  r = libgamma_site_process_events(site, partition, 1, &result);
+  if ((r == changed) && (result == expected))
+    printf("  %s: passed\n", description);
+  else
+    printf("  %s: failed, got %i and %i, expected %i and %i\n", description, r, result, changed, expected);
+}
+
+
+/**
+ * Parse a kernel uevent, given as a string literal, and print
+ * whether the expected action and graphics card was found.
+ * 
+ * @param  DESCRIPTION:const char*     A description of the uevent.
+ * @param  MESSAGE:string-literal      The uevent.
+ * @param  EXPECTED:int                The expected return value of `libgamma_parse_uevent`.
+ * @param  CARD:size_t                 The expected graphics card, if `EXPECTED` is non-zero.
+ */
+#define PARSE(DESCRIPTION, MESSAGE, EXPECTED, CARD)  \
+  parse((DESCRIPTION), (MESSAGE), sizeof(MESSAGE) - 1, (EXPECTED), (CARD))
+
+
+/**
+ * Parse a kernel uevent, and print whether the
+ * expected action and graphics card was found.
+ * 
+ * @param  description  A description of the uevent.
+ * @param  message      The uevent, `message[length]` must be NUL.
+ * @param  length       The length of `message`.
+ * @param  expected     The expected return value of `libgamma_parse_uevent`.
+ * @param  card         The expected graphics card, if `expected` is non-zero.
+ */
+static void parse(const char* description, const char* message, size_t length, int expected, size_t card)
+{
+  size_t got = (size_t)-1;
+  int r = libgamma_parse_uevent(message, length, &got);
+  if ((r == expected) && (!expected || (got == card)))
+    printf("  %s: passed\n", description);
+  else
+    printf("  %s: failed, got %i for card %zu, expected %i for card %zu\n",
+	   description, r, got, expected, card);
+}
+
+
+/**
+ * Test the parsing of kernel uevents, with canned uevents,
+ * this does not require that Linux DRM is available.
+ */
+void uevent_parsing(void)
+{
+  printf("Testing uevent parsing:\n");
+  PARSE("Changed graphics card", UEVENT("change", "drm", "dri/card0"), LIBGAMMA_UEVENT_CHANGE, 0);
+  PARSE("Added graphics card", UEVENT("add", "drm", "dri/card12"), LIBGAMMA_UEVENT_ADD, 12);
+  PARSE("Removed graphics card", UEVENT("remove", "drm", "dri/card3"), LIBGAMMA_UEVENT_REMOVE, 3);
+  PARSE("Uevent for another subsystem", UEVENT("change", "usb", "bus/usb/001/002"), 0, 0);
+  PARSE("Uevent for a connector", UEVENT("change", "drm", "dri/card0-HDMI-A-1"), 0, 0);
+  PARSE("Uevent for a render node", UEVENT("change", "drm", "dri/renderD128"), 0, 0);
+  PARSE("Uevent with an unknown action", UEVENT("bind", "drm", "dri/card0"), 0, 0);
+  PARSE("Uevent without a card number", UEVENT("change", "drm", "dri/card"), 0, 0);
+  PARSE("Uevent with a too large card number", UEVENT("add", "drm", "dri/card99999999999"), 0, 0);
+  PARSE("Uevent without ACTION and DEVNAME", "change@/devices/pci0000:00/drm/card0\0SUBSYSTEM=drm", 0, 0);
+  PARSE("Uevent with keys in another order",
+	"add@/devices/pci0000:00/drm/card1\0DEVNAME=dri/card1\0SUBSYSTEM=drm\0SEQNUM=1234\0ACTION=add",
+	LIBGAMMA_UEVENT_ADD, 1);
+  PARSE("Malformed uevent", "garbage without any NUL byte", 0, 0);
+  PARSE("Empty uevent", "", 0, 0);
+  printf("\n");
+}
+
+
+/**
+ * Test the processing of changes to the display configuration,
+ * by injecting kernel uevents into a Linux DRM site.
+ */
+void site_events(void)
+{
+  libgamma_site_state_t site;
+  libgamma_partition_state_t partition;
+  int fds[2] = {-1, -1}, r, have_partition = 0;
+  
+  printf("Testing display configuration events:\n");
+  
+  /* The uevents are in the format of Linux DRM. */
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_LINUX_DRM))
+    {
+      printf("  skipped, Linux DRM is not available\n\n");
+      return;
+    }
+  if ((r = libgamma_site_initialise(&site, LIBGAMMA_METHOD_LINUX_DRM, NULL)))
+    {
+      libgamma_perror("  skipped, libgamma_site_initialise", r);
+      printf("\n");
+      return;
+    }
+  
+  /* Inject the uevents over a socket pair instead of reading them from the kernel. */
+  if (socketpair(AF_UNIX, SOCK_DGRAM, 0, fds) < 0)
+    {
+      perror("  skipped, socketpair");
+      printf("\n");
+      goto done;
+    }
+  if ((r = libgamma_site_set_event_fd(&site, fds[0])))
+    {
+      libgamma_perror("  skipped, libgamma_site_set_event_fd", r);
+      printf("\n");
+      close(fds[0]);
+      goto done;
+    }
+  
+  /* Uevents that do not cause a refresh only look at the partition's index,
+     so they can be tested even if the first graphics card cannot be opened. */
+  if (site.partitions_available > 0)
+    have_partition = !libgamma_partition_initialise(&partition, &site, 0);
+  partition.partition = 0;
+  
+  SEND(UEVENT("change", "usb", "bus/usb/001/002"));
+  expect(&site, &partition, "Uevent for another subsystem", 0, 0);
+  
+  SEND("change@/devices/pci0000:00/drm/card0\0SUBSYSTEM=drm");
+  expect(&site, &partition, "Uevent without ACTION and DEVNAME", 0, 0);
+  
+  send_uevent(fds[1], "garbage without any NUL byte", sizeof("garbage without any NUL byte") - 1);
+  expect(&site, &partition, "Malformed uevent", 0, 0);
+  
+  SEND(UEVENT("bind", "drm", "dri/card0"));
+  expect(&site, &partition, "Uevent with an unknown action", 0, 0);
+  
+  SEND(UEVENT("change", "drm", "dri/card0-HDMI-A-1"));
+  expect(&site, &partition, "Uevent for a connector", 0, 0);
+  
+  SEND(UEVENT("change", "drm", "dri/renderD128"));
+  expect(&site, &partition, "Uevent for a render node", 0, 0);
+  
+  SEND(UEVENT("change", "drm", "dri/card1"));
+  expect(&site, &partition, "Uevent for another graphics card", 0, 0);
+  
+  SEND(UEVENT("remove", "drm", "dri/card0"));
+  expect(&site, &partition, "Removed graphics card", 1, LIBGAMMA_GRAPHICS_CARD_REMOVED);
+  
+  SEND(UEVENT("add", "drm", "dri/card0"));
+  SEND(UEVENT("remove", "drm", "dri/card0"));
+  expect(&site, &partition, "Added and removed graphics card", 1, LIBGAMMA_GRAPHICS_CARD_REMOVED);
+  
+  /* Uevents that cause a refresh require that the graphics card can be opened. */
+  if (!have_partition)
+    {
+      printf("  Changed graphics card: skipped, the first graphics card could not be opened\n\n");
+      goto done;
+    }
+  
+  SEND(UEVENT("change", "drm", "dri/card0"));
+  SEND(UEVENT("change", "drm", "dri/card0"));
+  expect(&site, &partition, "Changed graphics card", 1, 1);
+  
+  SEND(UEVENT("add", "drm", "dri/card0"));
+  expect(&site, &partition, "Added graphics card", 1, 1);
+  
+  SEND(UEVENT("remove", "drm", "dri/card0"));
+  SEND(UEVENT("add", "drm", "dri/card0"));
+  expect(&site, &partition, "Removed and added graphics card", 1, 1);
+  
+  expect(&site, &partition, "No uevents", 0, 0);
+  printf("\n");
+  
+  libgamma_partition_destroy(&partition);
+ done:
+  if (fds[1] >= 0)
+    close(fds[1]);
+  libgamma_site_destroy(&site);
+}
+
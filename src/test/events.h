@@ -0,0 +1,44 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBGAMMA_TEST_EVENTS_H
+#define LIBGAMMA_TEST_EVENTS_H
+
+
+#include <libgamma.h>
+#include "uevent.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+
+/**
+ * Test the processing of changes to the display configuration,
+ * by injecting kernel uevents into a Linux DRM site.
+ */
+void site_events(void);
+
+/**
+ * Test the parsing of kernel uevents, with canned uevents,
+ * this does not require that Linux DRM is available.
+ */
+void uevent_parsing(void);
+
+
+#endif
+
@@ -0,0 +1,238 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "handles.h"
+
+
+/**
+ * Print whether a test passed.
+ * 
+ * @param  description  A description of the test.
+ * @param  passed       Whether the test passed.
+ */
+static void report(const char* description, int passed)
+{
+  printf("  %s: %s\n", description, passed ? "passed" : "failed");
+}
+
+
+/**
+ * Test CRTC handles, and refreshing partition and
+ * CRTC states, with the dummy adjustment method.
+ */
+void crtc_handles(void)
+{
+  libgamma_site_state_t site;
+  libgamma_partition_state_t partition;
+  libgamma_crtc_state_t crtc;
+  libgamma_crtc_handle_t handle, other;
+  libgamma_crtc_information_t info;
+  libgamma_gamma_ramps16_t ramps, read;
+  size_t i, index;
+  int r, passed;
+  
+  printf("Testing CRTC handles and refreshing:\n");
+  
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      printf("  skipped, the dummy adjustment method is not available\n\n");
+      return;
+    }
+  if ((r = libgamma_site_initialise(&site, LIBGAMMA_METHOD_DUMMY, NULL)))
+    {
+      libgamma_perror("  skipped, libgamma_site_initialise", r);
+      printf("\n");
+      return;
+    }
+  if ((r = libgamma_partition_initialise(&partition, &site, site.partitions_available - 1)))
+    {
+      libgamma_perror("  skipped, libgamma_partition_initialise", r);
+      printf("\n");
+      goto done_site;
+    }
+  if (partition.crtcs_available < 2)
+    {
+      printf("  skipped, the partition has less than two CRTC:s\n\n");
+      goto done_partition;
+    }
+  index = partition.crtcs_available - 1;
+  if ((r = libgamma_crtc_initialise(&crtc, &partition, index)))
+    {
+      libgamma_perror("  skipped, libgamma_crtc_initialise", r);
+      printf("\n");
+      goto done_partition;
+    }
+  
+  /* The dummy adjustment method identifies CRTC:s by their indices. */
+  libgamma_crtc_get_handle(&crtc, &handle);
+  passed = (handle.partition == partition.partition) && (handle.crtc == index) && (handle.connector == 0);
+  passed &= !libgamma_partition_get_crtc_handle(&partition, index, &other);
+  passed &= !memcmp(&handle, &other, sizeof(handle));
+  report("libgamma_crtc_get_handle", passed);
+  
+  r = libgamma_partition_get_crtc_handle(&partition, partition.crtcs_available, &other);
+  report("Handle of a CRTC that does not exist", r == LIBGAMMA_NO_SUCH_CRTC);
+  
+  passed = !libgamma_partition_find_crtc(&partition, &handle, &i) && (i == index);
+  other = handle, other.partition += 1;
+  passed &= libgamma_partition_find_crtc(&partition, &other, &i) == LIBGAMMA_NO_SUCH_CRTC;
+  other = handle, other.crtc += 1;
+  passed &= libgamma_partition_find_crtc(&partition, &other, &i) == LIBGAMMA_NO_SUCH_CRTC;
+  report("libgamma_partition_find_crtc", passed);
+  
+  /* Apply gamma ramps, so we can check that they are kept. */
+  if (libgamma_get_crtc_information(&info, &crtc, LIBGAMMA_CRTC_INFO_GAMMA_SIZE))
+    goto fail;
+  ramps.red_size   = read.red_size   = info.red_gamma_size;
+  ramps.green_size = read.green_size = info.green_gamma_size;
+  ramps.blue_size  = read.blue_size  = info.blue_gamma_size;
+  if (libgamma_gamma_ramps16_initialise(&ramps))
+    goto fail;
+  if (libgamma_gamma_ramps16_initialise(&read))
+    {
+      libgamma_gamma_ramps16_destroy(&ramps);
+      goto fail;
+    }
+  for (i = 0; i < ramps.red_size; i++)    ramps.red[i]   = (uint16_t)(i * 3);
+  for (i = 0; i < ramps.green_size; i++)  ramps.green[i] = (uint16_t)(i * 5);
+  for (i = 0; i < ramps.blue_size; i++)   ramps.blue[i]  = (uint16_t)(i * 7);
+  passed = !libgamma_crtc_set_gamma_ramps16(&crtc, ramps);
+  
+  /* Refreshing keeps the CRTC and its gamma ramps, but not the cached information. */
+  passed &= !libgamma_partition_refresh(&partition);
+  passed &= !libgamma_crtc_refresh(&crtc);
+  passed &= (crtc.crtc == index) && (crtc.cached == 0);
+  libgamma_crtc_get_handle(&crtc, &other);
+  passed &= !memcmp(&handle, &other, sizeof(handle));
+  passed &= !libgamma_crtc_get_gamma_ramps16(&crtc, &read);
+  passed &= !memcmp(read.red,   ramps.red,   ramps.red_size   * sizeof(uint16_t));
+  passed &= !memcmp(read.green, ramps.green, ramps.green_size * sizeof(uint16_t));
+  passed &= !memcmp(read.blue,  ramps.blue,  ramps.blue_size  * sizeof(uint16_t));
+  report("libgamma_crtc_refresh", passed);
+  
+  /* A CRTC state for a CRTC that no longer exists is unchanged. */
+  crtc.handle.crtc = partition.crtcs_available;
+  r = libgamma_crtc_refresh(&crtc);
+  passed = (r == LIBGAMMA_NO_SUCH_CRTC) && (crtc.crtc == index);
+  crtc.handle = handle;
+  passed &= !libgamma_crtc_get_gamma_ramps16(&crtc, &read);
+  passed &= !memcmp(read.red, ramps.red, ramps.red_size * sizeof(uint16_t));
+  report("Refreshing a removed CRTC", passed);
+  
+  libgamma_gamma_ramps16_destroy(&read);
+  libgamma_gamma_ramps16_destroy(&ramps);
+  goto done;
+ fail:
+  perror("  crtc_handles");
+ done:
+  printf("\n");
+  libgamma_crtc_destroy(&crtc);
+ done_partition:
+  libgamma_partition_destroy(&partition);
+ done_site:
+  libgamma_site_destroy(&site);
+}
+
+
+
+/**
+ * Test that the gamma ramp sizes and depth are cached in the
+ * CRTC state, and that the cache is discarded after
+ * `libgamma_site_invalidate` and with `LIBGAMMA_CRTC_INFO_REFRESH`,
+ * with the dummy adjustment method.
+ */
+void crtc_information_cache(void)
+{
+  libgamma_site_state_t site;
+  libgamma_partition_state_t partition;
+  libgamma_crtc_state_t crtc;
+  libgamma_crtc_information_t info, actual;
+  int r, passed;
+  
+  printf("Testing cached CRTC information:\n");
+  
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      printf("  skipped, the dummy adjustment method is not available\n\n");
+      return;
+    }
+  if ((r = libgamma_site_initialise(&site, LIBGAMMA_METHOD_DUMMY, NULL)))
+    {
+      libgamma_perror("  skipped, libgamma_site_initialise", r);
+      printf("\n");
+      return;
+    }
+  if ((r = libgamma_partition_initialise(&partition, &site, 0)))
+    {
+      libgamma_perror("  skipped, libgamma_partition_initialise", r);
+      printf("\n");
+      goto done_site;
+    }
+  if ((r = libgamma_crtc_initialise(&crtc, &partition, 0)))
+    {
+      libgamma_perror("  skipped, libgamma_crtc_initialise", r);
+      printf("\n");
+      goto done_partition;
+    }
+  
+  /* Nothing is cached until it has been read. */
+  passed = crtc.cached == 0;
+  passed &= !libgamma_get_crtc_information(&actual, &crtc, LIBGAMMA_CRTC_INFO_GAMMA_SIZE |
+					   LIBGAMMA_CRTC_INFO_GAMMA_DEPTH | LIBGAMMA_CRTC_INFO_GAMMA_SUPPORT);
+  passed &= crtc.cached == (LIBGAMMA_CRTC_INFO_GAMMA_SIZE | LIBGAMMA_CRTC_INFO_GAMMA_DEPTH);
+  passed &= (crtc.cached_red_gamma_size   == actual.red_gamma_size);
+  passed &= (crtc.cached_green_gamma_size == actual.green_gamma_size);
+  passed &= (crtc.cached_blue_gamma_size  == actual.blue_gamma_size);
+  passed &= (crtc.cached_gamma_depth      == actual.gamma_depth);
+  report("Caching the gamma ramp sizes and depth", passed);
+  
+  /* The cached values are used, so if they are changed, the changed values are returned. */
+  crtc.cached_red_gamma_size = actual.red_gamma_size + 1;
+  crtc.cached_gamma_depth = actual.gamma_depth == 8 ? 16 : 8;
+  passed = !libgamma_get_crtc_information(&info, &crtc, LIBGAMMA_CRTC_INFO_GAMMA_SIZE |
+					  LIBGAMMA_CRTC_INFO_GAMMA_DEPTH);
+  passed &= (info.red_gamma_size == actual.red_gamma_size + 1) && (info.gamma_size_error == 0);
+  passed &= (info.green_gamma_size == actual.green_gamma_size);
+  passed &= (info.gamma_depth == crtc.cached_gamma_depth) && (info.gamma_depth_error == 0);
+  report("Reading cached gamma ramp sizes and depth", passed);
+  
+  /* `LIBGAMMA_CRTC_INFO_REFRESH` rereads the information and caches it. */
+  passed = !libgamma_get_crtc_information(&info, &crtc, LIBGAMMA_CRTC_INFO_GAMMA_SIZE |
+					  LIBGAMMA_CRTC_INFO_REFRESH);
+  passed &= (info.red_gamma_size == actual.red_gamma_size);
+  passed &= (crtc.cached_red_gamma_size == actual.red_gamma_size);
+  passed &= crtc.cached == LIBGAMMA_CRTC_INFO_GAMMA_SIZE;
+  passed &= !libgamma_get_crtc_information(&info, &crtc, LIBGAMMA_CRTC_INFO_GAMMA_DEPTH);
+  passed &= (info.gamma_depth == actual.gamma_depth);
+  report("LIBGAMMA_CRTC_INFO_REFRESH", passed);
+  
+  /* `libgamma_site_invalidate` discards the cached information. */
+  crtc.cached_red_gamma_size = actual.red_gamma_size + 1;
+  libgamma_site_invalidate(&site);
+  passed = !libgamma_get_crtc_information(&info, &crtc, LIBGAMMA_CRTC_INFO_GAMMA_SIZE);
+  passed &= (info.red_gamma_size == actual.red_gamma_size);
+  passed &= crtc.cached == LIBGAMMA_CRTC_INFO_GAMMA_SIZE;
+  passed &= crtc.cached_generation == site.generation;
+  report("libgamma_site_invalidate", passed);
+  
+  libgamma_crtc_destroy(&crtc);
+ done_partition:
+  libgamma_partition_destroy(&partition);
+ done_site:
+  libgamma_site_destroy(&site);
+  printf("\n");
+}
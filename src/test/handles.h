@@ -0,0 +1,44 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBGAMMA_TEST_HANDLES_H
+#define LIBGAMMA_TEST_HANDLES_H
+
+
+#include <libgamma.h>
+
+#include <stdio.h>
+#include <string.h>
+
+
+/**
+ * Test CRTC handles, and refreshing partition and
+ * CRTC states, with the dummy adjustment method.
+ */
+void crtc_handles(void);
+
+/**
+ * Test that the gamma ramp sizes and depth are cached in the
+ * CRTC state, and that the cache is discarded after
+ * `libgamma_site_invalidate` and with `LIBGAMMA_CRTC_INFO_REFRESH`,
+ * with the dummy adjustment method.
+ */
+void crtc_information_cache(void);
+
+
+#endif
+
@@ -15,9 +15,23 @@
  * You should have received a copy of the GNU General Public License
  * along with this library.  If not, see <http://www.gnu.org/licenses/>.
  */
+#define _POSIX_C_SOURCE 200809L
+
 #include "methods.h"
 
 
+/**
+ * Print whether a test passed.
+ * 
+ * @param  description  A description of the test.
+ * @param  passed       Whether the test passed.
+ */
+static void report(const char* description, int passed)
+{
+  printf("  %s: %s\n", description, passed ? "passed" : "failed");
+}
+
+
 /**
  * Get the name representation of an
  * adjustment method by its identifier.
@@ -183,3 +197,254 @@ void method_capabilities(void)
       }
 }
 
+
+
+/**
+ * Check whether two sets of adjustment method capabilities are equal.
+ * 
+ * @param   a  One of the sets of capabilities.
+ * @param   b  The other set of capabilities.
+ * @return     Whether the capabilities are equal.
+ */
+static int same_capabilities(const libgamma_method_capabilities_t* a, const libgamma_method_capabilities_t* b)
+{
+  return (a->crtc_information              == b->crtc_information)              &&
+         (a->default_site_known            == b->default_site_known)            &&
+         (a->multiple_sites                == b->multiple_sites)                &&
+         (a->multiple_partitions           == b->multiple_partitions)           &&
+         (a->multiple_crtcs                == b->multiple_crtcs)                &&
+         (a->partitions_are_graphics_cards == b->partitions_are_graphics_cards) &&
+         (a->site_restore                  == b->site_restore)                  &&
+         (a->partition_restore             == b->partition_restore)             &&
+         (a->crtc_restore                  == b->crtc_restore)                  &&
+         (a->identical_gamma_sizes         == b->identical_gamma_sizes)         &&
+         (a->fixed_gamma_size              == b->fixed_gamma_size)              &&
+         (a->fixed_gamma_depth             == b->fixed_gamma_depth)             &&
+         (a->real                          == b->real)                          &&
+         (a->fake                          == b->fake)                          &&
+         (a->auto_restore                  == b->auto_restore)                  &&
+         (a->atomic_transactions           == b->atomic_transactions);
+}
+
+
+/**
+ * Check whether an adjustment method is in a list of adjustment methods.
+ * 
+ * @param   methods  The list of adjustment methods.
+ * @param   n        The number of adjustment methods in `methods`.
+ * @param   method   The adjustment method.
+ * @return           Whether `method` is in `methods`.
+ */
+static int has_method(const int* methods, size_t n, int method)
+{
+  size_t i;
+  for (i = 0; i < n; i++)
+    if (methods[i] == method)
+      return 1;
+  return 0;
+}
+
+
+/**
+ * Test that the cached results of `libgamma_method_capabilities`
+ * and `libgamma_list_methods` are the same as when they are
+ * read again after `libgamma_methods_invalidate`, and that the
+ * lists agree with the capabilities.
+ */
+void method_cache(void)
+{
+  libgamma_method_capabilities_t caps, cached;
+  int methods[LIBGAMMA_METHOD_COUNT], again[LIBGAMMA_METHOD_COUNT];
+  int method, operation, passed;
+  size_t n, m;
+  char* display;
+  
+  printf("Testing cached adjustment method information:\n");
+  
+  passed = 1;
+  for (method = -1; method <= LIBGAMMA_METHOD_COUNT; method++)
+    {
+      libgamma_methods_invalidate();
+      libgamma_method_capabilities(&caps, method);
+      libgamma_method_capabilities(&cached, method);
+      passed &= same_capabilities(&caps, &cached);
+      libgamma_methods_invalidate();
+      libgamma_method_capabilities(&cached, method);
+      passed &= same_capabilities(&caps, &cached);
+    }
+  report("libgamma_method_capabilities", passed);
+  
+  passed = 1;
+  for (operation = 0; operation <= 4; operation++)
+    {
+      libgamma_methods_invalidate();
+      n = libgamma_list_methods(methods, LIBGAMMA_METHOD_COUNT, operation);
+      m = libgamma_list_methods(again, LIBGAMMA_METHOD_COUNT, operation);
+      passed &= (n <= LIBGAMMA_METHOD_COUNT) && (n == m);
+      passed &= !memcmp(methods, again, n * sizeof(int));
+      /* A short buffer gets the beginning of the list, and the count is unchanged. */
+      again[0] = -1;
+      passed &= libgamma_list_methods(again, 0, operation) == n;
+      passed &= again[0] == -1;
+    }
+  report("libgamma_list_methods", passed);
+  
+  /* The lists agree with the cached capabilities. */
+  passed = 1;
+  n = libgamma_list_methods(methods, LIBGAMMA_METHOD_COUNT, 4);
+  for (method = 0; method < LIBGAMMA_METHOD_COUNT; method++)
+    {
+      libgamma_method_capabilities(&caps, method);
+      passed &= has_method(methods, n, method) == libgamma_is_method_available(method);
+      m = libgamma_list_methods(again, LIBGAMMA_METHOD_COUNT, 3);
+      passed &= has_method(again, m, method) == (has_method(methods, n, method) && caps.real);
+      m = libgamma_list_methods(again, LIBGAMMA_METHOD_COUNT, 2);
+      passed &= has_method(again, m, method) == (has_method(methods, n, method) && caps.real && !caps.fake);
+    }
+  report("Lists of adjustment methods and capabilities", passed);
+  
+  /* The X adjustment methods know their default site if `DISPLAY` is set, a change
+     is not seen until the cache has been invalidated. */
+  method = libgamma_is_method_available(LIBGAMMA_METHOD_X_RANDR)   ? LIBGAMMA_METHOD_X_RANDR :
+           libgamma_is_method_available(LIBGAMMA_METHOD_X_VIDMODE) ? LIBGAMMA_METHOD_X_VIDMODE : -1;
+  display = getenv("DISPLAY");
+  if (method < 0)
+    printf("  libgamma_methods_invalidate: skipped, no X adjustment method is available\n");
+  else if ((display != NULL) && ((display = strdup(display)) == NULL))
+    perror("  libgamma_methods_invalidate: skipped, strdup");
+  else
+    {
+      setenv("DISPLAY", ":0", 1);
+      libgamma_methods_invalidate();
+      libgamma_method_capabilities(&caps, method);
+      passed = caps.default_site_known == 1;
+      unsetenv("DISPLAY");
+      libgamma_method_capabilities(&caps, method);
+      passed &= caps.default_site_known == 1;
+      libgamma_methods_invalidate();
+      libgamma_method_capabilities(&caps, method);
+      passed &= caps.default_site_known == 0;
+      if (display != NULL)
+	setenv("DISPLAY", display, 1);
+      free(display);
+      libgamma_methods_invalidate();
+      report("libgamma_methods_invalidate", passed);
+    }
+  
+  printf("\n");
+}
+
+
+/**
+ * Test that sites are given the implementations of their adjustment
+ * method's functions, and that the implementations are complete.
+ */
+void method_dispatch(void)
+{
+  libgamma_site_state_t site;
+  libgamma_partition_state_t partition;
+  libgamma_crtc_state_t crtc;
+  libgamma_crtc_information_t info;
+  libgamma_gamma_ramps16_t ramps, read;
+  libgamma_gamma_ramps_any_t any;
+  const libgamma_method_ops_t* ops;
+  size_t i;
+  int method, r, passed;
+  
+  printf("Testing adjustment method dispatch:\n");
+  
+  /* Adjustment methods that do not exist have no implementations. */
+  r = libgamma_site_initialise(&site, LIBGAMMA_METHOD_COUNT, NULL);
+  passed = (r == LIBGAMMA_NO_SUCH_ADJUSTMENT_METHOD) && (site.ops == NULL);
+  r = libgamma_site_initialise(&site, -1, NULL);
+  passed &= (r == LIBGAMMA_NO_SUCH_ADJUSTMENT_METHOD) && (site.ops == NULL);
+  report("Non-existing adjustment methods", passed);
+  
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      printf("  skipped, the dummy adjustment method is not available\n\n");
+      return;
+    }
+  
+  /* Every available adjustment method implements the functions that are not optional,
+     and can read and write gamma ramps of the depth it uses for other depths. */
+  passed = 1;
+  for (method = 0; method < LIBGAMMA_METHOD_COUNT; method++)
+    {
+      if (!libgamma_is_method_available(method))
+	continue;
+      /* The implementations are selected even if the site cannot be initialised. */
+      r = libgamma_site_initialise(&site, method, NULL);
+      ops = site.ops;
+      if (!r)
+	libgamma_site_destroy(&site);
+      passed &= (ops != NULL) && (ops->method == method);
+      passed = passed &&
+	(ops->site_initialise != NULL) && (ops->site_destroy != NULL) && (ops->site_restore != NULL) &&
+	(ops->partition_initialise != NULL) && (ops->partition_destroy != NULL) &&
+	(ops->partition_restore != NULL) && (ops->crtc_initialise != NULL) &&
+	(ops->crtc_destroy != NULL) && (ops->crtc_restore != NULL) &&
+	(ops->get_crtc_information != NULL) && (ops->method_capabilities != NULL) &&
+	(ops->get[LIBGAMMA_DEPTH_INDEX(ops->depth)] != NULL) &&
+	(ops->set[LIBGAMMA_DEPTH_INDEX(ops->depth)] != NULL) &&
+	((ops->site_event_fd == NULL) == (ops->site_process_events == NULL));
+    }
+  report("Implementations of the adjustment methods", passed);
+  
+  /* The dummy adjustment method supports every depth but half precision
+     natively, so the gamma ramps go directly to and from its implementations. */
+  if ((r = libgamma_site_initialise(&site, LIBGAMMA_METHOD_DUMMY, NULL)))
+    {
+      libgamma_perror("  skipped, libgamma_site_initialise", r);
+      printf("\n");
+      return;
+    }
+  if ((r = libgamma_partition_initialise(&partition, &site, 0)))
+    {
+      libgamma_perror("  skipped, libgamma_partition_initialise", r);
+      printf("\n");
+      goto done_site;
+    }
+  if ((r = libgamma_crtc_initialise(&crtc, &partition, 0)))
+    {
+      libgamma_perror("  skipped, libgamma_crtc_initialise", r);
+      printf("\n");
+      goto done_partition;
+    }
+  ops = site.ops;
+  passed = ops->depth_per_crtc != 0;
+  for (i = 0; i < LIBGAMMA_DEPTH_COUNT; i++)
+    passed &= (ops->get[i] != NULL) == (i != LIBGAMMA_DEPTH_INDEX(-3));
+  for (i = 0; i < LIBGAMMA_DEPTH_COUNT; i++)
+    passed &= (ops->set[i] != NULL) == (i != LIBGAMMA_DEPTH_INDEX(-3));
+  if (passed && (passed = !libgamma_get_crtc_information(&info, &crtc, LIBGAMMA_CRTC_INFO_GAMMA_SIZE)))
+    {
+      ramps.red_size   = read.red_size   = info.red_gamma_size;
+      ramps.green_size = read.green_size = info.green_gamma_size;
+      ramps.blue_size  = read.blue_size  = info.blue_gamma_size;
+      passed = !libgamma_gamma_ramps16_initialise(&ramps);
+      if (passed && !(passed = !libgamma_gamma_ramps16_initialise(&read)))
+	libgamma_gamma_ramps16_destroy(&ramps);
+    }
+  if (passed)
+    {
+      for (i = 0; i < ramps.red_size; i++)    ramps.red[i]   = (uint16_t)(i * 11);
+      for (i = 0; i < ramps.green_size; i++)  ramps.green[i] = (uint16_t)(i * 13);
+      for (i = 0; i < ramps.blue_size; i++)   ramps.blue[i]  = (uint16_t)(i * 17);
+      any.bits16 = ramps;
+      passed &= !ops->set[LIBGAMMA_DEPTH_INDEX(16)](&crtc, any);
+      passed &= !libgamma_crtc_get_gamma_ramps16(&crtc, &read);
+      passed &= !memcmp(read.red, ramps.red, ramps.red_size * sizeof(uint16_t));
+      passed &= !memcmp(read.blue, ramps.blue, ramps.blue_size * sizeof(uint16_t));
+      libgamma_gamma_ramps16_destroy(&read);
+      libgamma_gamma_ramps16_destroy(&ramps);
+    }
+  report("Native gamma ramp depths", passed);
+  
+  libgamma_crtc_destroy(&crtc);
+ done_partition:
+  libgamma_partition_destroy(&partition);
+ done_site:
+  libgamma_site_destroy(&site);
+  printf("\n");
+}
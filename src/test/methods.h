@@ -20,9 +20,11 @@
 
 
 #include <libgamma.h>
+#include "gamma-helper.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 #ifndef __GCC__
@@ -75,6 +77,20 @@ void list_default_sites(void);
  */
 void method_capabilities(void);
 
+/**
+ * Test that the cached results of `libgamma_method_capabilities`
+ * and `libgamma_list_methods` are the same as when they are
+ * read again after `libgamma_methods_invalidate`, and that the
+ * lists agree with the capabilities.
+ */
+void method_cache(void);
+
+/**
+ * Test that sites are given the implementations of their adjustment
+ * method's functions, and that the implementations are complete.
+ */
+void method_dispatch(void);
+
 
 #endif
 
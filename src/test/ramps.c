@@ -18,6 +18,18 @@
 #include "ramps.h"
 
 
+/**
+ * Print whether a test passed.
+ * 
+ * @param  description  A description of the test.
+ * @param  passed       Whether the test passed.
+ */
+static void report(const char* description, int passed)
+{
+  printf("  %s: %s\n", description, passed ? "passed" : "failed");
+}
+
+
 /**
  * Test mapping function from [0, 1] float encoding value to [0, 2⁸ − 1] integer output value.
  * 
@@ -82,12 +94,12 @@ uint64_t invert_ramps64(float encoding)
 {
   double i_encoding = (double)(1.f - encoding);
   double f_output = ((double)UINT64_MAX) * i_encoding;
-  uint64_t output = (uint64_t)f_output;
-  if ((i_encoding < (double)(0.25f)) && (output > UINT64_MAX / 2))
-    output = 0;
-  if ((i_encoding > (double)(0.75f)) && (output < UINT64_MAX / 2))
-    output = UINT64_MAX;
-  return output;
+  /* `(double)UINT64_MAX` is 2⁶⁴, which does not fit in an `uint64_t`,
+     and converting it is undefined, it does not give the same value
+     when the conversion is vectorised. */
+  if (f_output >= (double)UINT64_MAX)
+    return UINT64_MAX;
+  return (uint64_t)f_output;
 }
 
 /**
@@ -113,3 +125,1346 @@ double invert_rampsd(double encoding)
   return ((double)1.f) - encoding;
 }
 
+
+/**
+ * Test mapping function from [0, 1] float encoding value to [0, 1] float
+ * output value, for half precision floating point gamma ramps.
+ * 
+ * @param   encoding  [0, 1] float encoding value.
+ * @return            [0, 1] float output value.
+ */
+float invert_rampsh(float encoding)
+{
+  return 1.f - encoding;
+}
+
+
+/**
+ * Test allocating and releasing gamma ramps, with stops
+ * from the library's pool and with stops from `malloc`.
+ */
+void gamma_ramp_allocation(void)
+{
+  libgamma_gamma_ramps16_t ramps, copy;
+  libgamma_gamma_ramps16_t* allocated;
+  uint16_t* stops;
+  int passed;
+  
+  printf("Testing gamma ramp allocation:\n");
+  
+  /* Released stops are kept in the pool and reused. */
+  ramps.red_size = ramps.green_size = ramps.blue_size = 256;
+  passed = !libgamma_gamma_ramps16_initialise(&ramps);
+  if (passed)
+    {
+      passed &= ((uintptr_t)(ramps.red) % 64) == 0;
+      passed &= (ramps.green == ramps.red + 256) && (ramps.blue == ramps.green + 256);
+      stops = ramps.red;
+      libgamma_gamma_ramps16_destroy(&ramps);
+      passed &= !libgamma_gamma_ramps16_initialise(&ramps) && (ramps.red == stops);
+      libgamma_gamma_ramps16_destroy(&ramps);
+    }
+  report("Pooled stops", passed);
+  
+  /* Stops from `malloc` are released with `free`, even if the
+     structure is copied from gamma ramps with pooled stops. */
+  passed = !libgamma_gamma_ramps16_initialise(&ramps);
+  if (passed)
+    {
+      copy = ramps;
+      if ((copy.red = malloc(3 * 256 * sizeof(uint16_t))) == NULL)
+	passed = 0;
+      else
+	{
+	  copy.green = copy.red + 256;
+	  copy.blue = copy.green + 256;
+	  libgamma_gamma_ramps16_destroy(&copy);
+	}
+      libgamma_gamma_ramps16_destroy(&ramps);
+    }
+  if (passed && ((allocated = malloc(sizeof(*allocated))) != NULL))
+    {
+      allocated->red_size = allocated->green_size = allocated->blue_size = 16;
+      if ((allocated->red = malloc(3 * 16 * sizeof(uint16_t))) == NULL)
+	passed = 0, free(allocated);
+      else
+	{
+	  allocated->green = allocated->red + 16;
+	  allocated->blue = allocated->green + 16;
+	  allocated->pool_tag = 0;
+	  libgamma_gamma_ramps16_free(allocated);
+	}
+    }
+  report("Stops allocated with malloc", passed);
+  
+  printf("\n");
+}
+
+
+/**
+ * Allocation function that counts live allocations.
+ * 
+ * @param   size       The number of bytes to allocate.
+ * @param   user_data  The number of live allocations, as a `size_t*`.
+ * @return             The allocation, `NULL` on error.
+ */
+static void* counted_allocate(size_t size, void* user_data)
+{
+  void* ptr = malloc(size);
+  if (ptr != NULL)
+    *(size_t*)user_data += 1;
+  return ptr;
+}
+
+
+/**
+ * Reallocation function that counts live allocations.
+ * 
+ * @param   ptr        The allocation to resize.
+ * @param   size       The new size of the allocation.
+ * @param   user_data  The number of live allocations, as a `size_t*`.
+ * @return             The allocation, `NULL` on error.
+ */
+static void* counted_reallocate(void* ptr, size_t size, void* user_data)
+{
+  void* new = realloc(ptr, size);
+  if ((ptr == NULL) && (new != NULL))
+    *(size_t*)user_data += 1;
+  return new;
+}
+
+
+/**
+ * Deallocation function that counts live allocations.
+ * 
+ * @param  ptr        The allocation to release.
+ * @param  user_data  The number of live allocations, as a `size_t*`.
+ */
+static void counted_deallocate(void* ptr, void* user_data)
+{
+  if (ptr != NULL)
+    *(size_t*)user_data -= 1;
+  free(ptr);
+}
+
+
+/**
+ * Test selecting the allocator the library uses,
+ * and the accounting of allocated memory.
+ */
+void custom_allocator(void)
+{
+  libgamma_allocator_t allocator, incomplete;
+  libgamma_site_state_t site;
+  libgamma_partition_state_t partition;
+  libgamma_crtc_state_t crtc;
+  libgamma_crtc_information_t info;
+  size_t live = 0, before, bytes;
+  int r, passed;
+  
+  printf("Testing custom allocators:\n");
+  
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      printf("  skipped, the dummy adjustment method is not available\n\n");
+      return;
+    }
+  
+  allocator.allocate   = counted_allocate;
+  allocator.reallocate = counted_reallocate;
+  allocator.deallocate = counted_deallocate;
+  allocator.user_data  = &live;
+  incomplete = allocator, incomplete.deallocate = NULL;
+  r = libgamma_set_allocator(&incomplete);
+  report("Incomplete allocator", (r == -1) && (errno == EINVAL));
+  
+  if (libgamma_set_allocator(&allocator))
+    {
+      perror("  skipped, libgamma_set_allocator");
+      printf("\n");
+      return;
+    }
+  report("No allocated memory", libgamma_allocated_bytes() == 0);
+  
+  if ((r = libgamma_site_initialise(&site, LIBGAMMA_METHOD_DUMMY, NULL)))
+    {
+      libgamma_perror("  skipped, libgamma_site_initialise", r);
+      goto done;
+    }
+  if ((r = libgamma_partition_initialise(&partition, &site, 0)))
+    {
+      libgamma_perror("  skipped, libgamma_partition_initialise", r);
+      goto done_site;
+    }
+  if ((r = libgamma_crtc_initialise(&crtc, &partition, 0)))
+    {
+      libgamma_perror("  skipped, libgamma_crtc_initialise", r);
+      goto done_partition;
+    }
+  report("Allocating with the allocator", (live > 0) && (libgamma_allocated_bytes() > 0));
+  
+  r = libgamma_set_allocator(NULL);
+  report("Changing the allocator with allocated memory", (r == -1) && (errno == EBUSY));
+  
+  /* Memory handed over to the user is not counted, but it
+     is released with the allocator that allocated it. */
+  libgamma_get_crtc_information(&info, &crtc, LIBGAMMA_CRTC_INFO_GAMMA_DEPTH);
+  before = live, bytes = libgamma_allocated_bytes();
+  info.edid = libgamma_unhex_edid("00FFFFFFFFFFFF00");
+  info.edid_length = 8;
+  passed = (info.edid != NULL) && (live == before + 1) && (libgamma_allocated_bytes() == bytes);
+  report("Handing over memory", passed);
+  
+  libgamma_crtc_destroy(&crtc);
+  libgamma_partition_destroy(&partition);
+  libgamma_site_destroy(&site);
+  passed = !libgamma_set_allocator(NULL) && (libgamma_allocated_bytes() == 0) && (live == 1);
+  report("Changing the allocator without allocated memory", passed);
+  libgamma_crtc_information_destroy(&info);
+  report("Releasing handed over memory", live == 0);
+  printf("\n");
+  return;
+  
+ done_partition:
+  libgamma_partition_destroy(&partition);
+ done_site:
+  libgamma_site_destroy(&site);
+ done:
+  libgamma_set_allocator(NULL);
+  printf("\n");
+}
+
+
+/**
+ * The largest error allowed in stops that have
+ * been stored with 64 bits and read as `double`:s.
+ */
+#define DBL_TOLERANCE  ((double)FLT_EPSILON * (double)FLT_EPSILON)
+
+
+/**
+ * Check that a gamma ramp is a straight line from 0 to 1.
+ * 
+ * @param   stops      The stops of the gamma ramp.
+ * @param   n          The number of stops, at least 2.
+ * @param   tolerance  The largest allowed error.
+ * @return             Whether the gamma ramp is a straight line.
+ */
+static int is_line(const double* stops, size_t n, double tolerance)
+{
+  double error;
+  size_t i;
+  for (i = 0; i < n; i++)
+    {
+      error = stops[i] - (double)i / (double)(n - 1);
+      if ((error > tolerance) || (-error > tolerance))
+	return 0;
+    }
+  return 1;
+}
+
+
+/**
+ * Check that a gamma ramp is a symmetric, monotone step from 0 to 1,
+ * that stays within [0, 1].
+ * 
+ * @param   stops      The stops of the gamma ramp.
+ * @param   n          The number of stops, at least 2.
+ * @param   tolerance  The largest allowed asymmetry.
+ * @return             Whether the gamma ramp is such a step.
+ */
+static int is_step(const double* stops, size_t n, double tolerance)
+{
+  double error;
+  size_t i;
+  if ((stops[0] < 0) || (stops[0] > tolerance) || (stops[n - 1] > 1) || (stops[n - 1] < 1 - tolerance))
+    return 0;
+  for (i = 1; i < n; i++)
+    {
+      if ((stops[i] < stops[i - 1]) || (stops[i] > 1))
+	return 0;
+      error = stops[i] + stops[n - 1 - i] - 1;
+      if ((error > tolerance) || (-error > tolerance))
+	return 0;
+    }
+  return 1;
+}
+
+
+/**
+ * Read the gamma ramps of a CRTC, without resampling them,
+ * as `double`:s.
+ * 
+ * @param   crtc   The CRTC.
+ * @param   info   The CRTC's gamma ramp sizes.
+ * @param   ramps  Output parameter for the gamma ramps, they shall be
+ *                 released with `libgamma_gamma_rampsd_destroy` on success.
+ * @return         Zero on success, otherwise (negative) the value of an
+ *                 error identifier provided by this library.
+ */
+static int read_ramps(libgamma_crtc_state_t* crtc, const libgamma_crtc_information_t* info,
+		      libgamma_gamma_rampsd_t* ramps)
+{
+  libgamma_resample_mode_t mode = crtc->resample;
+  int r;
+  ramps->red_size   = info->red_gamma_size;
+  ramps->green_size = info->green_gamma_size;
+  ramps->blue_size  = info->blue_gamma_size;
+  if ((r = libgamma_gamma_rampsd_initialise(ramps)))
+    return r;
+  crtc->resample = LIBGAMMA_RESAMPLE_NONE;
+  if ((r = libgamma_crtc_get_gamma_rampsd(crtc, ramps)))
+    libgamma_gamma_rampsd_destroy(ramps);
+  crtc->resample = mode;
+  return r;
+}
+
+
+/**
+ * Test resampling gamma ramps whose sizes differ from the
+ * CRTC's, with the dummy adjustment method, at points where
+ * the interpolated values are known.
+ */
+void gamma_ramp_resampling(void)
+{
+  libgamma_site_state_t site;
+  libgamma_partition_state_t partition;
+  libgamma_crtc_state_t crtc;
+  libgamma_crtc_information_t info;
+  libgamma_gamma_rampsd_t line, read;
+  libgamma_gamma_rampsf_t line_f;
+  libgamma_gamma_ramps16_t step;
+  libgamma_gamma_rampsh_t small;
+  size_t i;
+  int r, passed;
+  
+  printf("Testing gamma ramp resampling:\n");
+  
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      printf("  skipped, the dummy adjustment method is not available\n\n");
+      return;
+    }
+  if ((r = libgamma_site_initialise(&site, LIBGAMMA_METHOD_DUMMY, NULL)))
+    {
+      libgamma_perror("  skipped, libgamma_site_initialise", r);
+      printf("\n");
+      return;
+    }
+  if ((r = libgamma_partition_initialise(&partition, &site, 0)))
+    {
+      libgamma_perror("  skipped, libgamma_partition_initialise", r);
+      goto done_site;
+    }
+  if ((r = libgamma_crtc_initialise(&crtc, &partition, 0)))
+    {
+      libgamma_perror("  skipped, libgamma_crtc_initialise", r);
+      goto done_partition;
+    }
+  if ((r = libgamma_get_crtc_information(&info, &crtc, LIBGAMMA_CRTC_INFO_GAMMA_SIZE)))
+    {
+      libgamma_perror("  skipped, libgamma_get_crtc_information", info.gamma_size_error);
+      goto done_crtc;
+    }
+  
+  /* Two stops are interpolated linearly into a straight line. */
+  line.red_size = line.green_size = line.blue_size = 2;
+  passed = !libgamma_gamma_rampsd_initialise(&line);
+  if (passed)
+    {
+      line.red[0] = line.green[0] = line.blue[0] = 0;
+      line.red[1] = line.green[1] = line.blue[1] = 1;
+      crtc.resample = LIBGAMMA_RESAMPLE_LINEAR;
+      passed = !libgamma_crtc_set_gamma_rampsd(&crtc, line);
+      libgamma_gamma_rampsd_destroy(&line);
+    }
+  if (passed && (passed = !read_ramps(&crtc, &info, &read)))
+    {
+      passed &= is_line(read.red, read.red_size, DBL_TOLERANCE);
+      passed &= is_line(read.green, read.green_size, DBL_TOLERANCE);
+      passed &= is_line(read.blue, read.blue_size, DBL_TOLERANCE);
+      libgamma_gamma_rampsd_destroy(&read);
+    }
+  report("Linear resampling", passed);
+  
+  /* The CRTC's straight line is resampled down when read, the middle
+     stop is exactly 0.5, which half precision can represent exactly. */
+  small.red_size = small.green_size = small.blue_size = 3;
+  passed = !libgamma_gamma_rampsh_initialise(&small);
+  if (passed)
+    {
+      passed = !libgamma_crtc_get_gamma_rampsh(&crtc, &small);
+      for (i = 0; passed && (i < 3); i++)
+	passed &= (small.red[i]   == libgamma_float_to_half((float)i / 2.f)) &&
+	          (small.green[i] == libgamma_float_to_half((float)i / 2.f)) &&
+	          (small.blue[i]  == libgamma_float_to_half((float)i / 2.f));
+      libgamma_gamma_rampsh_destroy(&small);
+    }
+  report("Resampling when reading", passed);
+  
+  /* Monotone cubic interpolation reproduces a straight line exactly. */
+  line_f.red_size = line_f.green_size = line_f.blue_size = 5;
+  passed = !libgamma_gamma_rampsf_initialise(&line_f);
+  if (passed)
+    {
+      for (i = 0; i < 5; i++)
+	line_f.red[i] = line_f.green[i] = line_f.blue[i] = (float)i / 4.f;
+      crtc.resample = LIBGAMMA_RESAMPLE_MONOTONE_CUBIC;
+      passed = !libgamma_crtc_set_gamma_rampsf(&crtc, line_f);
+      libgamma_gamma_rampsf_destroy(&line_f);
+    }
+  if (passed && (passed = !read_ramps(&crtc, &info, &read)))
+    {
+      passed &= is_line(read.red, read.red_size, (double)FLT_EPSILON);
+      passed &= is_line(read.green, read.green_size, (double)FLT_EPSILON);
+      passed &= is_line(read.blue, read.blue_size, (double)FLT_EPSILON);
+      libgamma_gamma_rampsd_destroy(&read);
+    }
+  report("Monotone cubic resampling of a straight line", passed);
+  
+  /* Monotone cubic interpolation of a step neither overshoots nor undershoots,
+     the stops are truncated to 16 bits, so the step is symmetric to within
+     a couple of units in the last place. */
+  step.red_size = step.green_size = step.blue_size = 4;
+  passed = !libgamma_gamma_ramps16_initialise(&step);
+  if (passed)
+    {
+      step.red[0] = step.green[0] = step.blue[0] = 0;
+      step.red[1] = step.green[1] = step.blue[1] = 0;
+      step.red[2] = step.green[2] = step.blue[2] = UINT16_MAX;
+      step.red[3] = step.green[3] = step.blue[3] = UINT16_MAX;
+      passed = !libgamma_crtc_set_gamma_ramps16(&crtc, step);
+      libgamma_gamma_ramps16_destroy(&step);
+    }
+  if (passed && (passed = !read_ramps(&crtc, &info, &read)))
+    {
+      passed &= is_step(read.red, read.red_size, 2 / (double)UINT16_MAX);
+      passed &= is_step(read.green, read.green_size, 2 / (double)UINT16_MAX);
+      passed &= is_step(read.blue, read.blue_size, 2 / (double)UINT16_MAX);
+      libgamma_gamma_rampsd_destroy(&read);
+    }
+  report("Monotone cubic resampling of a step", passed);
+  
+ done_crtc:
+  libgamma_crtc_destroy(&crtc);
+ done_partition:
+  libgamma_partition_destroy(&partition);
+ done_site:
+  libgamma_site_destroy(&site);
+  printf("\n");
+}
+
+
+/**
+ * Initialise a site, partition and CRTC with the dummy adjustment method.
+ * 
+ * @param   site       Output parameter for the site.
+ * @param   partition  Output parameter for the partition.
+ * @param   crtc       Output parameter for the CRTC.
+ * @return             Zero on success, otherwise (negative) the value of an
+ *                     error identifier provided by this library, the
+ *                     error has been printed.
+ */
+static int dummy_crtc(libgamma_site_state_t* site, libgamma_partition_state_t* partition,
+		      libgamma_crtc_state_t* crtc)
+{
+  int r;
+  if ((r = libgamma_site_initialise(site, LIBGAMMA_METHOD_DUMMY, NULL)))
+    {
+      libgamma_perror("  skipped, libgamma_site_initialise", r);
+      return r;
+    }
+  if ((r = libgamma_partition_initialise(partition, site, 0)))
+    {
+      libgamma_perror("  skipped, libgamma_partition_initialise", r);
+      libgamma_site_destroy(site);
+      return r;
+    }
+  if ((r = libgamma_crtc_initialise(crtc, partition, 0)))
+    {
+      libgamma_perror("  skipped, libgamma_crtc_initialise", r);
+      libgamma_partition_destroy(partition);
+      libgamma_site_destroy(site);
+      return r;
+    }
+  return 0;
+}
+
+
+/**
+ * Translate stops to another depth with the library's translation
+ * kernels, by preparing gamma ramps from a view of the stops.
+ * 
+ * @param   crtc       The CRTC to prepare the gamma ramps for,
+ *                     it must not resample gamma ramps.
+ * @param   depth_out  The depth to translate the stops to.
+ * @param   depth_in   The depth of `in`.
+ * @param   in         The stops to translate.
+ * @param   n          The number of stops.
+ * @param   stride     The distance between the stops in `in`, in stops.
+ * @param   out        Output parameter for the prepared gamma ramps,
+ *                     the translated stops are in every channel.
+ * @return             Zero on success, otherwise (negative) the value of an
+ *                     error identifier provided by this library.
+ */
+static int translate_stops(libgamma_crtc_state_t* crtc, signed depth_out, signed depth_in,
+			   const void* in, size_t n, size_t stride, libgamma_gamma_ramps_prepared_t** out)
+{
+  libgamma_gamma_ramps_view_t view;
+  view.red_size   = view.green_size   = view.blue_size   = n;
+  view.red_stride = view.green_stride = view.blue_stride = stride;
+  view.red        = view.green        = view.blue        = in;
+  view.depth = depth_in;
+  return libgamma_view_ramp_prepare_(crtc, &view, depth_out, NULL, out);
+}
+
+
+/**
+ * Get the largest value of an integer depth.
+ * 
+ * @param   depth  The depth, 8, 16, 32 or 64.
+ * @return         The largest value the depth can hold.
+ */
+static uint64_t integer_max(signed depth)
+{
+  return UINT64_MAX >> (64 - depth);
+}
+
+
+/**
+ * Get the integer whose value is 1 at the lowest bit of every word
+ * of an integer depth in a 64-bit word, multiplying a value of that
+ * depth by it gives the same value in 64 bits.
+ * 
+ * @param   depth  The depth, 8, 16, 32 or 64.
+ * @return         The replicator for the depth.
+ */
+static uint64_t integer_replicator(signed depth)
+{
+  return UINT64_MAX / integer_max(depth);
+}
+
+
+/**
+ * Read a stop from an integer gamma ramp.
+ * 
+ * @param   stops  The stops.
+ * @param   depth  The depth of the stops, 8, 16, 32 or 64.
+ * @param   i      The index of the stop.
+ * @return         The value of the stop.
+ */
+static uint64_t integer_stop(const void* stops, signed depth, size_t i)
+{
+  switch (depth)
+    {
+    case 8:   return ((const uint8_t*)stops)[i];
+    case 16:  return ((const uint16_t*)stops)[i];
+    case 32:  return ((const uint32_t*)stops)[i];
+    default:  return ((const uint64_t*)stops)[i];
+    }
+}
+
+
+/**
+ * Write a stop to an integer gamma ramp.
+ * 
+ * @param  stops  The stops.
+ * @param  depth  The depth of the stops, 8, 16, 32 or 64.
+ * @param  i      The index of the stop.
+ * @param  value  The value of the stop, must fit in the depth.
+ */
+static void set_integer_stop(void* stops, signed depth, size_t i, uint64_t value)
+{
+  switch (depth)
+    {
+    case 8:   ((uint8_t*)stops)[i]  = (uint8_t)value;   break;
+    case 16:  ((uint16_t*)stops)[i] = (uint16_t)value;  break;
+    case 32:  ((uint32_t*)stops)[i] = (uint32_t)value;  break;
+    default:  ((uint64_t*)stops)[i] = value;            break;
+    }
+}
+
+
+/**
+ * Read a stop from any gamma ramp as a `double`.
+ * 
+ * @param   stops  The stops.
+ * @param   depth  The depth of the stops, `-1` for `float`, `-2` for `double`, `-3` for half.
+ * @param   i      The index of the stop.
+ * @return         The value of the stop, [0, 1] is the full range.
+ */
+static double unit_stop(const void* stops, signed depth, size_t i)
+{
+  uint64_t value, max;
+  switch (depth)
+    {
+    case -1:  return (double)((const float*)stops)[i];
+    case -2:  return ((const double*)stops)[i];
+    case -3:  return (double)libgamma_half_to_float(((const libgamma_float_half_t*)stops)[i]);
+    default:
+      value = integer_stop(stops, depth, i);
+      max = integer_max(depth);
+      return (double)value / (double)max;
+    }
+}
+
+
+/**
+ * Check whether two `double`:s are equal.
+ * 
+ * @param   a  One of the values.
+ * @param   b  The other value.
+ * @return     Whether `a` and `b` are equal.
+ */
+static int same(double a, double b)
+{
+  return !(a < b) && !(a > b);
+}
+
+
+/**
+ * Test translating gamma ramps between depths with the kernels
+ * that are generated for every pair of depths, both with packed
+ * and with interleaved input stops.
+ */
+void gamma_ramp_translation(void)
+{
+  static const signed integers[] = {8, 16, 32, 64};
+  static const signed floats[] = {-1, -2, -3};
+  static const signed depths[] = {8, 16, 32, 64, -1, -2, -3};
+  static const float values_f[] = {0, 1, -1, 2};
+  static const double values_d[] = {0, 1, -1, 2};
+  static const libgamma_float_half_t values_h[] = {0x0000, 0x3C00, 0xBC00, 0x4000};
+  const void* values[3];
+  libgamma_site_state_t site;
+  libgamma_partition_state_t partition;
+  libgamma_crtc_state_t crtc;
+  libgamma_gamma_ramps_prepared_t* prepared;
+  uint64_t value, expected;
+  void* stops = NULL;
+  size_t a, b, i, n = 67, stride;
+  signed from, to;
+  int passed;
+  
+  printf("Testing gamma ramp translation:\n");
+  
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      printf("  skipped, the dummy adjustment method is not available\n\n");
+      return;
+    }
+  if (dummy_crtc(&site, &partition, &crtc))
+    {
+      printf("\n");
+      return;
+    }
+  if ((stops = malloc(3 * n * sizeof(uint64_t))) == NULL)
+    {
+      perror("  skipped, malloc");
+      goto done;
+    }
+  
+  /* Between integer depths, the stops are translated as if through 64
+     bits, where narrower stops are replicated and wider stops truncated. */
+  passed = 1;
+  for (stride = 1; stride <= 3; stride += 2)
+    for (a = 0; a < 4; a++)
+      for (b = 0; b < 4; b++)
+	{
+	  from = integers[a], to = integers[b];
+	  memset(stops, 0xA5, 3 * n * sizeof(uint64_t));
+	  for (i = 0; i < n; i++)
+	    {
+	      value = i * 0x9E3779B97F4A7C15ULL >> (64 - from);
+	      value = i == n - 1 ? integer_max(from) : i == n - 2 ? integer_max(from) - 1 : value;
+	      set_integer_stop(stops, from, i * stride, value);
+	    }
+	  if (translate_stops(&crtc, to, from, stops, n, stride, &prepared))
+	    {
+	      passed = 0;
+	      continue;
+	    }
+	  for (i = 0; i < n; i++)
+	    {
+	      expected = integer_stop(stops, from, i * stride) * integer_replicator(from) / integer_replicator(to);
+	      passed &= integer_stop(prepared->ramps.bits64.red, to, i) == expected;
+	      passed &= integer_stop(prepared->ramps.bits64.blue, to, i) == expected;
+	    }
+	  libgamma_gamma_ramps_prepared_free(prepared);
+	}
+  report("Between integer depths", passed);
+  
+  /* From floating point depths, the stops are clamped to [0, 1],
+     except when half precision stops are copied as they are. */
+  values[0] = values_f, values[1] = values_d, values[2] = values_h;
+  passed = 1;
+  for (a = 0; a < 3; a++)
+    for (b = 0; b < 7; b++)
+      {
+	from = floats[a], to = depths[b];
+	if ((from == -3) && (to == -3))
+	  continue;
+	if (translate_stops(&crtc, to, from, values[a], 4, 1, &prepared))
+	  {
+	    passed = 0;
+	    continue;
+	  }
+	for (i = 0; i < 4; i++)
+	  passed &= same(unit_stop(prepared->ramps.bits64.red, to, i), (double)(i & 1));
+	libgamma_gamma_ramps_prepared_free(prepared);
+      }
+  report("From floating point depths", passed);
+  
+  /* To floating point depths, the full range of the integer depths is [0, 1]. */
+  passed = 1;
+  for (a = 0; a < 4; a++)
+    for (b = 0; b < 3; b++)
+      {
+	from = integers[a], to = floats[b];
+	set_integer_stop(stops, from, 0, 0);
+	set_integer_stop(stops, from, 1, integer_max(from));
+	if (translate_stops(&crtc, to, from, stops, 2, 1, &prepared))
+	  {
+	    passed = 0;
+	    continue;
+	  }
+	passed &= same(unit_stop(prepared->ramps.bits64.red, to, 0), 0);
+	passed &= same(unit_stop(prepared->ramps.bits64.red, to, 1), 1);
+	libgamma_gamma_ramps_prepared_free(prepared);
+      }
+  report("To floating point depths", passed);
+  
+ done:
+  free(stops);
+  libgamma_crtc_destroy(&crtc);
+  libgamma_partition_destroy(&partition);
+  libgamma_site_destroy(&site);
+  printf("\n");
+}
+
+
+/**
+ * Get the size of a stop.
+ * 
+ * @param   depth  The depth of the stop, `-1` for `float`, `-2` for `double`, `-3` for half.
+ * @return         The size of the stop, in bytes.
+ */
+static size_t stop_bytes(signed depth)
+{
+  return depth == -1 ? sizeof(float) : depth == -2 ? sizeof(double) :
+         depth == -3 ? sizeof(libgamma_float_half_t) : (size_t)depth / 8;
+}
+
+
+/**
+ * Check that stops are translated to the same values when they are
+ * packed, so that the vectorised kernels are used where there are
+ * any, as when they are interleaved, so that the scalar kernels are
+ * used.
+ * 
+ * @param   crtc       The CRTC to prepare the gamma ramps for,
+ *                     it must not resample gamma ramps.
+ * @param   depth_out  The depth to translate the stops to.
+ * @param   depth_in   The depth of `in`.
+ * @param   in         The stops to translate, packed.
+ * @param   n          The number of stops.
+ * @return             Whether the results are identical.
+ */
+static int same_translation(libgamma_crtc_state_t* crtc, signed depth_out, signed depth_in,
+			    const void* in, size_t n)
+{
+  libgamma_gamma_ramps_prepared_t* packed = NULL;
+  libgamma_gamma_ramps_prepared_t* interleaved = NULL;
+  size_t i, size = stop_bytes(depth_in);
+  char* stops;
+  int same = 0;
+  
+  if ((stops = calloc(2 * n, size)) == NULL)
+    return 0;
+  for (i = 0; i < n; i++)
+    memcpy(stops + 2 * i * size, (const char*)in + i * size, size);
+  
+  if (!translate_stops(crtc, depth_out, depth_in, in, n, 1, &packed) &&
+      !translate_stops(crtc, depth_out, depth_in, stops, n, 2, &interleaved))
+    same = !memcmp(packed->ramps.bits64.red, interleaved->ramps.bits64.red, n * stop_bytes(depth_out));
+  
+  libgamma_gamma_ramps_prepared_free(packed);
+  libgamma_gamma_ramps_prepared_free(interleaved);
+  free(stops);
+  return same;
+}
+
+
+/**
+ * Fill an integer gamma ramp with values spread over the
+ * whole range, ending with 0, 1, the second largest
+ * value and the largest value.
+ * 
+ * @param  stops  The stops.
+ * @param  depth  The depth of the stops, 8, 16, 32 or 64.
+ * @param  n      The number of stops, at least 4.
+ */
+static void fill_integers(void* stops, signed depth, size_t n)
+{
+  size_t i;
+  for (i = 0; i < n - 4; i++)
+    set_integer_stop(stops, depth, i, i * 0x9E3779B97F4A7C15ULL >> (64 - depth));
+  set_integer_stop(stops, depth, n - 4, 0);
+  set_integer_stop(stops, depth, n - 3, 1);
+  set_integer_stop(stops, depth, n - 2, integer_max(depth) - 1);
+  set_integer_stop(stops, depth, n - 1, integer_max(depth));
+}
+
+
+/**
+ * Test that the vectorised translation kernels give bit-identical
+ * results to the scalar kernels, for values at and next to the
+ * boundaries between integer values, for values outside [0, 1],
+ * and for every finite half precision value.
+ */
+void vectorised_translation(void)
+{
+  static const signed integers[] = {8, 16, 32};
+  static const signed others[] = {8, 16, 32, 64, -1, -2};
+  libgamma_site_state_t site;
+  libgamma_partition_state_t partition;
+  libgamma_crtc_state_t crtc;
+  float* values_f = NULL;
+  double* values_d = NULL;
+  libgamma_float_half_t* values_h = NULL;
+  void* values_i = NULL;
+  uint32_t bits_f;
+  uint64_t bits_d;
+  size_t a, i, n = 3 * 257 + 4, n_h = 1 << 16;
+  int passed;
+  
+  printf("Testing vectorised gamma ramp translation:\n");
+  
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      printf("  skipped, the dummy adjustment method is not available\n\n");
+      return;
+    }
+  if (dummy_crtc(&site, &partition, &crtc))
+    {
+      printf("\n");
+      return;
+    }
+  values_f = malloc(n * sizeof(float));
+  values_d = malloc(n * sizeof(double));
+  values_h = malloc(n_h * sizeof(libgamma_float_half_t));
+  values_i = malloc(n * sizeof(uint64_t));
+  if ((values_f == NULL) || (values_d == NULL) || (values_h == NULL) || (values_i == NULL))
+    {
+      perror("  skipped, malloc");
+      goto done;
+    }
+  
+  /* The boundaries between 8-bit values, and the values one unit in
+     the last place below and above them (below zero is the negative
+     value closest to zero), and then −0, −½, 1½ and 2¹⁶.
+     The number of stops is not a multiple of any vector width. NaN
+     and infinities are left out, the library is compiled with -Ofast,
+     so the scalar kernels are not required to handle them. */
+  for (i = 0; i < n - 4; i++)
+    {
+      values_f[i] = (float)(i % 257) / 256.f;
+      memcpy(&bits_f, values_f + i, sizeof(bits_f));
+      bits_f = bits_f ? (uint32_t)(bits_f + (i / 257) - 1) : i < 257 ? 0x80000001UL : (uint32_t)(i / 257 - 1);
+      memcpy(values_f + i, &bits_f, sizeof(bits_f));
+      values_d[i] = (double)(i % 257) / (double)65536;
+      memcpy(&bits_d, values_d + i, sizeof(bits_d));
+      bits_d = bits_d ? bits_d + (i / 257) - 1 : i < 257 ? 0x8000000000000001ULL : i / 257 - 1;
+      memcpy(values_d + i, &bits_d, sizeof(bits_d));
+    }
+  values_f[n - 4] = -0.f,         values_f[n - 3] = -.5f,         values_f[n - 2] = 1.5f;
+  values_d[n - 4] = (double)-0.f, values_d[n - 3] = (double)-.5f, values_d[n - 2] = (double)1.5f;
+  values_f[n - 1] = 65536.f,      values_d[n - 1] = (double)65536;
+  
+  /* Every finite half precision value. */
+  for (n_h = 0, i = 0; i < 1 << 16; i++)
+    if ((i & 0x7C00) != 0x7C00)
+      values_h[n_h++] = (libgamma_float_half_t)i;
+  
+  passed = 1;
+  for (a = 0; a < 3; a++)
+    {
+      passed &= same_translation(&crtc, integers[a], -1, values_f, n);
+      passed &= same_translation(&crtc, integers[a], -2, values_d, n);
+    }
+  report("From floating point to integer depths", passed);
+  
+  passed = 1;
+  for (a = 0; a < 3; a++)
+    {
+      fill_integers(values_i, integers[a], n);
+      passed &= same_translation(&crtc, -1, integers[a], values_i, n);
+      passed &= same_translation(&crtc, -2, integers[a], values_i, n);
+    }
+  report("From integer to floating point depths", passed);
+  
+  passed = 1;
+  for (a = 0; a < 6; a++)
+    passed &= same_translation(&crtc, others[a], -3, values_h, n_h);
+  passed &= same_translation(&crtc, -3, -1, values_f, n);
+  passed &= same_translation(&crtc, -3, -2, values_d, n);
+  for (a = 0; a < 3; a++)
+    {
+      fill_integers(values_i, integers[a], n);
+      passed &= same_translation(&crtc, -3, integers[a], values_i, n);
+    }
+  report("From and to half precision", passed);
+  
+ done:
+  free(values_f);
+  free(values_d);
+  free(values_h);
+  free(values_i);
+  libgamma_crtc_destroy(&crtc);
+  libgamma_partition_destroy(&partition);
+  libgamma_site_destroy(&site);
+  printf("\n");
+}
+
+
+/**
+ * Test that a CRTC that keeps its scratch buffer reuses it when
+ * gamma ramps are re-encoded, rather than allocating new memory,
+ * that it grows when needed, and that it is released when the
+ * CRTC stops keeping it.
+ */
+void scratch_buffer(void)
+{
+  libgamma_site_state_t site;
+  libgamma_partition_state_t partition;
+  libgamma_crtc_state_t crtc;
+  libgamma_crtc_information_t info;
+  libgamma_gamma_ramps_view_t view;
+  libgamma_gamma_ramps16_t read;
+  uint64_t* stops = NULL;
+  void* scratch;
+  size_t i, n, bytes;
+  int passed;
+  
+  printf("Testing scratch buffers:\n");
+  
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      printf("  skipped, the dummy adjustment method is not available\n\n");
+      return;
+    }
+  if (dummy_crtc(&site, &partition, &crtc))
+    {
+      printf("\n");
+      return;
+    }
+  if (libgamma_get_crtc_information(&info, &crtc, LIBGAMMA_CRTC_INFO_GAMMA_SIZE))
+    {
+      libgamma_perror("  skipped, libgamma_get_crtc_information", info.gamma_size_error);
+      goto done;
+    }
+  n = info.red_gamma_size + info.green_gamma_size + info.blue_gamma_size;
+  if ((stops = calloc(n, sizeof(uint64_t))) == NULL)
+    {
+      perror("  skipped, malloc");
+      goto done;
+    }
+  
+  /* Views of gamma ramps are always packed into temporary gamma ramps. */
+  for (i = 0; i < n; i++)
+    ((uint16_t*)stops)[i] = (uint16_t)(i * 0x9E37U);
+  view.red_size   = info.red_gamma_size,   view.red_stride   = 1, view.red   = stops;
+  view.green_size = info.green_gamma_size, view.green_stride = 1, view.green = (uint16_t*)stops + view.red_size;
+  view.blue_size  = info.blue_gamma_size,  view.blue_stride  = 1, view.blue  = (const uint16_t*)view.green + view.green_size;
+  view.depth = 16;
+  
+  crtc.keep_scratch = 1;
+  passed = !libgamma_crtc_set_gamma_ramps_view(&crtc, &view);
+  passed &= (crtc.scratch != NULL) && (crtc.scratch_size >= n * sizeof(uint16_t));
+  read.red_size = info.red_gamma_size, read.green_size = info.green_gamma_size, read.blue_size = info.blue_gamma_size;
+  if (passed && (passed = !libgamma_gamma_ramps16_initialise(&read)))
+    {
+      passed &= !libgamma_crtc_get_gamma_ramps16(&crtc, &read);
+      passed &= !memcmp(read.red, stops, n * sizeof(uint16_t));
+      libgamma_gamma_ramps16_destroy(&read);
+    }
+  report("Keeping the scratch buffer", passed);
+  
+  /* The dummy adjustment method re-encodes the gamma ramps once more,
+     with the same CRTC state, which allocates a second buffer the first
+     time a kept buffer is reused, after that nothing is allocated. */
+  passed = !libgamma_crtc_set_gamma_ramps_view(&crtc, &view);
+  scratch = crtc.scratch, bytes = libgamma_allocated_bytes();
+  for (i = 0; i < 3; i++)
+    passed &= !libgamma_crtc_set_gamma_ramps_view(&crtc, &view);
+  passed &= (crtc.scratch == scratch) && (libgamma_allocated_bytes() == bytes);
+  report("Reusing the scratch buffer", passed);
+  
+  view.depth = 64;
+  view.green = stops + view.red_size;
+  view.blue  = (const uint64_t*)view.green + view.green_size;
+  passed = !libgamma_crtc_set_gamma_ramps_view(&crtc, &view);
+  passed &= (crtc.scratch != NULL) && (crtc.scratch_size >= n * sizeof(uint64_t));
+  report("Growing the scratch buffer", passed);
+  
+  crtc.keep_scratch = 0;
+  passed = !libgamma_crtc_set_gamma_ramps_view(&crtc, &view);
+  passed &= (crtc.scratch == NULL) && (crtc.scratch_size == 0);
+  report("Releasing the scratch buffer", passed);
+  
+ done:
+  free(stops);
+  libgamma_crtc_destroy(&crtc);
+  libgamma_partition_destroy(&partition);
+  libgamma_site_destroy(&site);
+  printf("\n");
+}
+
+
+/**
+ * Test mapping function from [0, 1] float encoding value to a [0, 1]
+ * half precision floating point output value.
+ * 
+ * @param   encoding  [0, 1] float encoding value.
+ * @return            [0, 1] half precision floating point output value.
+ */
+static libgamma_float_half_t invert_rampsh_half(float encoding)
+{
+  return libgamma_float_to_half(invert_rampsh(encoding));
+}
+
+
+/**
+ * Create a function that applies gamma ramps with a specific
+ * depth to a CRTC and checks that they are read back unchanged.
+ * 
+ * @param  R       The name of the gamma ramps' depth, for example `rampsh`.
+ * @param  INVERT  Function that maps an encoding value to a stop.
+ */
+#define ROUND_TRIP(R, INVERT)						\
+  static int round_trip_##R(libgamma_crtc_state_t* crtc,		\
+			    const libgamma_crtc_information_t* info)	\
+  {									\
+    libgamma_gamma_##R##_t ramps, read;					\
+    size_t i;								\
+    int passed;								\
+    ramps.red_size   = read.red_size   = info->red_gamma_size;		\
+    ramps.green_size = read.green_size = info->green_gamma_size;	\
+    ramps.blue_size  = read.blue_size  = info->blue_gamma_size;		\
+    if (libgamma_gamma_##R##_initialise(&ramps))			\
+      return 0;								\
+    if (libgamma_gamma_##R##_initialise(&read))				\
+      return libgamma_gamma_##R##_destroy(&ramps), 0;			\
+    for (i = 0; i < ramps.red_size; i++)				\
+      ramps.red[i] = INVERT((float)i / (float)(ramps.red_size - 1));	\
+    for (i = 0; i < ramps.green_size; i++)				\
+      ramps.green[i] = INVERT((float)i / (float)(ramps.green_size - 1)); \
+    for (i = 0; i < ramps.blue_size; i++)				\
+      ramps.blue[i] = INVERT((float)i / (float)(ramps.blue_size - 1));	\
+    passed = !libgamma_crtc_set_gamma_##R(crtc, ramps);			\
+    passed = passed && !libgamma_crtc_get_gamma_##R(crtc, &read);	\
+    passed = passed &&							\
+      !memcmp(read.red, ramps.red, ramps.red_size * sizeof(*ramps.red)) && \
+      !memcmp(read.green, ramps.green, ramps.green_size * sizeof(*ramps.green)) && \
+      !memcmp(read.blue, ramps.blue, ramps.blue_size * sizeof(*ramps.blue)); \
+    libgamma_gamma_##R##_destroy(&ramps);				\
+    libgamma_gamma_##R##_destroy(&read);				\
+    return passed;							\
+  }
+
+ROUND_TRIP(ramps8, invert_ramps8)
+ROUND_TRIP(ramps16, invert_ramps16)
+ROUND_TRIP(ramps32, invert_ramps32)
+ROUND_TRIP(ramps64, invert_ramps64)
+ROUND_TRIP(rampsf, invert_rampsf)
+ROUND_TRIP(rampsd, invert_rampsd)
+ROUND_TRIP(rampsh, invert_rampsh_half)
+
+#undef ROUND_TRIP
+
+
+/**
+ * Test that gamma ramps of every depth, including half precision
+ * floating point, are read back unchanged from a CRTC whose gamma
+ * ramps have another depth, and that half precision gamma ramps
+ * can be generated with `libgamma_crtc_set_gamma_rampsh_f`.
+ */
+void gamma_ramp_round_trips(void)
+{
+  libgamma_site_state_t site;
+  libgamma_partition_state_t partition;
+  libgamma_crtc_state_t crtc;
+  libgamma_crtc_information_t info;
+  libgamma_gamma_rampsh_t read;
+  size_t i;
+  int passed;
+  
+  printf("Testing gamma ramp round trips:\n");
+  
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      printf("  skipped, the dummy adjustment method is not available\n\n");
+      return;
+    }
+  if (dummy_crtc(&site, &partition, &crtc))
+    {
+      printf("\n");
+      return;
+    }
+  if (libgamma_get_crtc_information(&info, &crtc, LIBGAMMA_CRTC_INFO_GAMMA_SIZE))
+    {
+      libgamma_perror("  skipped, libgamma_get_crtc_information", info.gamma_size_error);
+      goto done;
+    }
+  
+#define X(R)  report(#R, round_trip_##R(&crtc, &info));
+  LIST_RAMPS
+#undef X
+  
+  read.red_size = info.red_gamma_size, read.green_size = info.green_gamma_size, read.blue_size = info.blue_gamma_size;
+  passed = !libgamma_crtc_set_gamma_rampsh_f(&crtc, invert_rampsh, invert_rampsh, invert_rampsh);
+  if (passed && (passed = !libgamma_gamma_rampsh_initialise(&read)))
+    {
+      passed &= !libgamma_crtc_get_gamma_rampsh(&crtc, &read);
+      for (i = 0; passed && (i < read.red_size); i++)
+	passed &= read.red[i] == invert_rampsh_half((float)i / (float)(read.red_size - 1));
+      for (i = 0; passed && (i < read.blue_size); i++)
+	passed &= read.blue[i] == invert_rampsh_half((float)i / (float)(read.blue_size - 1));
+      libgamma_gamma_rampsh_destroy(&read);
+    }
+  report("libgamma_crtc_set_gamma_rampsh_f", passed);
+  
+ done:
+  libgamma_crtc_destroy(&crtc);
+  libgamma_partition_destroy(&partition);
+  libgamma_site_destroy(&site);
+  printf("\n");
+}
+
+
+/**
+ * The number of calls to the batch generator functions
+ * and the single generator functions, respectively.
+ */
+static size_t batch_calls, rgb_calls;
+
+
+/**
+ * Create generator functions for a specific depth that use
+ * its `invert_*` function, and a function that checks that
+ * `libgamma_crtc_set_gamma_*_batch_f` and
+ * `libgamma_crtc_set_gamma_*_rgb_f` apply the same gamma
+ * ramps as a reference function, and call the generator
+ * functions once per channel and once, respectively.
+ * 
+ * @param  R    The name of the gamma ramps' depth, for example `rampsh`.
+ * @param  OUT  The type the generator functions generate the stops in.
+ * @param  GEN  The name of the gamma ramps' depth that the single
+ *              generator function generates the gamma ramps in.
+ * @param  ENC  The type of the encoding values.
+ */
+#define GENERATORS(R, OUT, GEN, ENC)					\
+  static void batch_##R(OUT* restrict output, const ENC* restrict encodings, size_t n) \
+  {									\
+    size_t i;								\
+    batch_calls++;							\
+    for (i = 0; i < n; i++)						\
+      output[i] = invert_##R(encodings[i]);				\
+  }									\
+  									\
+  static void rgb_##R(libgamma_gamma_##GEN##_t* restrict ramps, const ENC* red, \
+		      const ENC* green, const ENC* blue)		\
+  {									\
+    rgb_calls++;							\
+    batch_##R(ramps->red, red, ramps->red_size);			\
+    batch_##R(ramps->green, green, ramps->green_size);			\
+    batch_##R(ramps->blue, blue, ramps->blue_size);			\
+  }									\
+  									\
+  static int generators_##R(libgamma_crtc_state_t* crtc,		\
+			    const libgamma_crtc_information_t* info)	\
+  {									\
+    libgamma_gamma_##R##_t expected, read;				\
+    int passed;								\
+    expected.red_size   = read.red_size   = info->red_gamma_size;	\
+    expected.green_size = read.green_size = info->green_gamma_size;	\
+    expected.blue_size  = read.blue_size  = info->blue_gamma_size;	\
+    if (libgamma_gamma_##R##_initialise(&expected))			\
+      return 0;								\
+    if (libgamma_gamma_##R##_initialise(&read))				\
+      return libgamma_gamma_##R##_destroy(&expected), 0;		\
+    passed = reference_##R(crtc, &expected);				\
+    batch_calls = rgb_calls = 0;					\
+    passed = passed && !libgamma_crtc_set_gamma_##R##_batch_f(crtc, batch_##R, batch_##R, batch_##R); \
+    passed = passed && (batch_calls == 3);				\
+    passed = passed && !libgamma_crtc_get_gamma_##R(crtc, &read);	\
+    passed = passed && same_##R(&read, &expected);			\
+    batch_calls = 0;							\
+    passed = passed && !libgamma_crtc_set_gamma_##R##_rgb_f(crtc, rgb_##R); \
+    passed = passed && (rgb_calls == 1) && (batch_calls == 3);		\
+    passed = passed && !libgamma_crtc_get_gamma_##R(crtc, &read);	\
+    passed = passed && same_##R(&read, &expected);			\
+    libgamma_gamma_##R##_destroy(&expected);				\
+    libgamma_gamma_##R##_destroy(&read);				\
+    return passed;							\
+  }
+
+
+/**
+ * Create a function that gets the gamma ramps with a specific
+ * depth that `libgamma_crtc_set_gamma_*_f` applies with the
+ * depth's `invert_*` function, the batch and single generator
+ * functions are given the same encoding values.
+ * 
+ * @param  R       The name of the gamma ramps' depth, for example `rampsh`.
+ * @param  INVERT  The function to pass to `libgamma_crtc_set_gamma_*_f`.
+ */
+#define REFERENCE(R, INVERT)						\
+  static int reference_##R(libgamma_crtc_state_t* crtc, libgamma_gamma_##R##_t* ramps) \
+  {									\
+    return !libgamma_crtc_set_gamma_##R##_f(crtc, INVERT, INVERT, INVERT) && \
+      !libgamma_crtc_get_gamma_##R(crtc, ramps);			\
+  }
+
+
+/**
+ * Create a function that checks whether two gamma ramps
+ * with a specific depth have the same stops.
+ * 
+ * @param  R  The name of the gamma ramps' depth, for example `rampsh`.
+ */
+#define SAME_RAMPS(R)							\
+  static int same_##R(const libgamma_gamma_##R##_t* a, const libgamma_gamma_##R##_t* b) \
+  {									\
+    return !memcmp(a->red, b->red, a->red_size * sizeof(*a->red)) &&	\
+      !memcmp(a->green, b->green, a->green_size * sizeof(*a->green)) &&	\
+      !memcmp(a->blue, b->blue, a->blue_size * sizeof(*a->blue));	\
+  }
+
+
+/**
+ * Calculate the `double` gamma ramps that the batch and
+ * single generator functions shall generate, they use
+ * `double` encoding values, unlike `libgamma_crtc_set_gamma_rampsd_f`.
+ * 
+ * @param   crtc   Unused.
+ * @param   ramps  The gamma ramps to fill, the sizes are set.
+ * @return         1.
+ */
+static int reference_rampsd(libgamma_crtc_state_t* crtc, libgamma_gamma_rampsd_t* ramps)
+{
+  size_t i;
+  (void) crtc;
+  for (i = 0; i < ramps->red_size; i++)
+    ramps->red[i] = invert_rampsd((double)i / (double)(ramps->red_size - 1));
+  for (i = 0; i < ramps->green_size; i++)
+    ramps->green[i] = invert_rampsd((double)i / (double)(ramps->green_size - 1));
+  for (i = 0; i < ramps->blue_size; i++)
+    ramps->blue[i] = invert_rampsd((double)i / (double)(ramps->blue_size - 1));
+  return 1;
+}
+
+
+/**
+ * Check whether two `double` stops are equal, except for rounding errors.
+ * 
+ * @param   a  One of the stops.
+ * @param   b  The other stop.
+ * @return     Whether the stops differ by at most `DBL_EPSILON`.
+ */
+static int close_stops(double a, double b)
+{
+  return (a - b <= DBL_EPSILON) && (b - a <= DBL_EPSILON);
+}
+
+
+/**
+ * Check whether two `double` gamma ramps have the same stops, the library
+ * may calculate the encoding values with a rounding error of one unit
+ * in the last place, which is not lost in a 64-bit CRTC.
+ * 
+ * @param   a  One of the gamma ramps.
+ * @param   b  The other gamma ramps.
+ * @return     Whether the gamma ramps have the same stops.
+ */
+static int __attribute__((pure)) same_rampsd(const libgamma_gamma_rampsd_t* a, const libgamma_gamma_rampsd_t* b)
+{
+  size_t i;
+  for (i = 0; i < a->red_size; i++)
+    if (!close_stops(a->red[i], b->red[i]))
+      return 0;
+  for (i = 0; i < a->green_size; i++)
+    if (!close_stops(a->green[i], b->green[i]))
+      return 0;
+  for (i = 0; i < a->blue_size; i++)
+    if (!close_stops(a->blue[i], b->blue[i]))
+      return 0;
+  return 1;
+}
+
+
+#define X(R)  SAME_RAMPS(R)
+LIST_INTEGER_RAMPS
+#undef X
+SAME_RAMPS(rampsf)
+SAME_RAMPS(rampsh)
+
+REFERENCE(ramps8, invert_ramps8)
+REFERENCE(ramps16, invert_ramps16)
+REFERENCE(ramps32, invert_ramps32)
+REFERENCE(ramps64, invert_ramps64)
+REFERENCE(rampsf, invert_rampsf)
+REFERENCE(rampsh, invert_rampsh)
+
+GENERATORS(ramps8, uint8_t, ramps8, float)
+GENERATORS(ramps16, uint16_t, ramps16, float)
+GENERATORS(ramps32, uint32_t, ramps32, float)
+GENERATORS(ramps64, uint64_t, ramps64, float)
+GENERATORS(rampsf, float, rampsf, float)
+GENERATORS(rampsd, double, rampsd, double)
+GENERATORS(rampsh, float, rampsf, float)
+
+#undef SAME_RAMPS
+#undef REFERENCE
+#undef GENERATORS
+
+
+/**
+ * Test that `libgamma_crtc_set_gamma_*_batch_f` call the generator
+ * functions once per channel, and `libgamma_crtc_set_gamma_*_rgb_f`
+ * call the generator function once, with the encoding values that
+ * `libgamma_crtc_set_gamma_*_f` use, and apply what they generate.
+ */
+void gamma_ramp_generators(void)
+{
+  libgamma_site_state_t site;
+  libgamma_partition_state_t partition;
+  libgamma_crtc_state_t crtc;
+  libgamma_crtc_information_t info;
+  
+  printf("Testing gamma ramp generator functions:\n");
+  
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      printf("  skipped, the dummy adjustment method is not available\n\n");
+      return;
+    }
+  if (dummy_crtc(&site, &partition, &crtc))
+    {
+      printf("\n");
+      return;
+    }
+  if (libgamma_get_crtc_information(&info, &crtc, LIBGAMMA_CRTC_INFO_GAMMA_SIZE))
+    libgamma_perror("  skipped, libgamma_get_crtc_information", info.gamma_size_error);
+  else
+    {
+#define X(R)  report(#R, generators_##R(&crtc, &info));
+      LIST_RAMPS
+#undef X
+    }
+  
+  libgamma_crtc_destroy(&crtc);
+  libgamma_partition_destroy(&partition);
+  libgamma_site_destroy(&site);
+  printf("\n");
+}
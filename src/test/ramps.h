@@ -19,7 +19,15 @@
 #define LIBGAMMA_TEST_RAMPS_H
 
 
+#include <libgamma.h>
+#include "gamma-helper.h"
+
+#include <errno.h>
+#include <float.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 
 #ifndef __GCC__
@@ -37,10 +45,17 @@
  */
 #define LIST_FLOAT_RAMPS  X(rampsf) X(rampsd)
 
+/**
+ * X macros of all half precision floating-point gamma ramps,
+ * their stops are bit patterns, so they cannot be dimmed
+ * or printed like the other gamma ramps
+ */
+#define LIST_HALF_RAMPS  X(rampsh)
+
 /**
  * X macros of all gamma ramps
  */
-#define LIST_RAMPS  LIST_FLOAT_RAMPS LIST_INTEGER_RAMPS
+#define LIST_RAMPS  LIST_FLOAT_RAMPS LIST_HALF_RAMPS LIST_INTEGER_RAMPS
 
 
 /* ramps16 is last because we want to make sure that the gamma ramps are
@@ -97,6 +112,73 @@ float invert_rampsf(float encoding) __attribute__((const));
  */
 double invert_rampsd(double encoding) __attribute__((const));
 
+/**
+ * Test mapping function from [0, 1] float encoding value to [0, 1] float
+ * output value, for half precision floating point gamma ramps.
+ * 
+ * @param   encoding  [0, 1] float encoding value.
+ * @return            [0, 1] float output value.
+ */
+float invert_rampsh(float encoding) __attribute__((const));
+
+/**
+ * Test allocating and releasing gamma ramps, with stops
+ * from the library's pool and with stops from `malloc`.
+ */
+void gamma_ramp_allocation(void);
+
+/**
+ * Test selecting the allocator the library uses,
+ * and the accounting of allocated memory.
+ */
+void custom_allocator(void);
+
+/**
+ * Test resampling gamma ramps whose sizes differ from the
+ * CRTC's, with the dummy adjustment method, at points where
+ * the interpolated values are known.
+ */
+void gamma_ramp_resampling(void);
+
+/**
+ * Test translating gamma ramps between depths with the kernels
+ * that are generated for every pair of depths, both with packed
+ * and with interleaved input stops.
+ */
+void gamma_ramp_translation(void);
+
+/**
+ * Test that the vectorised translation kernels give bit-identical
+ * results to the scalar kernels, for values at and next to the
+ * boundaries between integer values, for values outside [0, 1],
+ * and for every finite half precision value.
+ */
+void vectorised_translation(void);
+
+/**
+ * Test that a CRTC that keeps its scratch buffer reuses it when
+ * gamma ramps are re-encoded, rather than allocating new memory,
+ * that it grows when needed, and that it is released when the
+ * CRTC stops keeping it.
+ */
+void scratch_buffer(void);
+
+/**
+ * Test that gamma ramps of every depth, including half precision
+ * floating point, are read back unchanged from a CRTC whose gamma
+ * ramps have another depth, and that half precision gamma ramps
+ * can be generated with `libgamma_crtc_set_gamma_rampsh_f`.
+ */
+void gamma_ramp_round_trips(void);
+
+/**
+ * Test that `libgamma_crtc_set_gamma_*_batch_f` call the generator
+ * functions once per channel, and `libgamma_crtc_set_gamma_*_rgb_f`
+ * call the generator function once, with the encoding values that
+ * `libgamma_crtc_set_gamma_*_f` use, and apply what they generate.
+ */
+void gamma_ramp_generators(void);
+
 
 #endif
 
@@ -43,7 +43,24 @@ int main(void)
   method_availability();
   list_default_sites();
   method_capabilities();
+  method_cache();
+  method_dispatch();
   error_test();
+  crtc_handles();
+  crtc_information_cache();
+  site_enumeration();
+  topology_changes();
+  uevent_parsing();
+  site_events();
+  gamma_batches();
+  gamma_ramp_allocation();
+  custom_allocator();
+  gamma_ramp_translation();
+  vectorised_translation();
+  scratch_buffer();
+  gamma_ramp_round_trips();
+  gamma_ramp_generators();
+  gamma_ramp_resampling();
   
   /* Select monitor for tests over CRTC:s, partitions and sites. */
   if (select_monitor(site_state, part_state, crtc_state))
@@ -25,6 +25,10 @@
 #include "crtcinfo.h"
 #include "user.h"
 #include "ramps.h"
+#include "handles.h"
+#include "topology.h"
+#include "events.h"
+#include "batch.h"
 
 #include <libgamma.h>
 
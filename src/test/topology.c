@@ -0,0 +1,255 @@
+/**
+ * libgamma -- Display server abstraction layer for gamma ramp adjustments
+ * Copyright (C) 2014, 2015  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "topology.h"
+
+
+/**
+ * Print whether a test passed.
+ * 
+ * @param  description  A description of the test.
+ * @param  passed       Whether the test passed.
+ */
+static void report(const char* description, int passed)
+{
+  printf("  %s: %s\n", description, passed ? "passed" : "failed");
+}
+
+
+/**
+ * Compare two topologies, and print whether
+ * exactly one CRTC was listed with the expected changes.
+ * 
+ * @param  description   A description of the test.
+ * @param  changes       Output array for the changes.
+ * @param  old_topology  The old topology.
+ * @param  new_topology  The new topology.
+ * @param  expected      The expected changes to the CRTC.
+ * @param  old_crtc      The expected index of the CRTC in the old topology.
+ * @param  new_crtc      The expected index of the CRTC in the new topology.
+ */
+static void expect(const char* description, libgamma_topology_change_t* restrict changes,
+		   const libgamma_topology_t* restrict old_topology, const libgamma_topology_t* restrict new_topology,
+		   int expected, size_t old_crtc, size_t new_crtc)
+{
+  size_t n = libgamma_topology_diff(changes, old_topology, new_topology);
+  if ((n == 1) && (changes->changes == expected) && (changes->old_crtc == old_crtc) && (changes->new_crtc == new_crtc))
+    printf("  %s: passed\n", description);
+  else
+    printf("  %s: failed\n", description);
+}
+
+
+/**
+ * Test comparing two enumerations of a site with the dummy adjustment method.
+ */
+void topology_changes(void)
+{
+  libgamma_site_state_t site;
+  libgamma_topology_t* old_topology = NULL;
+  libgamma_topology_t* new_topology = NULL;
+  libgamma_topology_change_t* changes = NULL;
+  const int32_t fields = LIBGAMMA_CRTC_INFO_GAMMA_SIZE | LIBGAMMA_CRTC_INFO_GAMMA_DEPTH |
+    LIBGAMMA_CRTC_INFO_EDID | LIBGAMMA_CRTC_INFO_ACTIVE;
+  libgamma_crtc_handle_t handle;
+  uint64_t hash;
+  size_t n, last;
+  int r;
+  
+  printf("Testing topology changes:\n");
+  
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      printf("  skipped, the dummy adjustment method is not available\n\n");
+      return;
+    }
+  if ((r = libgamma_site_initialise(&site, LIBGAMMA_METHOD_DUMMY, NULL)))
+    {
+      libgamma_perror("  skipped, libgamma_site_initialise", r);
+      printf("\n");
+      return;
+    }
+  if ((r = libgamma_site_enumerate(&old_topology, &site, fields)) ||
+      (r = libgamma_site_enumerate(&new_topology, &site, fields)))
+    {
+      libgamma_perror("  skipped, libgamma_site_enumerate", r);
+      printf("\n");
+      goto done;
+    }
+  if ((n = new_topology->crtc_count) == 0)
+    {
+      printf("  skipped, the site has no CRTC:s\n\n");
+      goto done;
+    }
+  if ((changes = calloc(2 * n, sizeof(*changes))) == NULL)
+    {
+      perror("  topology_changes");
+      printf("\n");
+      goto done;
+    }
+  last = n - 1;
+  
+  n = libgamma_topology_diff(changes, old_topology, new_topology);
+  printf("  Unchanged topology: %s\n", n == 0 ? "passed" : "failed");
+  
+  /* The dummy adjustment method does not change the display configuration,
+     so the changes are made to the new topology and reverted afterwards. */
+  new_topology->crtc_count -= 1;
+  expect("Removed CRTC", changes, old_topology, new_topology,
+	 LIBGAMMA_TOPOLOGY_CRTC_REMOVED, last, SIZE_MAX);
+  expect("Added CRTC", changes, new_topology, old_topology,
+	 LIBGAMMA_TOPOLOGY_CRTC_ADDED, SIZE_MAX, last);
+  new_topology->crtc_count += 1;
+  
+  hash = new_topology->edid_hashes[last];
+  new_topology->edid_hashes[last] ^= 1;
+  expect("Changed EDID", changes, old_topology, new_topology,
+	 LIBGAMMA_TOPOLOGY_EDID_CHANGED, last, last);
+  new_topology->edid_hashes[last] = hash;
+  
+  handle = new_topology->crtcs[0].handle;
+  new_topology->crtcs[0].handle.connector = 1;
+  expect("Connected monitor", changes, old_topology, new_topology,
+	 LIBGAMMA_TOPOLOGY_CONNECTED, 0, 0);
+  expect("Disconnected monitor", changes, new_topology, old_topology,
+	 LIBGAMMA_TOPOLOGY_DISCONNECTED, 0, 0);
+  new_topology->crtcs[0].handle = handle;
+  
+  new_topology->crtcs[0].cached_gamma_depth = new_topology->crtcs[0].cached_gamma_depth == 8 ? 16 : 8;
+  expect("Changed gamma ramp depth", changes, old_topology, new_topology,
+	 LIBGAMMA_TOPOLOGY_GAMMA_SIZE_CHANGED, 0, 0);
+  
+  printf("\n");
+ done:
+  free(changes);
+  libgamma_topology_free(new_topology);
+  libgamma_topology_free(old_topology);
+  libgamma_site_destroy(&site);
+}
+
+
+
+/**
+ * Check whether the information about a CRTC in a topology
+ * is the same as when it is read directly.
+ * 
+ * @param   enumerated  The information in the topology.
+ * @param   crtc        The CRTC.
+ * @param   fields      The information that was requested.
+ * @return              Whether the information is the same.
+ */
+static int same_information(const libgamma_crtc_information_t* restrict enumerated,
+			    libgamma_crtc_state_t* restrict crtc, int32_t fields)
+{
+  libgamma_crtc_information_t info;
+  int passed;
+  
+  libgamma_get_crtc_information(&info, crtc, fields | LIBGAMMA_CRTC_INFO_REFRESH);
+  passed = (info.gamma_size_error == enumerated->gamma_size_error) &&
+	   (info.gamma_depth_error == enumerated->gamma_depth_error) &&
+	   (info.active_error == enumerated->active_error) &&
+	   (info.edid_error == enumerated->edid_error);
+  if (passed && !info.gamma_size_error)
+    passed = (info.red_gamma_size   == enumerated->red_gamma_size) &&
+	     (info.green_gamma_size == enumerated->green_gamma_size) &&
+	     (info.blue_gamma_size  == enumerated->blue_gamma_size);
+  if (passed && !info.gamma_depth_error)
+    passed = info.gamma_depth == enumerated->gamma_depth;
+  if (passed && !info.active_error)
+    passed = info.active == enumerated->active;
+  if (passed && !info.edid_error)
+    passed = (info.edid_length == enumerated->edid_length) &&
+	     !memcmp(info.edid, enumerated->edid, info.edid_length);
+  libgamma_crtc_information_destroy(&info);
+  return passed;
+}
+
+
+/**
+ * Test enumerating a site with the dummy adjustment method.
+ */
+void site_enumeration(void)
+{
+  libgamma_site_state_t site;
+  libgamma_topology_t* topology = NULL;
+  const int32_t fields = LIBGAMMA_CRTC_INFO_GAMMA_SIZE | LIBGAMMA_CRTC_INFO_GAMMA_DEPTH |
+    LIBGAMMA_CRTC_INFO_EDID | LIBGAMMA_CRTC_INFO_ACTIVE;
+  size_t i, j, k, crtcs, bytes;
+  int r, passed;
+  
+  printf("Testing site enumeration:\n");
+  
+  if (!libgamma_is_method_available(LIBGAMMA_METHOD_DUMMY))
+    {
+      printf("  skipped, the dummy adjustment method is not available\n\n");
+      return;
+    }
+  if ((r = libgamma_site_initialise(&site, LIBGAMMA_METHOD_DUMMY, NULL)))
+    {
+      libgamma_perror("  skipped, libgamma_site_initialise", r);
+      printf("\n");
+      return;
+    }
+  
+  /* Without information, only the states are enumerated. */
+  bytes = libgamma_allocated_bytes();
+  if ((r = libgamma_site_enumerate(&topology, &site, 0)))
+    {
+      libgamma_perror("  skipped, libgamma_site_enumerate", r);
+      printf("\n");
+      goto done;
+    }
+  passed = (topology->site == &site) && (topology->partition_count == site.partitions_available);
+  passed &= (topology->crtc_information == NULL) && (topology->edid_hashes == NULL) && (topology->fields == 0);
+  for (i = crtcs = 0; i < topology->partition_count; i++)
+    {
+      passed &= (topology->partitions[i].site == &site) && (topology->partitions[i].partition == i);
+      crtcs += topology->partitions[i].crtcs_available;
+    }
+  passed &= topology->crtc_count == crtcs;
+  
+  /* The CRTC states are ordered by partition and then by index. */
+  for (i = k = 0; i < topology->partition_count; i++)
+    for (j = 0; j < topology->partitions[i].crtcs_available; j++, k++)
+      passed &= (topology->crtcs[k].partition == topology->partitions + i) && (topology->crtcs[k].crtc == j);
+  report("Enumerating without CRTC information", passed);
+  
+  libgamma_topology_free(topology);
+  topology = NULL;
+  report("Releasing the topology", libgamma_allocated_bytes() == bytes);
+  
+  /* With information, it is the same as when it is read directly. */
+  if ((r = libgamma_site_enumerate(&topology, &site, fields)))
+    {
+      libgamma_perror("  skipped, libgamma_site_enumerate", r);
+      printf("\n");
+      goto done;
+    }
+  passed = (topology->crtc_count == crtcs) && (topology->fields == fields);
+  passed &= (topology->crtc_information != NULL) && (topology->edid_hashes != NULL);
+  for (k = 0; passed && (k < topology->crtc_count); k++)
+    {
+      passed &= same_information(topology->crtc_information + k, topology->crtcs + k, fields);
+      passed &= (topology->edid_hashes[k] != 0) == !topology->crtc_information[k].edid_error;
+    }
+  report("Enumerating with CRTC information", passed);
+  
+  printf("\n");
+ done:
+  libgamma_topology_free(topology);
+  libgamma_site_destroy(&site);
+}